@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace libbej
+{
+
+/**
+ * @brief Append the base64 text of some bytes to an output.
+ *
+ * Uses the standard alphabet with '=' padding (RFC 4648). The output is
+ * resized once and every 3 input bytes are written as 4 characters using
+ * two lookups in a table of character pairs, so there is no work per input
+ * byte.
+ *
+ * @param[inout] output - output to append to.
+ * @param[in] data - bytes to encode.
+ */
+void appendBase64(std::string& output, std::span<const uint8_t> data);
+
+} // namespace libbej
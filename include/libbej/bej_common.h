@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -56,6 +57,10 @@ enum BejError
     bejErrorInvalidSchemaType,
     bejErrorInvalidPropertyOffset,
     bejErrorNullParameter,
+    // Not an error. The decoding budget ran out and decoding can be resumed.
+    bejErrorWouldBlock,
+    // A string value is not valid UTF-8.
+    bejErrorInvalidString,
 };
 
 /**
@@ -178,6 +183,26 @@ struct BejDictionaries
     uint32_t errorDictionarySize;
 };
 
+/**
+ * @brief Maximum depth of the stacks embedded in library structures, like
+ * the cursor. Redfish resources are shallow. This is fixed because it changes
+ * the layout of those structures.
+ */
+#define BEJ_MAX_STACK_DEPTH 64
+
+/**
+ * @brief Caller provided memory for a stack of pointers.
+ */
+struct BejPointerStackStorage
+{
+    // Array with at least capacity entries.
+    void** entries;
+    // Maximum number of entries.
+    uint32_t capacity;
+    // Number of entries in use.
+    uint32_t size;
+};
+
 /**
  * @brief Callbacks to a stack that can store pointers.
  */
@@ -220,6 +245,80 @@ struct BejPointerStackCallback
     void (*deleteStack)(void* stackContext);
 };
 
+/**
+ * @brief A pointer stack used by the encoder. The stack is kept in storage if
+ * it is not NULL. Otherwise the callbacks are used.
+ */
+struct BejPointerStack
+{
+    const struct BejPointerStackCallback* callbacks;
+    struct BejPointerStackStorage* storage;
+};
+
+/**
+ * @brief Check whether a pointer stack is empty.
+ */
+static inline bool bejPointerStackEmpty(const struct BejPointerStack* stack)
+{
+    if (stack->storage != NULL)
+    {
+        return stack->storage->size == 0;
+    }
+    return stack->callbacks->stackEmpty(stack->callbacks->stackContext);
+}
+
+/**
+ * @brief View the pointer at the top of a pointer stack. Returns NULL if the
+ * stack is empty.
+ */
+static inline void* bejPointerStackPeek(const struct BejPointerStack* stack)
+{
+    if (stack->storage != NULL)
+    {
+        if (stack->storage->size == 0)
+        {
+            return NULL;
+        }
+        return stack->storage->entries[stack->storage->size - 1];
+    }
+    return stack->callbacks->stackPeek(stack->callbacks->stackContext);
+}
+
+/**
+ * @brief Remove and return the pointer at the top of a pointer stack.
+ */
+static inline void* bejPointerStackPop(const struct BejPointerStack* stack)
+{
+    if (stack->storage != NULL)
+    {
+        if (stack->storage->size == 0)
+        {
+            return NULL;
+        }
+        return stack->storage->entries[--stack->storage->size];
+    }
+    return stack->callbacks->stackPop(stack->callbacks->stackContext);
+}
+
+/**
+ * @brief Push a pointer to a pointer stack. Returns bejErrorInvalidSize if
+ * the storage is full.
+ */
+static inline int bejPointerStackPush(const struct BejPointerStack* stack,
+                                      void* p)
+{
+    if (stack->storage != NULL)
+    {
+        if (stack->storage->size >= stack->storage->capacity)
+        {
+            return bejErrorInvalidSize;
+        }
+        stack->storage->entries[stack->storage->size++] = p;
+        return 0;
+    }
+    return stack->callbacks->stackPush(p, stack->callbacks->stackContext);
+}
+
 /**
  * @brief Get the unsigned integer value from provided bytes.
  *
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "bej_common.h"
+#include "bej_decoder_core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+
+namespace libbej
+{
+
+/**
+ * @brief The decoded events of a PLDM block as an input range.
+ *
+ * Events are decoded while iterating, one at a time:
+ *
+ *   BejEventRange events(dictionaries, block);
+ *   for (const BejCursorEvent& event : events) { ... }
+ *   if (events.error() != 0) { ... }
+ *
+ * A decoding error ends the range early. The dictionaries and the block have
+ * to stay valid while iterating. The range can be iterated only once.
+ */
+class BejEventRange
+{
+  public:
+    class Iterator
+    {
+      public:
+        using value_type = BejCursorEvent;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        const BejCursorEvent& operator*() const
+        {
+            return *range->current;
+        }
+
+        const BejCursorEvent* operator->() const
+        {
+            return range->current;
+        }
+
+        Iterator& operator++()
+        {
+            range->next();
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            range->next();
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return range->current == nullptr;
+        }
+
+      private:
+        friend class BejEventRange;
+
+        explicit Iterator(BejEventRange* range) : range(range) {}
+
+        BejEventRange* range = nullptr;
+    };
+
+    /**
+     * @brief Start decoding a PLDM block.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @param[in] options - decoder options. Can be nullptr.
+     */
+    BejEventRange(const BejDictionaries& dictionaries,
+                  std::span<const uint8_t> encodedPldmBlock,
+                  const BejDecoderOptions* options = nullptr);
+
+    // The cursor points to itself.
+    BejEventRange(const BejEventRange&) = delete;
+    BejEventRange& operator=(const BejEventRange&) = delete;
+
+    Iterator begin()
+    {
+        return Iterator(this);
+    }
+
+    std::default_sentinel_t end() const
+    {
+        return std::default_sentinel;
+    }
+
+    /**
+     * @brief Get the status of the decoding.
+     *
+     * @return 0 if no error is found so far.
+     */
+    int error() const
+    {
+        return status;
+    }
+
+  private:
+    /**
+     * @brief Decode the next event.
+     */
+    void next();
+
+    BejCursor cursor;
+    // nullptr once the range ends.
+    const BejCursorEvent* current = nullptr;
+    int status = 0;
+};
+
+} // namespace libbej
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "bej_common.h"
+#include "bej_dictionary_index.h"
+#include "bej_path.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -52,6 +54,39 @@ struct BejDecoderStates
     uint32_t encodedStreamOffset;
     const uint8_t* encodedSubStream;
     uint32_t streamLen;
+    // Number of sections on the decoder stack.
+    uint32_t sectionDepth;
+    // Bit i is set if projection path i matches the current section so far.
+    // 0 if every property of the section is decoded.
+    uint32_t projectionMask;
+    // Number of projection path steps matched by the current section.
+    uint32_t projectionDepth;
+    // Entry i is the projectionMask of the section matching i path steps.
+    // Used to restore the projection state once a section ends.
+    uint32_t projectionMasks[BEJ_MAX_PATH_DEPTH];
+    // A property was decoded and callbackPropertyEnd is due once the next
+    // property of the same section is decoded.
+    bool pendingPropertyEnd;
+};
+
+/**
+ * @brief Numeric identity of a decoded property.
+ *
+ * Lets callers route values using integers instead of comparing or hashing
+ * the property names.
+ */
+struct BejPropertyId
+{
+    // Sequence number from the encoded tuple. For array elements, this is the
+    // index of the element.
+    uint32_t sequenceNumber;
+    // Offset of the property from the start of its dictionary. Array elements
+    // use the entry of element 0. 0 if the property is not in the dictionary.
+    uint16_t dictPropOffset;
+    // bejPrimary or bejAnnotation. Selects the dictionary.
+    uint8_t schema;
+    // Length of the name in the dictionary without the NULL terminator.
+    uint8_t nameLength;
 };
 
 /**
@@ -84,7 +119,8 @@ struct BejDecodedCallback
     /**
      * @brief Calls after a property is finished unless this is the last
      * property in a Set or an array. In that case appropriate
-     * callbackSetEnd or callbackArrayEnd will be called.
+     * callbackSetEnd or callbackArrayEnd will be called. Properties skipped
+     * by a projection are not counted.
      */
     int (*callbackPropertyEnd)(void* dataPtr);
 
@@ -141,6 +177,63 @@ struct BejDecodedCallback
         uint32_t sequenceNumber, void* dataPtr);
 };
 
+/**
+ * @brief Callbacks added after BejDecodedCallback.
+ *
+ * They are passed with BejDecoderOptions, so the layout of BejDecodedCallback
+ * stays the same for existing users. Callbacks can be NULL.
+ */
+struct BejDecodedCallbackExtensions
+{
+    /**
+     * @brief Calls when a Bytestring property is found.
+     *
+     * value points into the encoded stream and is only valid during the
+     * call. If this is NULL, callbackNull is called instead.
+     */
+    int (*callbackBytestring)(const char* propertyName, const uint8_t* value,
+                              size_t length, void* dataPtr);
+
+    /**
+     * @brief Calls when a String property passed in fragments is found.
+     *
+     * Strings are passed in fragments if callbackString is NULL or if the
+     * incremental decoder has only a part of the value. This way a large
+     * string never has to be held in one buffer. If this is set,
+     * callbackStringFragment and callbackStringEnd have to be set too.
+     *
+     * length is the total length of the fragments. Like in callbackString,
+     * this includes the NULL terminator.
+     */
+    int (*callbackStringBegin)(const char* propertyName, size_t length,
+                               void* dataPtr);
+
+    /**
+     * @brief Calls with the next bytes of a string passed in fragments.
+     *
+     * The fragment points into the encoded stream and is only valid during
+     * the call. It is not NULL terminated. The last fragment ends with the
+     * NULL terminator of the string.
+     */
+    int (*callbackStringFragment)(const char* fragment, size_t length,
+                                  void* dataPtr);
+
+    /**
+     * @brief Calls after the last fragment of a string.
+     */
+    int (*callbackStringEnd)(void* dataPtr);
+
+    /**
+     * @brief Calls with the identity of a property right before the callback
+     * that passes its name.
+     *
+     * This is called for every callback with a propertyName argument,
+     * including array elements and the outer property of an annotation. The
+     * identity is only valid during the call.
+     */
+    int (*callbackPropertyId)(const struct BejPropertyId* id, void* dataPtr);
+};
+
 /**
  * @brief Stack for holding BejStackProperty types. Decoder core is not
  * responsible for creating or deleting stack memory. User of the decoder
@@ -177,19 +270,77 @@ struct BejStackCallback
                      void* dataPtr);
 };
 
+/**
+ * @brief Caller provided memory for the decoder stack.
+ *
+ * When provided, the decoder keeps its stack in this array instead of
+ * calling the BejStackCallback functions. The capacity bounds the nesting
+ * depth of the decoded stream.
+ */
+struct BejStackStorage
+{
+    // Array with at least capacity entries.
+    struct BejStackProperty* entries;
+    // Maximum number of entries.
+    uint32_t capacity;
+    // Number of entries in use. The decoder resets this before decoding.
+    uint32_t size;
+};
+
 /**
  * @brief Used to pass parameters to BEJ decoding local functions.
  */
+/**
+ * @brief Where the decoder delivers the decoded properties.
+ */
+enum BejEventSink
+{
+    // BejDecodedCallback of the caller.
+    bejEventSinkCallbacks = 0,
+    // Event queue of a BejCursor. callbacksDataPtr points to the cursor.
+    bejEventSinkCursor,
+    // Events of bejDecodePldmBlockBatched(). callbacksDataPtr points to the
+    // batch decoder.
+    bejEventSinkBatch,
+};
+
 struct BejHandleTypeFuncParam
 {
     struct BejDecoderStates state;
     struct BejSFLV sflv;
     const uint8_t* mainDictionary;
     const uint8_t* annotDictionary;
+    const struct BejDictionaryIndex* mainDictIndex;
+    const struct BejDictionaryIndex* annotDictIndex;
+    // True if both indexes are prepared dictionaries. Checked once before
+    // decoding, so the properties found are not validated again.
+    bool dictionariesPrepared;
     const struct BejDecodedCallback* decodedCallback;
+    // Never NULL. Points to a struct of NULL callbacks if the caller has no
+    // extensions.
+    const struct BejDecodedCallbackExtensions* callbackExtensions;
     const struct BejStackCallback* stackCallback;
     void* callbacksDataPtr;
     void* stackDataPtr;
+    // If not NULL, used instead of stackCallback.
+    struct BejStackStorage* stackStorage;
+    // Properties to decode. NULL to decode everything.
+    const struct BejProjection* projection;
+    // Projection state for the children of the tuple being decoded.
+    uint32_t childProjectionMask;
+    uint32_t childProjectionDepth;
+    // Identity of the property whose name was passed last. Only set if
+    // needPropertyId is true.
+    struct BejPropertyId propertyId;
+    // True if callbackPropertyId or the caller of the decoder uses
+    // propertyId.
+    bool needPropertyId;
+    // Destination of the decoded properties. Event sinks other than
+    // bejEventSinkCallbacks get the events through a direct call instead of
+    // decodedCallback.
+    enum BejEventSink eventSink;
+    // Name of the property annotated by the next event of an event sink.
+    const char* annotatedPropertyName;
 };
 
 /**
@@ -210,6 +361,25 @@ enum BejTrailingDataPolicy
     bejTrailingError,
 };
 
+/**
+ * @brief Optional settings for decoding a PLDM block.
+ */
+struct BejDecoderOptions
+{
+    // Policy for handling trailing bytes.
+    enum BejTrailingDataPolicy trailingPolicy;
+    // Prebuilt indexes of the dictionaries. Can be NULL.
+    const struct BejDictionaryIndexes* dictionaryIndexes;
+    // Library managed stack memory. If not NULL, stackCallback is not used
+    // and can be NULL.
+    struct BejStackStorage* stackStorage;
+    // Properties to decode. If NULL, the whole block is decoded. Not supported
+    // by bejDecodePldmBlockPath().
+    const struct BejProjection* projection;
+    // Callbacks in addition to decodedCallback. Can be NULL.
+    const struct BejDecodedCallbackExtensions* callbackExtensions;
+};
+
 /**
  * @brief Decodes a PLDM block. Maximum encoded stream size the decoder
  * supports is 32bits.
@@ -254,6 +424,480 @@ int bejDecodePldmBlockWithPolicy(
     const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
     void* stackDataPtr, enum BejTrailingDataPolicy trailingPolicy);
 
+/**
+ * @brief Decodes a PLDM block with explicit decoder options.
+ *
+ * Same as bejDecodePldmBlock but lets the caller choose the trailing-data
+ * policy and provide prebuilt dictionary indexes. Dictionary lookups use the
+ * indexes when available and fall back to a linear search otherwise.
+ *
+ * With a projection, properties outside of it are skipped using their value
+ * length. No callbacks are called and no dictionary lookups are done for
+ * them.
+ *
+ * @param[in] options - decoder options. If NULL, the defaults of
+ * bejDecodePldmBlock are used.
+ *
+ * @return 0 if successful.
+ */
+int bejDecodePldmBlockWithOptions(
+    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
+    uint32_t blockLength, const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options);
+
+/**
+ * @brief Decodes a single property of a PLDM block.
+ *
+ * The property is found by walking only the tuples along the path. Sets and
+ * arrays that are not on the path are skipped without being decoded. The
+ * callbacks are called for the selected property and its children as if it
+ * was the whole stream. The top level property is reported without a name.
+ *
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] path - path resolved using bejPathResolve() with the same
+ * dictionaries.
+ * @param[in] options - decoder options. Can be NULL.
+ *
+ * @return 0 if successful. bejErrorUnknownProperty if the stream does not
+ * contain the property.
+ */
+int bejDecodePldmBlockPath(
+    const struct BejDictionaries* dictionaries, const struct BejPath* path,
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options);
+
+/**
+ * @brief Decodes a PLDM block using prepared dictionaries.
+ *
+ * Same as bejDecodePldmBlockWithOptions but the dictionaries come from
+ * indexes built using bejDictPrepare(). The dictionary headers and the
+ * properties found are not validated again for each decode.
+ *
+ * @param[in] preparedDictionaries - prepared schema and annotation
+ * dictionaries. Both indexes are required.
+ * @param[in] options - decoder options. If NULL, the defaults of
+ * bejDecodePldmBlock are used. The dictionaryIndexes option is ignored.
+ *
+ * @return 0 if successful.
+ */
+int bejDecodePldmBlockPrepared(
+    const struct BejDictionaryIndexes* preparedDictionaries,
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options);
+
+/**
+ * @brief Decoder for a PLDM block received in chunks, such as the parts of a
+ * PLDM multipart transfer.
+ *
+ * The decoder state and the section stack are kept between chunks and the
+ * decoded callbacks are called for every tuple completed so far. Tuples are
+ * decoded directly from the chunks. Only a tuple split between two chunks is
+ * copied to the caller provided buffer, so the buffer has to hold the largest
+ * such tuple rather than the whole block. Sets and arrays are never copied as
+ * a whole. If the callback extensions set callbackStringBegin, neither are
+ * strings. Their bytes are passed in fragments as they arrive.
+ *
+ * The members are managed by the bejIncrementalDecoder functions.
+ */
+struct BejIncrementalDecoder
+{
+    struct BejHandleTypeFuncParam params;
+    // Caller provided memory for a tuple split between chunks.
+    uint8_t* buffer;
+    uint32_t bufferCapacity;
+    // Number of bytes in the buffer. These start at the current tuple.
+    uint32_t bufferSize;
+    // PLDM block header collected from the first chunks.
+    uint8_t header[sizeof(struct BejPldmBlockHeader)];
+    uint32_t headerSize;
+    // Number of encoded stream bytes received after the PLDM block header.
+    uint32_t receivedLength;
+    // Length of the encoded payload. 0 until the root tuple is received.
+    uint32_t payloadLength;
+    enum BejTrailingDataPolicy trailingPolicy;
+    uint64_t operationCount;
+    // Number of bytes of a string passed in fragments that are still to
+    // come. 0 if no string is being passed.
+    uint32_t stringRemaining;
+    // Encoded stream offset of the next byte of that string.
+    uint32_t stringOffset;
+    // True once the whole payload is decoded.
+    bool done;
+};
+
+/**
+ * @brief Initialize an incremental decoder for a new PLDM block.
+ *
+ * The dictionaries, the callbacks, the buffer and the stack storage have to
+ * stay valid until the decoding is finished.
+ *
+ * @param[out] decoder - decoder to initialize.
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] stackCallback - callbacks for stack handlers. Can be NULL if
+ * options provide stack storage.
+ * @param[in] decodedCallback - callbacks for extracting decoded properties.
+ * @param[in] callbacksDataPtr - data pointer to pass to decoded callbacks.
+ * @param[in] stackDataPtr - data pointer to pass to stack callbacks.
+ * @param[in] buffer - memory for a tuple split between chunks.
+ * @param[in] bufferCapacity - size of the buffer.
+ * @param[in] options - decoder options. Can be NULL.
+ *
+ * @return 0 if successful.
+ */
+int bejIncrementalDecoderInit(struct BejIncrementalDecoder* decoder,
+                              const struct BejDictionaries* dictionaries,
+                              const struct BejStackCallback* stackCallback,
+                              const struct BejDecodedCallback* decodedCallback,
+                              void* callbacksDataPtr, void* stackDataPtr,
+                              uint8_t* buffer, uint32_t bufferCapacity,
+                              const struct BejDecoderOptions* options);
+
+/**
+ * @brief Decode the next chunk of the PLDM block.
+ *
+ * The chunk is not used after this returns. Chunks can have any size,
+ * including a part of the PLDM block header.
+ *
+ * @param[inout] decoder - an initialized decoder.
+ * @param[in] chunk - next bytes of the PLDM block.
+ * @param[in] chunkLength - length of the chunk.
+ *
+ * @return 0 if successful. bejErrorInvalidSize if a tuple split between
+ * chunks does not fit in the buffer.
+ */
+int bejIncrementalDecoderFeed(struct BejIncrementalDecoder* decoder,
+                              const uint8_t* chunk, uint32_t chunkLength);
+
+/**
+ * @brief Finish decoding once all the chunks are fed.
+ *
+ * @param[inout] decoder - an initialized decoder.
+ *
+ * @return 0 if the whole payload was decoded. bejErrorInvalidSize if the
+ * payload is incomplete or the trailing-data policy rejects extra bytes.
+ */
+int bejIncrementalDecoderFinish(struct BejIncrementalDecoder* decoder);
+
+/**
+ * @brief Limits the work done by a single call to the incremental decoder.
+ */
+struct BejDecodeBudget
+{
+    // Maximum number of tuples to decode or skip. 0 for no limit.
+    uint32_t maxTuples;
+    // Called after every tuple. Returns true once the caller wants control
+    // back, for example after a deadline. Can be NULL. This should be cheap.
+    bool (*yield)(void* dataPtr);
+    // Data pointer to pass to yield.
+    void* dataPtr;
+};
+
+/**
+ * @brief Decode the next chunk of the PLDM block within a budget.
+ *
+ * Same as bejIncrementalDecoderFeed but returns bejErrorWouldBlock once the
+ * budget runs out. The decoder state is kept, so decoding continues with
+ * the next call using the part of the chunk that was not consumed. This lets
+ * a single-threaded event loop interleave a large decode with other work.
+ *
+ * @param[inout] decoder - an initialized decoder.
+ * @param[in] chunk - next bytes of the PLDM block.
+ * @param[in] chunkLength - length of the chunk.
+ * @param[in] budget - limits for this call. Can be NULL for no limit.
+ * @param[out] consumed - number of bytes of the chunk used by the decoder.
+ * This is chunkLength unless bejErrorWouldBlock is returned. The remaining
+ * bytes have to be fed again.
+ *
+ * @return 0 if the chunk is consumed. bejErrorWouldBlock if the budget ran
+ * out before that. Other values are errors.
+ */
+int bejIncrementalDecoderFeedBudgeted(struct BejIncrementalDecoder* decoder,
+                                      const uint8_t* chunk,
+                                      uint32_t chunkLength,
+                                      const struct BejDecodeBudget* budget,
+                                      uint32_t* consumed);
+
+/**
+ * @brief A contiguous part of a PLDM block.
+ */
+struct BejIoVec
+{
+    const uint8_t* base;
+    uint32_t length;
+};
+
+/**
+ * @brief Decodes a PLDM block stored in several non-contiguous buffers.
+ *
+ * The segments are decoded in order as if they were one contiguous block,
+ * without copying the block. Only a tuple split between two segments is
+ * copied to the bounce buffer. See struct BejIncrementalDecoder.
+ *
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] segments - parts of the PLDM block in order. Empty segments are
+ * allowed.
+ * @param[in] segmentCount - number of segments.
+ * @param[in] bounceBuffer - memory for a tuple split between segments.
+ * @param[in] bounceBufferCapacity - size of the bounce buffer.
+ * @param[in] options - decoder options. Can be NULL.
+ *
+ * @return 0 if successful. bejErrorInvalidSize if a split tuple does not fit
+ * in the bounce buffer.
+ */
+int bejDecodePldmBlockVectored(
+    const struct BejDictionaries* dictionaries, const struct BejIoVec* segments,
+    uint32_t segmentCount, const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, uint8_t* bounceBuffer, uint32_t bounceBufferCapacity,
+    const struct BejDecoderOptions* options);
+
+/**
+ * @brief Type of a decoded event returned by bejCursorNext().
+ */
+enum BejCursorEventType
+{
+    bejCursorSetStart,
+    bejCursorSetEnd,
+    bejCursorArrayStart,
+    bejCursorArrayEnd,
+    bejCursorNull,
+    bejCursorInteger,
+    bejCursorEnum,
+    bejCursorString,
+    bejCursorReal,
+    bejCursorBool,
+    bejCursorResourceLink,
+};
+
+/**
+ * @brief A string value pointing into the encoded stream.
+ */
+struct BejCursorString
+{
+    // NULL terminated string.
+    const char* value;
+    // Length of the string without the NULL terminator.
+    size_t length;
+};
+
+/**
+ * @brief Value of a decoded property. The member in use depends on the type
+ * of the property.
+ */
+union BejValue
+{
+    // Number of encoded elements of a set or an array. A projection might
+    // skip some of them.
+    uint64_t elementCount;
+    int64_t integer;
+    const char* enumValue;
+    struct BejCursorString string;
+    struct BejReal real;
+    bool boolean;
+    uint64_t linkId;
+};
+
+/**
+ * @brief One decoded event.
+ *
+ * The strings point into the dictionaries or the encoded stream and stay
+ * valid as long as those do.
+ */
+struct BejCursorEvent
+{
+    enum BejCursorEventType type;
+    // Name of the property. Empty for array elements and the root set. NULL
+    // for set and array ends.
+    const char* propertyName;
+    // If not NULL, this event is the value of an annotation of the named
+    // property. For example "Status" for "Status@Message.ExtendedInfo" where
+    // propertyName is "@Message.ExtendedInfo".
+    const char* annotatedPropertyName;
+    // Value selected by type. Not used for set and array ends.
+    union BejValue value;
+    // Identity of the property. All 0 for set and array ends.
+    struct BejPropertyId id;
+};
+
+/**
+ * @brief Maximum number of events produced by a single tuple. A tuple can
+ * close every open set and array.
+ */
+#define BEJ_CURSOR_MAX_EVENTS (BEJ_MAX_STACK_DEPTH + 2)
+
+/**
+ * @brief Pull style decoder returning one event at a time.
+ *
+ * Unlike the callback based decoders, the caller drives the decoding by
+ * calling bejCursorNext() and handles each event in its own loop. The cursor
+ * holds its own stack, so it can nest at most BEJ_MAX_STACK_DEPTH levels.
+ *
+ * The members are managed by the bejCursor functions.
+ */
+struct BejCursor
+{
+    struct BejHandleTypeFuncParam params;
+    struct BejStackProperty stack[BEJ_MAX_STACK_DEPTH];
+    struct BejStackStorage stackStorage;
+    // Events decoded but not returned yet. This is a ring buffer.
+    struct BejCursorEvent events[BEJ_CURSOR_MAX_EVENTS];
+    uint32_t eventHead;
+    uint32_t eventCount;
+    // Encoded stream without the PLDM block header.
+    const uint8_t* enStream;
+    // Length of the encoded payload.
+    uint32_t payloadLength;
+    uint64_t operationCount;
+    // True once the whole payload is decoded.
+    bool done;
+};
+
+/**
+ * @brief Initialize a cursor for a PLDM block.
+ *
+ * The dictionaries and the PLDM block have to stay valid while the cursor
+ * is used.
+ *
+ * @param[out] cursor - cursor to initialize.
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] blockLength - length of the PLDM block.
+ * @param[in] options - decoder options. Can be NULL. The stack storage is not
+ * used.
+ *
+ * @return 0 if successful.
+ */
+int bejCursorInit(struct BejCursor* cursor,
+                  const struct BejDictionaries* dictionaries,
+                  const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                  const struct BejDecoderOptions* options);
+
+/**
+ * @brief Decode the next event.
+ *
+ * @param[inout] cursor - an initialized cursor.
+ * @param[out] event - the next event. Valid until the next call. NULL once
+ * the whole block is decoded.
+ *
+ * @return 0 if successful.
+ */
+int bejCursorNext(struct BejCursor* cursor,
+                  const struct BejCursorEvent** event);
+
+/**
+ * @brief Get the number of payload bytes not decoded yet.
+ *
+ * The element count of a set or an array comes from the encoded stream. Use
+ * this to bound it before reserving memory for the elements.
+ *
+ * @param[in] cursor - an initialized cursor.
+ *
+ * @return number of bytes left in the payload.
+ */
+uint32_t bejCursorRemainingBytes(const struct BejCursor* cursor);
+
+/**
+ * @brief Value of a BejBatchEvent. Same as BejValue, except that the length
+ * of a string and the value of a real are kept out of the union.
+ */
+union BejBatchValue
+{
+    // Number of encoded elements of a set or an array. A projection might
+    // skip some of them.
+    uint64_t elementCount;
+    int64_t integer;
+    const char* enumValue;
+    // NULL terminated. The length is BejBatchEvent::valueLength.
+    const char* string;
+    // Index of the value in the reals passed with the batch.
+    uint32_t realIndex;
+    bool boolean;
+    uint64_t linkId;
+};
+
+/**
+ * @brief One decoded event delivered by bejDecodePldmBlockBatched().
+ *
+ * Same as BejCursorEvent with the length of the name and the nesting depth
+ * of the property, so that a batch can be handled without looking at the
+ * other events. Reals are passed next to the events, so an event takes 40
+ * bytes instead of the size of a BejReal plus the rest.
+ */
+struct BejBatchEvent
+{
+    // Value selected by type. Not used for set and array ends.
+    union BejBatchValue value;
+    // Name of the property. Empty for array elements and the root set. NULL
+    // for set and array ends.
+    const char* propertyName;
+    // Same as BejCursorEvent::annotatedPropertyName.
+    const char* annotatedPropertyName;
+    // Same as BejCursorEvent::id.
+    struct BejPropertyId id;
+    // Length of a string value without the NULL terminator. 0 for the other
+    // types.
+    uint32_t valueLength;
+    // Number of sets and arrays around the property. 0 for the root set. A
+    // set or an array end has the depth of its start.
+    uint16_t depth;
+    // Length of propertyName without the NULL terminator. Dictionary names
+    // are at most UINT8_MAX bytes long.
+    uint8_t propertyNameLength;
+    // enum BejCursorEventType.
+    uint8_t type;
+};
+
+/**
+ * @brief Suggested number of events in a batch.
+ */
+#define BEJ_BATCH_DEFAULT_EVENTS 256
+
+/**
+ * @brief Maximum number of reals in a batch. A batch is passed before it is
+ * full if it has this many reals.
+ */
+#define BEJ_BATCH_MAX_REALS 16
+
+/**
+ * @brief Decodes a PLDM block and delivers the events in batches.
+ *
+ * Instead of one callback per property, the decoder writes the events to the
+ * caller's array and callbackBatch is called once the array is full and once
+ * for the remaining events at the end. A batch is passed earlier if it has
+ * BEJ_BATCH_MAX_REALS reals. The events and the reals are only valid during
+ * the callback. The strings stay valid as long as the dictionaries and the
+ * block do.
+ *
+ * The decoder state, including a stack of BEJ_MAX_STACK_DEPTH entries and
+ * the reals of a batch, is on the stack of the caller.
+ *
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] blockLength - length of the PLDM block.
+ * @param[in] events - array for the events of a batch.
+ * @param[in] capacity - number of events in the array. Should be
+ * BEJ_BATCH_DEFAULT_EVENTS or similar.
+ * @param[in] callbackBatch - called with each batch. reals holds the values
+ * of the real events, selected by BejBatchEvent::value.realIndex. A non zero
+ * return value stops the decoding and is returned.
+ * @param[in] dataPtr - passed to callbackBatch.
+ * @param[in] options - decoder options. Can be NULL. The stack storage is not
+ * used.
+ *
+ * @return 0 if successful.
+ */
+int bejDecodePldmBlockBatched(
+    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
+    uint32_t blockLength, struct BejBatchEvent* events, uint32_t capacity,
+    int (*callbackBatch)(const struct BejBatchEvent* events, uint32_t count,
+                         const struct BejReal* reals, void* dataPtr),
+    void* dataPtr, const struct BejDecoderOptions* options);
+
 #ifdef __cplusplus
 }
 #endif
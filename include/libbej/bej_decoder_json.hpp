@@ -2,14 +2,58 @@
 
 #include "bej_common.h"
 #include "bej_decoder_core.h"
+#include "bej_json_keys.hpp"
+#include "bej_json_string.hpp"
 
+#include <chrono>
+#include <functional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace libbej
 {
 
+/**
+ * @brief Receives the JSON output in pieces while decoding.
+ *
+ * Returns 0 if successful. Any other value stops the decoding and is returned
+ * by the decode call.
+ */
+using BejJsonOutputSink = std::function<int(std::string_view)>;
+
+/**
+ * @brief This structure is used to pass additional data to callback functions.
+ */
+struct BejJsonParam
+{
+    bool* isPrevAnnotated;
+    std::string* output;
+    // If not nullptr, the output is passed to the sink and cleared once it
+    // reaches flushSize bytes.
+    const BejJsonOutputSink* sink;
+    size_t flushSize;
+    // Optional JSON keys of the schema and annotation dictionaries.
+    const JsonKeyCache* schemaKeys;
+    const JsonKeyCache* annotationKeys;
+    // Longest string value accepted, including its NULL terminator.
+    size_t maxStringLength;
+    // State of a string passed in fragments.
+    JsonStringWriter stringWriter;
+    size_t stringRemaining;
+};
+
+/**
+ * @brief Create a sink writing the JSON output to a file descriptor.
+ *
+ * @param[in] fd - an open file descriptor, such as a file, a pipe or a
+ * socket. The sink does not close it.
+ * @return the sink.
+ */
+BejJsonOutputSink makeFdOutputSink(int fd);
+
 /**
  * @brief Class for decoding RDE BEJ to a JSON output.
  */
@@ -26,13 +70,160 @@ class BejDecoderJson
     int decode(const BejDictionaries& dictionaries,
                const std::span<const uint8_t> encodedPldmBlock);
 
+    /**
+     * @brief Decode only the properties selected by a projection.
+     *
+     * Properties outside of the projection are skipped without being decoded.
+     * The output has the same layout as decode() with the other properties
+     * left out, like the response to a Redfish $select query.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @param[in] projection - paths resolved using bejPathResolve().
+     * @return 0 if successful.
+     */
+    int decode(const BejDictionaries& dictionaries,
+               const std::span<const uint8_t> encodedPldmBlock,
+               const BejProjection& projection);
+
+    /**
+     * @brief Decode the encoded PLDM block using prepared dictionaries.
+     *
+     * The dictionaries are not validated again. See bejDictPrepare().
+     *
+     * @param[in] preparedDictionaries - prepared schema and annotation
+     * dictionaries.
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @return 0 if successful.
+     */
+    int decodePrepared(const BejDictionaryIndexes& preparedDictionaries,
+                       const std::span<const uint8_t> encodedPldmBlock);
+
+    /**
+     * @brief Decode a single property of the encoded PLDM block.
+     *
+     * Only the tuples along the path are visited. The output is the JSON
+     * value of the property, without its name.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] path - path resolved using bejPathResolve().
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @return 0 if successful.
+     */
+    int decodePath(const BejDictionaries& dictionaries, const BejPath& path,
+                   const std::span<const uint8_t> encodedPldmBlock);
+
+    /**
+     * @brief Decode a single property of the encoded PLDM block.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] path - property path such as "Status/Health". See
+     * bejPathResolve().
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @return 0 if successful.
+     */
+    int decodePath(const BejDictionaries& dictionaries, const std::string& path,
+                   const std::span<const uint8_t> encodedPldmBlock);
+
+    /**
+     * @brief Decode a PLDM block stored in several non-contiguous buffers.
+     *
+     * Same as decode() but the block is split between the segments, for
+     * example MCTP fragments or the two parts of a wrapped ring buffer. The
+     * block is not copied. Only a tuple split between two segments goes
+     * through a bounce buffer.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] segments - parts of the PLDM block in order.
+     * @return 0 if successful.
+     */
+    int decodeSegments(
+        const BejDictionaries& dictionaries,
+        const std::span<const std::span<const uint8_t>> segments);
+
+    /**
+     * @brief Start decoding a PLDM block received in chunks.
+     *
+     * Feed the chunks using decodeChunk() and call decodeEnd() after the last
+     * one. The output grows as the chunks are decoded. The dictionaries have
+     * to stay valid and this object must not be moved until decodeEnd().
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] maxSplitTupleSize - size of the largest tuple that can be
+     * split between two chunks.
+     * @return 0 if successful.
+     */
+    int decodeBegin(const BejDictionaries& dictionaries,
+                    uint32_t maxSplitTupleSize = defaultMaxSplitTupleSize);
+
+    /**
+     * @brief Decode the next chunk of the PLDM block.
+     *
+     * @param[in] chunk - next bytes of the PLDM block. Not used after this
+     * returns.
+     * @return 0 if successful.
+     */
+    int decodeChunk(const std::span<const uint8_t> chunk);
+
+    /**
+     * @brief Decode the next chunk of the PLDM block for a limited time.
+     *
+     * Returns bejErrorWouldBlock once maxTuples tuples are decoded or the
+     * deadline has passed. Call this again with the part of the chunk that
+     * was not consumed to continue.
+     *
+     * @param[in] chunk - next bytes of the PLDM block. Not used after this
+     * returns.
+     * @param[in] maxTuples - maximum number of tuples to decode. 0 for no
+     * limit.
+     * @param[in] deadline - time to give control back to the caller.
+     * @param[out] consumed - number of bytes of the chunk used.
+     * @return 0 if the chunk is consumed. bejErrorWouldBlock if the budget ran
+     * out before that.
+     */
+    int decodeChunk(const std::span<const uint8_t> chunk, uint32_t maxTuples,
+                    std::chrono::steady_clock::time_point deadline,
+                    size_t& consumed);
+
+    /**
+     * @brief Finish decoding a PLDM block received in chunks.
+     *
+     * @return 0 if the whole block was received and decoded.
+     */
+    int decodeEnd();
+
     /**
      * @brief Get the JSON output related to the latest call to decode.
      *
      * @return std::string containing a JSON. If the decoding was
-     * unsuccessful, this might contain partial data (invalid JSON).
+     * unsuccessful, this might contain partial data (invalid JSON). Empty if
+     * the output was passed to a sink. Valid until the next decode.
+     */
+    const std::string& getOutput() const
+    {
+        return output;
+    }
+
+    /**
+     * @brief Pass the JSON output to a sink while decoding instead of keeping
+     * all of it in memory.
+     *
+     * The output is flushed to the sink in pieces of about flushSize bytes,
+     * each ending after a property, and the rest once the decoding succeeds.
+     * This keeps the memory use bounded for large resources and lets the
+     * output be sent before the decoding finishes.
+     *
+     * @param[in] newSink - sink for the subsequent decode calls. Pass nullptr
+     * to keep the whole output in memory again.
+     * @param[in] flushSize - size of the output to collect before calling the
+     * sink.
      */
-    std::string getOutput();
+    void setOutputSink(BejJsonOutputSink newSink,
+                       size_t flushSize = defaultFlushSize)
+    {
+        sink = std::move(newSink);
+        sinkFlushSize = flushSize;
+    }
 
     /**
      * @brief Choose how the decoder reacts to buffer bytes that lie
@@ -51,11 +242,138 @@ class BejDecoderJson
         trailingPolicy = policy;
     }
 
+    /**
+     * @brief Provide prebuilt indexes for the dictionaries passed to
+     * decode().
+     *
+     * Indexes are optional. Without them, dictionary lookups use a linear
+     * search. The indexes are not copied, so they should outlive the
+     * subsequent decode() calls.
+     *
+     * @param[in] indexes - dictionary indexes. Can be nullptr to go back to
+     * linear searches.
+     */
+    void setDictionaryIndexes(const BejDictionaryIndexes* indexes)
+    {
+        dictionaryIndexes = indexes;
+    }
+
+    /**
+     * @brief Provide the JSON keys of the dictionaries passed to decode().
+     *
+     * With the keys, every property name is added to the output using a
+     * single copy of its escaped "Name": fragment. Names not found in the
+     * caches are added as before. The caches are not copied, so they should
+     * outlive the subsequent decode() calls.
+     *
+     * @param[in] schema - keys of the schema dictionary or nullptr.
+     * @param[in] annotation - keys of the annotation dictionary or nullptr.
+     */
+    void setKeyCaches(const JsonKeyCache* schema,
+                      const JsonKeyCache* annotation)
+    {
+        schemaKeys = schema;
+        annotationKeys = annotation;
+    }
+
+    /**
+     * @brief Set the longest string value accepted by the decoder.
+     *
+     * Longer strings fail the decoding with bejErrorInvalidSize. Strings of
+     * any length can be decoded from chunks without holding them in one
+     * buffer, see decodeChunk(), so this is only a sanity limit.
+     *
+     * @param[in] maxLength - maximum length in bytes, including the NULL
+     * terminator.
+     */
+    void setMaxStringLength(size_t maxLength)
+    {
+        maxStringLength = maxLength;
+    }
+
+    /**
+     * @brief Keep the decoder stack in caller provided memory.
+     *
+     * By default the stack is a std::vector that grows as needed and is
+     * reached through the stack callbacks. With fixed storage, the decoder
+     * uses the array directly. Resources nested deeper than the storage fail
+     * the decoding with bejErrorInvalidSize.
+     *
+     * The storage is not copied, so it should outlive the subsequent decode
+     * calls.
+     *
+     * @param[in] storage - stack entries. Use an empty span to go back to the
+     * std::vector.
+     */
+    void setStackStorage(std::span<BejStackProperty> storage)
+    {
+        fixedStack = storage;
+    }
+
+    static constexpr size_t defaultMaxStringLength = 65536;
+    // Fits the largest tuple held while decoding chunks. Strings are passed
+    // in fragments and never held.
+    static constexpr uint32_t defaultMaxSplitTupleSize = 65536 + 32;
+    static constexpr size_t defaultFlushSize = 4096;
+
   private:
+    /**
+     * @brief Decode using either plain or prepared dictionaries.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding. Used if
+     * preparedDictionaries is nullptr.
+     * @param[in] preparedDictionaries - prepared dictionaries or nullptr.
+     * @param[in] path - path of the property to decode or nullptr to decode
+     * the whole block. Only used with plain dictionaries.
+     * @param[in] projection - properties to decode or nullptr.
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @return 0 if successful.
+     */
+    int decodePldmBlock(const BejDictionaries* dictionaries,
+                        const BejDictionaryIndexes* preparedDictionaries,
+                        const BejPath* path, const BejProjection* projection,
+                        const std::span<const uint8_t> encodedPldmBlock);
+
+    /**
+     * @brief Get the callback data for a new decode.
+     *
+     * @return the callback data pointing to this object.
+     */
+    BejJsonParam makeCallbackData();
+
+    /**
+     * @brief Pass the remaining output to the sink after a decode.
+     *
+     * @param[in] ret - result of the decode.
+     * @return ret or the error returned by the sink.
+     */
+    int finishOutput(int ret);
+
+    /**
+     * @brief Reset the stack for a new decode.
+     *
+     * @param[out] storage - filled in if fixed storage is used.
+     * @return storage if fixed storage is used, otherwise nullptr to use the
+     * stack callbacks.
+     */
+    BejStackStorage* resetStack(BejStackStorage& storage);
+
     bool isPrevAnnotated;
     std::string output;
+    BejJsonOutputSink sink;
+    size_t sinkFlushSize = defaultFlushSize;
+    size_t maxStringLength = defaultMaxStringLength;
     std::vector<BejStackProperty> stack;
+    std::span<BejStackProperty> fixedStack;
     BejTrailingDataPolicy trailingPolicy = bejTrailingIgnore;
+    const BejDictionaryIndexes* dictionaryIndexes = nullptr;
+    const JsonKeyCache* schemaKeys = nullptr;
+    const JsonKeyCache* annotationKeys = nullptr;
+    // State of the decodeBegin(), decodeChunk() and decodeEnd() calls.
+    BejIncrementalDecoder incrementalDecoder;
+    BejStackStorage chunkStackStorage;
+    BejJsonParam chunkCallbackData;
+    std::vector<uint8_t> chunkBuffer;
 };
 
 } // namespace libbej
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "bej_common.h"
+#include "bej_decoder_core.h"
+#include "bej_json_number.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace libbej
+{
+
+/**
+ * @brief Decodes a PLDM block into a nlohmann::json object.
+ *
+ * The JSON tree is built from the decoded events, without writing and
+ * parsing JSON text. This header is not used by the library itself, so only
+ * users including it need nlohmann_json.
+ */
+class BejDecoderNlohmann
+{
+  public:
+    /**
+     * @brief Decode a PLDM block.
+     *
+     * @param[in] dictionaries - dictionaries needed for decoding.
+     * @param[in] encodedPldmBlock - encoded PLDM block.
+     * @param[in] options - decoder options. Can be nullptr. The stack storage
+     * is not used.
+     * @return 0 if successful.
+     */
+    int decode(const BejDictionaries& dictionaries,
+               std::span<const uint8_t> encodedPldmBlock,
+               const BejDecoderOptions* options = nullptr)
+    {
+        handler.reset();
+        BejCursor cursor;
+        int ret = bejCursorInit(&cursor, &dictionaries, encodedPldmBlock.data(),
+                                encodedPldmBlock.size_bytes(), options);
+        if (ret != 0)
+        {
+            return ret;
+        }
+        handler.cursor = &cursor;
+        const BejCursorEvent* event;
+        while ((ret = bejCursorNext(&cursor, &event)) == 0 && event != nullptr)
+        {
+            ret = dispatch(*event);
+            if (ret != 0)
+            {
+                break;
+            }
+        }
+        handler.cursor = nullptr;
+        return ret;
+    }
+
+    /**
+     * @brief Get the JSON object of the latest call to decode.
+     *
+     * @return the decoded JSON. If the decoding was unsuccessful, this might
+     * be incomplete.
+     */
+    nlohmann::json& getOutput()
+    {
+        return handler.output;
+    }
+
+  private:
+    /**
+     * @brief Builds the JSON tree. Sets and arrays are built on a stack and
+     * moved into their parent once they end.
+     */
+    class Handler
+    {
+      public:
+        nlohmann::json output;
+        // Cursor of the running decode.
+        const BejCursor* cursor = nullptr;
+
+        void reset()
+        {
+            output = nullptr;
+            stack.clear();
+        }
+
+        int setStart(const BejCursorEvent& event)
+        {
+            stack.emplace_back(getName(event), nlohmann::json::object());
+            return 0;
+        }
+
+        int setEnd()
+        {
+            return endSection();
+        }
+
+        int arrayStart(const BejCursorEvent& event)
+        {
+            // The element count comes from the encoded stream. Each element
+            // takes at least minTupleSize bytes, so don't reserve more than
+            // the rest of the payload can hold.
+            uint64_t maxElements =
+                bejCursorRemainingBytes(cursor) / minTupleSize;
+            nlohmann::json array = nlohmann::json::array();
+            array.get_ref<nlohmann::json::array_t&>().reserve(
+                std::min<uint64_t>(event.value.elementCount, maxElements));
+            stack.emplace_back(getName(event), std::move(array));
+            return 0;
+        }
+
+        int arrayEnd()
+        {
+            return endSection();
+        }
+
+        int null(const BejCursorEvent& event)
+        {
+            return add(event, nullptr);
+        }
+
+        int integer(const BejCursorEvent& event, int64_t value)
+        {
+            return add(event, value);
+        }
+
+        int enumValue(const BejCursorEvent& event, std::string_view value)
+        {
+            return add(event, value);
+        }
+
+        int string(const BejCursorEvent& event, std::string_view value)
+        {
+            return add(event, value);
+        }
+
+        int real(const BejCursorEvent& event, const BejReal& value)
+        {
+            // Same text as BejDecoderJson, parsed without depending on the
+            // locale.
+            char text[maxJsonRealLength];
+            char* end = formatJsonReal(text, value);
+            double number;
+            if (end == nullptr ||
+                std::from_chars(text, end, number).ec != std::errc())
+            {
+                return bejErrorInvalidSize;
+            }
+            return add(event, number);
+        }
+
+        int boolean(const BejCursorEvent& event, bool value)
+        {
+            return add(event, value);
+        }
+
+        int resourceLink(const BejCursorEvent& event, uint64_t value)
+        {
+            // Same "%L<id>" string as BejDecoderJson.
+            std::string link = "%L";
+            appendJsonInteger(link, value);
+            return add(event, std::move(link));
+        }
+
+      private:
+        // Smallest encoded tuple: one byte each for S, F and L.
+        static constexpr uint32_t minTupleSize = 3;
+
+        /**
+         * @brief Get the JSON key of a property.
+         */
+        static std::string getName(const BejCursorEvent& event)
+        {
+            if (event.annotatedPropertyName == nullptr)
+            {
+                return event.propertyName;
+            }
+            return std::string(event.annotatedPropertyName) +
+                   event.propertyName;
+        }
+
+        /**
+         * @brief Add a value to the innermost set or array.
+         */
+        int add(const BejCursorEvent& event, nlohmann::json&& value)
+        {
+            if (stack.empty())
+            {
+                return bejErrorUnknown;
+            }
+            nlohmann::json& parent = stack.back().second;
+            if (parent.is_array())
+            {
+                parent.push_back(std::move(value));
+            }
+            else
+            {
+                parent[getName(event)] = std::move(value);
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Move the innermost set or array into its parent.
+         */
+        int endSection()
+        {
+            if (stack.empty())
+            {
+                return bejErrorUnknown;
+            }
+            std::pair<std::string, nlohmann::json> section =
+                std::move(stack.back());
+            stack.pop_back();
+            if (stack.empty())
+            {
+                output = std::move(section.second);
+                return 0;
+            }
+            nlohmann::json& parent = stack.back().second;
+            if (parent.is_array())
+            {
+                parent.push_back(std::move(section.second));
+            }
+            else
+            {
+                parent[std::move(section.first)] = std::move(section.second);
+            }
+            return 0;
+        }
+
+        // Open sets and arrays with their keys.
+        std::vector<std::pair<std::string, nlohmann::json>> stack;
+    };
+
+    /**
+     * @brief Call the handler member function for an event.
+     *
+     * @param[in] event - a decoded event.
+     * @return 0 if successful.
+     */
+    int dispatch(const BejCursorEvent& event)
+    {
+        switch (event.type)
+        {
+            case bejCursorSetStart:
+                return handler.setStart(event);
+            case bejCursorSetEnd:
+                return handler.setEnd();
+            case bejCursorArrayStart:
+                return handler.arrayStart(event);
+            case bejCursorArrayEnd:
+                return handler.arrayEnd();
+            case bejCursorNull:
+                return handler.null(event);
+            case bejCursorInteger:
+                return handler.integer(event, event.value.integer);
+            case bejCursorEnum:
+                return handler.enumValue(
+                    event, std::string_view(event.value.enumValue));
+            case bejCursorString:
+                return handler.string(
+                    event, std::string_view(event.value.string.value,
+                                            event.value.string.length));
+            case bejCursorReal:
+                return handler.real(event, event.value.real);
+            case bejCursorBool:
+                return handler.boolean(event, event.value.boolean);
+            case bejCursorResourceLink:
+                return handler.resourceLink(event, event.value.linkId);
+        }
+        return bejErrorUnknown;
+    }
+
+    Handler handler;
+};
+
+} // namespace libbej
@@ -114,6 +114,33 @@ int bejDictGetPropertyByName(
     const char* propertyName, const struct BejDictionaryProperty** property,
     uint16_t* propertyOffset);
 
+/**
+ * @brief Check that a property name lies within the dictionary and that its
+ * length matches the NULL terminator.
+ *
+ * @param[in] dictionary - dictionary containing the name.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes.
+ * @param[in] nameOffset - dictionary offset of the name.
+ * @param[in] nameLength - length of the name including the NULL terminator.
+ * @return true if the name is valid. An empty name (nameLength 0) is valid.
+ */
+bool bejDictValidatePropertyName(const uint8_t* dictionary,
+                                 uint32_t dictionarySize, uint16_t nameOffset,
+                                 uint8_t nameLength);
+
+/**
+ * @brief Validate a whole dictionary.
+ *
+ * This checks the dictionary header against the actual dictionary size,
+ * every property name and every child range. Dictionaries passing this check
+ * can be looked up without validating each property found.
+ *
+ * @param[in] dictionary - dictionary to validate.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes.
+ * @return 0 if the dictionary is valid.
+ */
+int bejDictValidate(const uint8_t* dictionary, uint32_t dictionarySize);
+
 #ifdef __cplusplus
 }
 #endif
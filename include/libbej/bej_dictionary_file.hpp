@@ -0,0 +1,205 @@
+#pragma once
+
+#include "bej_common.h"
+#include "bej_dictionary_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace libbej
+{
+
+/**
+ * @brief Identity of a dictionary file, taken from its file status.
+ *
+ * Rewriting or replacing the file changes at least one of the fields, so a
+ * matching identity means the file content did not change. A rewrite keeping
+ * the size and the dictionary header within one file system timestamp tick
+ * is not detected.
+ */
+struct BejDictionaryFileIdentity
+{
+    uint64_t device;
+    uint64_t inode;
+    // Last modification and status change times in nanoseconds.
+    int64_t mtimeNs;
+    int64_t ctimeNs;
+};
+
+/**
+ * @brief Header of a dictionary index sidecar file.
+ *
+ * The header is followed by the range slots (uint32_t[entryCount]) and the
+ * range tables (uint16_t[tablesLength]) of a BejDictionaryIndex.
+ */
+struct BejDictionaryIndexFileHeader
+{
+    // Should be bejDictionaryIndexFileMagic.
+    uint32_t magic;
+    // Should be bejDictionaryIndexFileVersion.
+    uint32_t version;
+    // Identity of the dictionary file the index was built from.
+    BejDictionaryFileIdentity file;
+    // Size of the dictionary the index was built from.
+    uint32_t dictionarySize;
+    // Number of properties in the dictionary.
+    uint16_t entryCount;
+    // Version tag from the dictionary header.
+    uint8_t versionTag;
+    uint8_t reserved;
+    // Schema version from the dictionary header.
+    uint32_t schemaVersion;
+    // Number of uint16_t elements in the range tables.
+    uint32_t tablesLength;
+    // Prepared marks of the index. See BejDictionaryIndex.
+    uint32_t validatedSize;
+    uint32_t preparedSeal;
+    uint32_t reserved2;
+};
+
+// "BEJI" in little endian.
+constexpr uint32_t bejDictionaryIndexFileMagic = 0x494a4542;
+constexpr uint32_t bejDictionaryIndexFileVersion = 3;
+
+/**
+ * @brief A dictionary file mapped read-only into memory.
+ *
+ * The dictionary is validated once and indexed. The index is either loaded
+ * from a sidecar file written by a previous run or built in memory. A sidecar
+ * is only used if it was built from the same, unchanged dictionary file. This
+ * is checked using the file status and the dictionary header, so reusing a
+ * sidecar neither validates nor hashes the dictionary again.
+ */
+class MappedDictionary
+{
+  public:
+    /**
+     * @brief Map a dictionary file.
+     *
+     * @param[in] dictionaryPath - path to the dictionary file.
+     * @param[in] indexPath - path to the index sidecar file. If the sidecar
+     * is missing or stale, the index is built and the sidecar is rewritten.
+     * Use an empty path to always build the index in memory.
+     * @return the mapped dictionary or nullptr if the file cannot be mapped or
+     * the dictionary is invalid.
+     */
+    static std::unique_ptr<MappedDictionary>
+        open(const std::string& dictionaryPath,
+             const std::string& indexPath = "");
+
+    ~MappedDictionary();
+
+    MappedDictionary(const MappedDictionary&) = delete;
+    MappedDictionary& operator=(const MappedDictionary&) = delete;
+
+    /**
+     * @brief Get the dictionary bytes.
+     */
+    std::span<const uint8_t> data() const
+    {
+        return {dictionary, dictionarySize};
+    }
+
+    /**
+     * @brief Get the prepared index of the dictionary.
+     */
+    const BejDictionaryIndex* index() const
+    {
+        return &dictionaryIndex;
+    }
+
+    /**
+     * @brief Check whether the index was loaded from a sidecar file.
+     */
+    bool indexFromSidecar() const
+    {
+        return sidecar != nullptr;
+    }
+
+    /**
+     * @brief Write the index to a sidecar file.
+     *
+     * The sidecar is written to a temporary file first and renamed, so
+     * readers never see a partial file.
+     *
+     * @param[in] indexPath - path to the index sidecar file.
+     * @return true if successful.
+     */
+    bool writeIndex(const std::string& indexPath) const;
+
+  private:
+    MappedDictionary() = default;
+
+    /**
+     * @brief Use the index stored in a sidecar file if it matches the
+     * dictionary file.
+     *
+     * @param[in] indexPath - path to the index sidecar file.
+     * @return true if the sidecar index is used.
+     */
+    bool attachIndex(const std::string& indexPath);
+
+    const uint8_t* dictionary = nullptr;
+    size_t dictionarySize = 0;
+    const uint8_t* sidecar = nullptr;
+    size_t sidecarSize = 0;
+    BejDictionaryFileIdentity fileIdentity{};
+    std::vector<uint32_t> indexBuffer;
+    BejDictionaryIndex dictionaryIndex{};
+};
+
+/**
+ * @brief Schema, annotation and optionally error dictionaries mapped from
+ * files.
+ */
+class MappedDictionaries
+{
+  public:
+    /**
+     * @brief Map the dictionaries needed for decoding and encoding.
+     *
+     * Index sidecars are stored next to the dictionaries using the
+     * indexSuffix appended to the dictionary path.
+     *
+     * @param[in] schemaPath - path to the schema dictionary.
+     * @param[in] annotationPath - path to the annotation dictionary.
+     * @param[in] errorPath - path to the error dictionary. Can be empty.
+     * @param[in] indexSuffix - suffix of the sidecar files. Use an empty
+     * suffix to disable the sidecar files.
+     * @return the mapped dictionaries or nullptr on failure.
+     */
+    static std::unique_ptr<MappedDictionaries>
+        open(const std::string& schemaPath, const std::string& annotationPath,
+             const std::string& errorPath = "",
+             const std::string& indexSuffix = ".idx");
+
+    /**
+     * @brief Get the dictionaries for the decode and encode APIs.
+     */
+    const BejDictionaries& dictionaries() const
+    {
+        return bejDictionaries;
+    }
+
+    /**
+     * @brief Get the prepared schema and annotation dictionaries.
+     */
+    const BejDictionaryIndexes& indexes() const
+    {
+        return bejIndexes;
+    }
+
+  private:
+    MappedDictionaries() = default;
+
+    std::unique_ptr<MappedDictionary> schema;
+    std::unique_ptr<MappedDictionary> annotation;
+    std::unique_ptr<MappedDictionary> error;
+    BejDictionaries bejDictionaries{};
+    BejDictionaryIndexes bejIndexes{};
+};
+
+} // namespace libbej
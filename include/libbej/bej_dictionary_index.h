@@ -0,0 +1,217 @@
+#pragma once
+
+#include "bej_common.h"
+#include "bej_dictionary.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Value of a range slot for a dictionary entry which is not the first
+ * entry of a child range.
+ */
+#define BEJ_DICT_INDEX_NO_TABLE UINT32_MAX
+
+/**
+ * @brief Value of an unused entry in a child range lookup table.
+ */
+#define BEJ_DICT_INDEX_EMPTY_ENTRY UINT16_MAX
+
+/**
+ * @brief Prebuilt lookup tables for a dictionary.
+ *
+ * Every property in a dictionary points to its children using a child range
+ * (childPointerOffset and childCount). For each distinct child range, the index
+ * holds two small open addressing tables. One is keyed by the sequence number
+ * of the children and the other one by a hash of their names. This makes a
+ * property lookup a direct table access instead of a linear scan over the
+ * dictionary.
+ *
+ * An index built using bejDictPrepare() also acts as a prepared dictionary.
+ * The whole dictionary was validated once, so lookups using the index skip
+ * the per property validation. Only bejDictPrepare() marks an index as
+ * prepared. The generated indexes of bej_dict_compile and the index sidecar
+ * files copy the marks it produced. Changing any field of a prepared index
+ * turns it back into a plain index.
+ *
+ * The index does not own any memory. Both the dictionary and the buffer used
+ * for the tables should outlive the index.
+ */
+struct BejDictionaryIndex
+{
+    // Dictionary used to build the index.
+    const uint8_t* dictionary;
+    // Number of properties in the dictionary.
+    uint16_t entryCount;
+    // One slot per dictionary property. If a child range starts at the
+    // property, this holds the position of the range table within tables.
+    // Otherwise BEJ_DICT_INDEX_NO_TABLE.
+    const uint32_t* rangeSlots;
+    // Range tables. A range table starts with log2 of the table capacity,
+    // followed by the sequence number table and the name table. Table
+    // entries are property indexes or BEJ_DICT_INDEX_EMPTY_ENTRY.
+    const uint16_t* tables;
+    // Number of uint16_t elements used in tables.
+    uint32_t tablesLength;
+    // Private. Size of the dictionary validated by bejDictPrepare(). 0 if
+    // the index is not prepared.
+    uint32_t validatedSize;
+    // Private. Set by bejDictPrepare() from the other fields and the
+    // dictionary header. Checked by bejDictIndexIsPrepared().
+    uint32_t preparedSeal;
+};
+
+/**
+ * @brief Indexes of the dictionaries used for decoding or encoding. Any of the
+ * indexes can be NULL. In that case, lookups in the related dictionary will
+ * use a linear search.
+ */
+struct BejDictionaryIndexes
+{
+    const struct BejDictionaryIndex* schemaIndex;
+    const struct BejDictionaryIndex* annotationIndex;
+};
+
+/**
+ * @brief Get the buffer size needed to build the index of a dictionary.
+ *
+ * @param[in] dictionary - a dictionary.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes.
+ * @return number of bytes needed for the index buffer. 0 if the property
+ * table does not fit in the dictionary buffer.
+ */
+size_t bejDictIndexGetBufferSize(const uint8_t* dictionary,
+                                 uint32_t dictionarySize);
+
+/**
+ * @brief Build the index of a dictionary.
+ *
+ * Child ranges pointing outside the dictionary are not indexed. Lookups
+ * starting at such ranges will fall back to a linear search. Every property
+ * name is validated, so names found using the index are not checked again.
+ *
+ * @param[in] dictionary - a dictionary.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes. The
+ * dictionary is rejected if its property table does not fit.
+ * @param[in] buffer - memory for the lookup tables. Should be aligned for
+ * uint32_t.
+ * @param[in] bufferSize - size of the buffer in bytes. Use
+ * bejDictIndexGetBufferSize() to get the size needed.
+ * @param[out] index - if successful, this will hold the index.
+ * @return 0 if successful.
+ */
+int bejDictBuildIndex(const uint8_t* dictionary, uint32_t dictionarySize,
+                      void* buffer, size_t bufferSize,
+                      struct BejDictionaryIndex* index);
+
+/**
+ * @brief Validate a dictionary and build its index.
+ *
+ * The resulting index is a prepared dictionary. Lookups using it don't
+ * validate the properties found, and the prepared decode and encode entry
+ * points don't check the dictionary headers again. Use this for dictionaries
+ * that don't change once loaded.
+ *
+ * @param[in] dictionary - dictionary to prepare.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes.
+ * @param[in] buffer - memory for the lookup tables. Should be aligned for
+ * uint32_t.
+ * @param[in] bufferSize - size of the buffer in bytes. Use
+ * bejDictIndexGetBufferSize() to get the size needed.
+ * @param[out] index - if successful, this will hold the validated index.
+ * @return 0 if successful.
+ */
+int bejDictPrepare(const uint8_t* dictionary, uint32_t dictionarySize,
+                   void* buffer, size_t bufferSize,
+                   struct BejDictionaryIndex* index);
+
+/**
+ * @brief Check whether an index was built from a validated dictionary.
+ *
+ * The index should be unchanged since bejDictPrepare() returned it, and the
+ * dictionary header should still match the validated dictionary.
+ *
+ * @param[in] index - index to check. Can be NULL.
+ * @return true if the index is a prepared dictionary.
+ */
+bool bejDictIndexIsPrepared(const struct BejDictionaryIndex* index);
+
+/**
+ * @brief Get the property related to the given sequence number using an
+ * index.
+ *
+ * This gives the same result as bejDictGetProperty(). If the index is NULL or
+ * the search doesn't start at an indexed child range, this will fall back to
+ * bejDictGetProperty(). The property found is validated like
+ * bejDictGetProperty() does.
+ *
+ * @param[in] dictionary - dictionary containing the sequence number.
+ * @param[in] index - index of the dictionary. Can be NULL.
+ * @param[in] startingPropertyOffset - offset of the starting property for
+ * the search.
+ * @param[in] sequenceNumber - sequence number of the property.
+ * @param[out] property - if the search is successful, this will point to a
+ * valid property.
+ * @return 0 if successful.
+ */
+int bejDictIndexGetProperty(const uint8_t* dictionary,
+                            const struct BejDictionaryIndex* index,
+                            uint16_t startingPropertyOffset,
+                            uint16_t sequenceNumber,
+                            const struct BejDictionaryProperty** property);
+
+/**
+ * @brief Same as bejDictIndexGetProperty() for a prepared dictionary.
+ *
+ * Every property was validated while preparing the dictionary, so the
+ * property found is not validated again. The index is not checked either:
+ * the caller should check it once with bejDictIndexIsPrepared() before its
+ * lookups.
+ *
+ * @param[in] dictionary - dictionary containing the sequence number.
+ * @param[in] index - a prepared index of the dictionary.
+ * @param[in] startingPropertyOffset - offset of the starting property for
+ * the search.
+ * @param[in] sequenceNumber - sequence number of the property.
+ * @param[out] property - if the search is successful, this will point to a
+ * valid property.
+ * @return 0 if successful.
+ */
+int bejDictIndexGetPreparedProperty(
+    const uint8_t* dictionary, const struct BejDictionaryIndex* index,
+    uint16_t startingPropertyOffset, uint16_t sequenceNumber,
+    const struct BejDictionaryProperty** property);
+
+/**
+ * @brief Get the property related to the given property name using an index.
+ *
+ * If the search starts at an indexed child range, only the properties of that
+ * range are searched and a missing name fails without scanning the rest of
+ * the dictionary. Otherwise, or if the index is NULL, this will fall back to
+ * bejDictGetPropertyByName().
+ *
+ * @param[in] dictionary - dictionary containing the property.
+ * @param[in] index - index of the dictionary. Can be NULL.
+ * @param[in] startingPropertyOffset - offset of the starting property for
+ * the search.
+ * @param[in] propertyName - name of the searched property.
+ * @param[out] property - if the search is successful, this will point to a
+ * valid property.
+ * @param[out] propertyOffset - if the search is successful, this will point
+ * to the offset of the property within the dictionary. Can provide a NULL
+ * pointer if this is not needed.
+ * @return 0 if successful.
+ */
+int bejDictIndexGetPropertyByName(
+    const uint8_t* dictionary, const struct BejDictionaryIndex* index,
+    uint16_t startingPropertyOffset, const char* propertyName,
+    const struct BejDictionaryProperty** property, uint16_t* propertyOffset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
+#include "bej_json_keys.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <tuple>
+#include <vector>
+
+namespace libbej
+{
+
+/**
+ * @brief Hash the bytes of a dictionary using 64bit FNV-1a.
+ *
+ * @param[in] dictionary - dictionary bytes.
+ * @return hash of the dictionary.
+ */
+uint64_t dictionaryContentHash(std::span<const uint8_t> dictionary);
+
+/**
+ * @brief An immutable copy of a dictionary together with its index.
+ *
+ * The dictionary is validated and indexed once using bejDictPrepare(). The
+ * object never changes after creation, so it can be shared between threads
+ * without locking.
+ */
+class PreparedDictionary
+{
+  public:
+    /**
+     * @brief Copy, validate and index a dictionary.
+     *
+     * @param[in] dictionary - dictionary bytes.
+     * @param[in] contentHash - hash of the dictionary bytes.
+     * @return the prepared dictionary or nullptr if the dictionary is
+     * invalid.
+     */
+    static std::shared_ptr<const PreparedDictionary>
+        create(std::span<const uint8_t> dictionary, uint64_t contentHash);
+
+    /**
+     * @brief Get the dictionary bytes.
+     */
+    std::span<const uint8_t> data() const
+    {
+        return dictionary;
+    }
+
+    /**
+     * @brief Get the prepared index of the dictionary. This can be passed to
+     * the prepared decode and encode entry points.
+     */
+    const BejDictionaryIndex* index() const
+    {
+        return &dictionaryIndex;
+    }
+
+    /**
+     * @brief Get the JSON keys of the dictionary properties. See
+     * BejDecoderJson::setKeyCaches().
+     */
+    const JsonKeyCache& jsonKeys() const
+    {
+        return keyCache;
+    }
+
+    /**
+     * @brief Get the schema version from the dictionary header.
+     */
+    uint32_t schemaVersion() const;
+
+    /**
+     * @brief Get the hash of the dictionary bytes.
+     */
+    uint64_t contentHash() const
+    {
+        return hash;
+    }
+
+    PreparedDictionary(const PreparedDictionary&) = delete;
+    PreparedDictionary& operator=(const PreparedDictionary&) = delete;
+
+  private:
+    PreparedDictionary() = default;
+
+    std::vector<uint8_t> dictionary;
+    std::vector<uint32_t> indexBuffer;
+    BejDictionaryIndex dictionaryIndex{};
+    JsonKeyCache keyCache;
+    uint64_t hash = 0;
+};
+
+/**
+ * @brief Interns dictionaries so identical dictionaries from different
+ * devices share one prepared copy.
+ *
+ * Dictionaries are keyed by a hash of their content, the schema version and
+ * the size, and are confirmed with a byte comparison. The registry only
+ * keeps weak references. A dictionary is released once the last user drops
+ * its std::shared_ptr.
+ *
+ * Lookups read an immutable snapshot of the registry and never wait for the
+ * writer mutex. Adding a dictionary prepares it without holding any lock,
+ * then copies the snapshot under the writer mutex and publishes the new one
+ * through a std::atomic<std::shared_ptr>. That atomic is not lock-free on
+ * common standard libraries (libstdc++ guards it with a small internal
+ * lock), so loading and publishing a snapshot still briefly serialize.
+ */
+class DictionaryRegistry
+{
+  public:
+    /**
+     * @brief Get the shared copy of a dictionary, adding it if needed.
+     *
+     * @param[in] dictionary - dictionary bytes. The registry keeps its own
+     * copy, so the buffer can be released after this call.
+     * @return the shared prepared dictionary or nullptr if the dictionary is
+     * invalid.
+     */
+    std::shared_ptr<const PreparedDictionary>
+        intern(std::span<const uint8_t> dictionary);
+
+    /**
+     * @brief Find a dictionary without adding it.
+     *
+     * @param[in] dictionary - dictionary bytes.
+     * @return the shared prepared dictionary or nullptr if the registry
+     * doesn't hold an identical dictionary.
+     */
+    std::shared_ptr<const PreparedDictionary>
+        find(std::span<const uint8_t> dictionary) const;
+
+    /**
+     * @brief Get the number of dictionaries still in use.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the process wide registry.
+     */
+    static DictionaryRegistry& instance();
+
+  private:
+    // Content hash, schema version and dictionary size.
+    using Key = std::tuple<uint64_t, uint32_t, size_t>;
+    using Entries =
+        std::multimap<Key, std::weak_ptr<const PreparedDictionary>>;
+
+    /**
+     * @brief Find a dictionary in a snapshot of the registry.
+     */
+    static std::shared_ptr<const PreparedDictionary>
+        findIn(const Entries& entries, const Key& key,
+               std::span<const uint8_t> dictionary);
+
+    /**
+     * @brief Build the key of a dictionary.
+     */
+    static Key makeKey(std::span<const uint8_t> dictionary);
+
+    std::atomic<std::shared_ptr<const Entries>> snapshot{
+        std::make_shared<const Entries>()};
+    std::mutex writerMutex;
+};
+
+} // namespace libbej
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "bej_common.h"
+#include "bej_decoder_core.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Value of BejDomNode.firstChild and BejDomNode.nextSibling when there
+ * is no such node.
+ */
+#define BEJ_DOM_NO_NODE UINT32_MAX
+
+/**
+ * @brief One decoded property.
+ *
+ * Nodes are stored in the order the properties appear in the stream, so the
+ * first child of a set or an array is the node right after it. Names point
+ * into the dictionaries and string values point into the encoded PLDM block.
+ */
+struct BejDomNode
+{
+    // Name of the property. Empty for array elements and the root set.
+    const char* name;
+    // If not NULL, this node is an annotation of the named property. For
+    // example "Status" for "Status@Message.ExtendedInfo" where name is
+    // "@Message.ExtendedInfo".
+    const char* annotatedName;
+    // Value selected by type. For bejSet and bejArray this is the encoded
+    // element count.
+    union BejValue value;
+    // Index of the first child. BEJ_DOM_NO_NODE if there are no children.
+    uint32_t firstChild;
+    // Index of the next node with the same parent. BEJ_DOM_NO_NODE for the
+    // last child.
+    uint32_t nextSibling;
+    // Number of children of a set or an array.
+    uint32_t childCount;
+    // One of bejSet, bejArray, bejNull, bejInteger, bejEnum, bejString,
+    // bejReal, bejBoolean or bejResourceLink.
+    enum BejPrincipalDataType type;
+};
+
+/**
+ * @brief Caller provided memory for a decoded PLDM block.
+ *
+ * A built DOM is read-only and does not refer to the decoder, so it can be
+ * shared between threads as long as the dictionaries and the PLDM block stay
+ * valid.
+ */
+struct BejDom
+{
+    // Array with at least capacity nodes.
+    struct BejDomNode* nodes;
+    // Maximum number of nodes.
+    uint32_t capacity;
+    // Number of nodes in use. Set by bejDomBuild(). Node 0 is the root set.
+    uint32_t size;
+};
+
+/**
+ * @brief Get the number of DOM nodes needed for any encoded PLDM block of
+ * the given length.
+ *
+ * @param[in] blockLength - length of the encoded PLDM block.
+ * @return the maximum number of properties the block can hold.
+ */
+uint32_t bejDomGetMaxNodeCount(uint32_t blockLength);
+
+/**
+ * @brief Decode a PLDM block into a DOM.
+ *
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] blockLength - length of the PLDM block.
+ * @param[in] options - decoder options. Can be NULL. The stack storage is not
+ * used.
+ * @param[inout] dom - DOM with caller provided nodes.
+ * @return 0 if successful. bejErrorInvalidSize if the DOM is too small.
+ */
+int bejDomBuild(const struct BejDictionaries* dictionaries,
+                const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                const struct BejDecoderOptions* options, struct BejDom* dom);
+
+/**
+ * @brief Find a child of a set by its name.
+ *
+ * @param[in] dom - a built DOM.
+ * @param[in] parent - index of a bejSet node.
+ * @param[in] name - a NULL terminated property name. Annotations of a
+ * property can be found using the full name, for example
+ * "Status@Message.ExtendedInfo".
+ * @return index of the child or BEJ_DOM_NO_NODE if not found.
+ */
+uint32_t bejDomFindChild(const struct BejDom* dom, uint32_t parent,
+                         const char* name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bej_dictionary_index.h"
 #include "bej_tree.h"
 
 #include <stdlib.h>
@@ -29,8 +30,8 @@ struct BejEncoderOutputHandler
  * @param dictionaries - dictionaries used for encoding.
  * @param majorSchemaStartingOffset - starting dictionary offset for
  * encoding. Use BEJ_DICTIONARY_START_AT_HEAD to encode a complete
- * resource. Use the correct offset when encoding a subsection of a redfish
- * resource.
+ * resource. Use the offset of the property entry being encoded when
+ * encoding a subsection of a redfish resource.
  * @param schemaClass - schema class for the resource.
  * @param root - root node of the resource to be encoded. Root node has to
  * be a bejSet.
@@ -45,6 +46,74 @@ int bejEncode(const struct BejDictionaries* dictionaries,
               struct BejEncoderOutputHandler* output,
               struct BejPointerStackCallback* stack);
 
+/**
+ * @brief Optional settings for the encoder.
+ */
+struct BejEncoderOptions
+{
+    // Prebuilt dictionary indexes used for property name lookups. Can be
+    // NULL to use linear searches.
+    const struct BejDictionaryIndexes* dictionaryIndexes;
+    // Caller provided memory for the encoder stack. If not NULL, the stack is
+    // kept here instead of calling the stack callbacks, which can then be
+    // NULL. Encoding fails with bejErrorInvalidSize if the resource is nested
+    // deeper than the storage capacity.
+    struct BejPointerStackStorage* stackStorage;
+};
+
+/**
+ * @brief Perform BEJ encoding with the given options.
+ *
+ * Same as bejEncode() but allows the caller to change the encoder behaviour.
+ *
+ * @param dictionaries - dictionaries used for encoding.
+ * @param majorSchemaStartingOffset - starting dictionary offset for
+ * encoding.
+ * @param schemaClass - schema class for the resource.
+ * @param root - root node of the resource to be encoded. Root node has to
+ * be a bejSet.
+ * @param output - An initialized BejEncoderOutputHandler struct.
+ * @param stack - An initialized BejPointerStackCallback struct. Can be NULL
+ * if options provide stack storage.
+ * @param options - encoder options. Can be NULL to use the defaults.
+ * @return 0 if successful.
+ */
+int bejEncodeWithOptions(const struct BejDictionaries* dictionaries,
+                         uint16_t majorSchemaStartingOffset,
+                         enum BejSchemaClass schemaClass,
+                         struct RedfishPropertyParent* root,
+                         struct BejEncoderOutputHandler* output,
+                         struct BejPointerStackCallback* stack,
+                         const struct BejEncoderOptions* options);
+
+/**
+ * @brief Perform BEJ encoding using prepared dictionaries.
+ *
+ * Same as bejEncode() but the dictionaries come from indexes built using
+ * bejDictPrepare(). The properties found are not validated again.
+ *
+ * @param preparedDictionaries - prepared schema and annotation dictionaries.
+ * Both indexes are required.
+ * @param majorSchemaStartingOffset - starting dictionary offset for
+ * encoding.
+ * @param schemaClass - schema class for the resource.
+ * @param root - root node of the resource to be encoded. Root node has to
+ * be a bejSet.
+ * @param output - An initialized BejEncoderOutputHandler struct.
+ * @param stack - An initialized BejPointerStackCallback struct. Can be NULL
+ * if options provide stack storage.
+ * @param options - encoder options. Can be NULL. The dictionary indexes of
+ * the options are not used.
+ * @return 0 if successful.
+ */
+int bejEncodePrepared(const struct BejDictionaryIndexes* preparedDictionaries,
+                      uint16_t majorSchemaStartingOffset,
+                      enum BejSchemaClass schemaClass,
+                      struct RedfishPropertyParent* root,
+                      struct BejEncoderOutputHandler* output,
+                      struct BejPointerStackCallback* stack,
+                      const struct BejEncoderOptions* options);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include "bej_common.h"
 #include "bej_encoder_core.h"
 
+#include <span>
 #include <vector>
 
 namespace libbej
@@ -75,6 +76,19 @@ class BejEncoderJson
                enum BejSchemaClass schemaClass,
                struct RedfishPropertyParent* root);
 
+    /**
+     * @brief Encode the resource data using prepared dictionaries.
+     *
+     * @param[in] preparedDictionaries - dictionaries prepared using
+     * bejDictPrepare().
+     * @param[in] schemaClass - BEJ schema class.
+     * @param[in] root - pointer to a RedfishPropertyParent struct.
+     * @return 0 if successful.
+     */
+    int encodePrepared(const BejDictionaryIndexes& preparedDictionaries,
+                       enum BejSchemaClass schemaClass,
+                       struct RedfishPropertyParent* root);
+
     /**
      * @brief Get the JSON encoded payload.
      *
@@ -84,9 +98,54 @@ class BejEncoderJson
      */
     std::vector<uint8_t> getOutput();
 
+    /**
+     * @brief Provide prebuilt indexes for the dictionaries passed to
+     * encode().
+     *
+     * The indexes are not copied, so they should outlive the subsequent
+     * encode() calls.
+     *
+     * @param[in] indexes - dictionary indexes. Can be nullptr to go back to
+     * linear searches.
+     */
+    void setDictionaryIndexes(const BejDictionaryIndexes* indexes)
+    {
+        dictionaryIndexes = indexes;
+    }
+
+    /**
+     * @brief Keep the encoder stack in caller provided memory.
+     *
+     * By default the stack is a std::vector that grows as needed and is
+     * reached through the stack callbacks. With fixed storage, the encoder
+     * uses the array directly. Resources nested deeper than the storage fail
+     * the encoding with bejErrorInvalidSize.
+     *
+     * The storage is not copied, so it should outlive the subsequent encode
+     * calls.
+     *
+     * @param[in] storage - stack entries. Use an empty span to go back to the
+     * std::vector.
+     */
+    void setStackStorage(std::span<void*> storage)
+    {
+        fixedStack = storage;
+    }
+
   private:
+    /**
+     * @brief Reset the stack for a new encode.
+     *
+     * @param[out] storage - filled in if fixed storage is used.
+     * @return storage if fixed storage is used, otherwise nullptr to use the
+     * stack callbacks.
+     */
+    BejPointerStackStorage* resetStack(BejPointerStackStorage& storage);
+
     std::vector<uint8_t> encodedPayload;
     std::vector<void*> stack;
+    std::span<void*> fixedStack;
+    const BejDictionaryIndexes* dictionaryIndexes = nullptr;
 };
 
 } // namespace libbej
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bej_common.h"
+#include "bej_dictionary_index.h"
 #include "bej_tree.h"
 
 #ifdef __cplusplus
@@ -29,6 +30,30 @@ int bejUpdateNodeMetadata(const struct BejDictionaries* dictionaries,
                           struct RedfishPropertyParent* root,
                           struct BejPointerStackCallback* stack);
 
+/**
+ * @brief Update the node metadata using prebuilt dictionary indexes.
+ *
+ * Same as bejUpdateNodeMetadata but property names are looked up using the
+ * indexes when available instead of a linear search.
+ *
+ * @param dictionaries - dictionaries used for encoding.
+ * @param dictionaryIndexes - indexes of the dictionaries. Can be NULL.
+ * @param majorSchemaStartingOffset - starting dictionary offset for
+ * encoding.
+ * @param root - root node of the resource to be encoded.
+ * @param stack - An initialized BejPointerStackCallback struct. Can be NULL
+ * if stackStorage is provided.
+ * @param stackStorage - memory for the stack. Can be NULL to use the stack
+ * callbacks.
+ * @return 0 if successful.
+ */
+int bejUpdateNodeMetadataWithIndexes(
+    const struct BejDictionaries* dictionaries,
+    const struct BejDictionaryIndexes* dictionaryIndexes,
+    uint16_t majorSchemaStartingOffset, struct RedfishPropertyParent* root,
+    struct BejPointerStackCallback* stack,
+    struct BejPointerStackStorage* stackStorage);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace libbej
+{
+
+/**
+ * @brief Ready to copy JSON keys for the property names of a dictionary.
+ *
+ * For every property name, the cache holds the escaped "Name": fragment. The
+ * decoders report names as pointers into the dictionary, so a fragment is
+ * found using the position of the name within the dictionary without
+ * hashing or comparing strings.
+ *
+ * The cache refers to the dictionary bytes, so the dictionary should outlive
+ * it. The cache never changes after it is built and can be shared between
+ * threads.
+ */
+class JsonKeyCache
+{
+  public:
+    JsonKeyCache() = default;
+
+    /**
+     * @brief Build the cache of a dictionary.
+     *
+     * Properties with names outside the dictionary are left out.
+     *
+     * @param[in] dictionary - a valid dictionary.
+     */
+    explicit JsonKeyCache(std::span<const uint8_t> dictionary);
+
+    /**
+     * @brief Get the JSON key of a property name.
+     *
+     * @param[in] propertyName - a property name pointing into the
+     * dictionary, as passed to the decoder callbacks.
+     * @return the "Name": fragment or an empty view if the name does not
+     * belong to this dictionary.
+     */
+    std::string_view find(const char* propertyName) const
+    {
+        // Wraps around for names before the start of the names.
+        const uintptr_t position = reinterpret_cast<uintptr_t>(propertyName) -
+                                   reinterpret_cast<uintptr_t>(namesBegin);
+        if (position >= slots.size() || slots[position] == 0)
+        {
+            return {};
+        }
+        const uint16_t key = slots[position] - 1;
+        return std::string_view(fragments)
+            .substr(keyOffsets[key], keyOffsets[key + 1] - keyOffsets[key]);
+    }
+
+  private:
+    // Start of the first property name within the dictionary.
+    const uint8_t* namesBegin = nullptr;
+    // One slot per byte starting at namesBegin. A name starting at that byte
+    // has key number slot - 1. 0 if no name starts there.
+    std::vector<uint16_t> slots;
+    // Key number i is fragments[keyOffsets[i], keyOffsets[i + 1]). Offsets
+    // are used rather than views so the cache can be moved.
+    std::vector<uint32_t> keyOffsets;
+    std::string fragments;
+};
+
+} // namespace libbej
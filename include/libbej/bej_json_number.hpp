@@ -0,0 +1,111 @@
+#pragma once
+
+#include "bej_common.h"
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <limits>
+#include <string>
+
+namespace libbej
+{
+
+/**
+ * @brief Append the decimal text of an integer to a JSON output.
+ *
+ * The digits are written using std::to_chars into a buffer on the stack, so
+ * no temporary string is created.
+ *
+ * @param[inout] output - JSON output.
+ * @param[in] value - integer to add.
+ */
+template <std::integral T>
+inline void appendJsonInteger(std::string& output, T value)
+{
+    // digits10 is one less than the longest value. One more for the sign.
+    char buffer[std::numeric_limits<T>::digits10 + 2];
+    const std::to_chars_result result =
+        std::to_chars(buffer, buffer + sizeof(buffer), value);
+    output.append(buffer, result.ptr);
+}
+
+/**
+ * @brief Append a BejReal to a JSON output.
+ *
+ * The text has the form whole.[zeroCount zeros]fract[e exp], which is how
+ * the real is encoded.
+ *
+ * @param[inout] output - JSON output.
+ * @param[in] value - real value to add. The caller should bound zeroCount.
+ */
+inline void appendJsonReal(std::string& output, const BejReal& value)
+{
+    appendJsonInteger(output, value.whole);
+    output.push_back('.');
+    output.append(value.zeroCount, '0');
+    appendJsonInteger(output, value.fract);
+    if (value.expLen != 0)
+    {
+        output.push_back('e');
+        appendJsonInteger(output, value.exp);
+    }
+}
+
+/**
+ * @brief Largest zeroCount of a BejReal accepted by the decoders.
+ */
+constexpr uint64_t maxJsonRealZeroCount = 100;
+
+/**
+ * @brief Buffer size needed by formatJsonReal().
+ */
+constexpr size_t maxJsonRealLength =
+    std::numeric_limits<int64_t>::digits10 + 2 + 1 + maxJsonRealZeroCount +
+    std::numeric_limits<uint64_t>::digits10 + 1 + 1 +
+    std::numeric_limits<int64_t>::digits10 + 2;
+
+/**
+ * @brief Write the same text as appendJsonReal() to a buffer.
+ *
+ * @param[out] buffer - at least maxJsonRealLength bytes. The text is not
+ * NULL terminated.
+ * @param[in] value - real value to write.
+ * @return end of the text or nullptr if zeroCount is larger than
+ * maxJsonRealZeroCount.
+ */
+inline char* formatJsonReal(char* buffer, const BejReal& value)
+{
+    if (value.zeroCount > maxJsonRealZeroCount)
+    {
+        return nullptr;
+    }
+    // Each part fits in its share of maxJsonRealLength, so the writes below
+    // never reach the end of the buffer.
+    char* end = buffer + maxJsonRealLength;
+    std::to_chars_result result = std::to_chars(buffer, end, value.whole);
+    if (result.ec != std::errc() || result.ptr == end)
+    {
+        return nullptr;
+    }
+    *result.ptr = '.';
+    char* next = std::fill_n(result.ptr + 1, value.zeroCount, '0');
+    result = std::to_chars(next, end, value.fract);
+    if (result.ec != std::errc())
+    {
+        return nullptr;
+    }
+    if (value.expLen == 0)
+    {
+        return result.ptr;
+    }
+    if (result.ptr == end)
+    {
+        return nullptr;
+    }
+    *result.ptr = 'e';
+    result = std::to_chars(result.ptr + 1, end, value.exp);
+    return (result.ec == std::errc()) ? result.ptr : nullptr;
+}
+
+} // namespace libbej
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+
+namespace libbej
+{
+
+/**
+ * @brief Append a string to a JSON output as a quoted and escaped JSON
+ * string.
+ *
+ * The value is validated as UTF-8 and escaped in a single pass. Quotes,
+ * backslashes and control characters are escaped. Runs of bytes that need
+ * no escaping are found 16 bytes at a time using SSE2 or NEON when
+ * available and copied in bulk.
+ *
+ * @param[inout] output - JSON output. Partially appended on failure.
+ * @param[in] value - string without the NULL terminator.
+ * @return 0 if successful. bejErrorInvalidSize if the value contains a NULL
+ * character. bejErrorInvalidString if it is not valid UTF-8.
+ */
+int appendJsonString(std::string& output, std::string_view value);
+
+/**
+ * @brief Writes a JSON string received in several parts.
+ *
+ * The parts are escaped and validated like appendJsonString(). A UTF-8
+ * sequence split between two parts is kept until the next part.
+ */
+class JsonStringWriter
+{
+  public:
+    /**
+     * @brief Start a new string.
+     *
+     * @param[inout] output - JSON output.
+     */
+    void begin(std::string& output);
+
+    /**
+     * @brief Add the next part of the string.
+     *
+     * @param[inout] output - JSON output.
+     * @param[in] part - next bytes of the string.
+     * @return 0 if successful. See appendJsonString().
+     */
+    int append(std::string& output, std::string_view part);
+
+    /**
+     * @brief Finish the string.
+     *
+     * @param[inout] output - JSON output.
+     * @return 0 if successful. bejErrorInvalidString if the string ends
+     * within a UTF-8 sequence.
+     */
+    int end(std::string& output);
+
+  private:
+    // Start of a UTF-8 sequence cut at the end of the last part.
+    std::array<char, 4> pending{};
+    size_t pendingSize = 0;
+};
+
+} // namespace libbej
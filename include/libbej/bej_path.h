@@ -0,0 +1,92 @@
+#pragma once
+
+#include "bej_common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Maximum number of segments in a property path.
+ */
+#ifndef BEJ_MAX_PATH_DEPTH
+#define BEJ_MAX_PATH_DEPTH 16
+#endif
+
+/**
+ * @brief Maximum number of paths in a projection.
+ */
+#define BEJ_MAX_PROJECTION_PATHS 32
+
+/**
+ * @brief One segment of a property path resolved using the dictionaries.
+ */
+struct BejPathStep
+{
+    // Offset of the dictionary child range holding the property.
+    uint16_t dictPropOffset;
+    // Sequence number of the tuple in the encoded stream. For array elements
+    // this is the array index.
+    uint16_t sequenceNumber;
+    // bejPrimary or bejAnnotation.
+    uint8_t schema;
+    // True if the segment is an array index.
+    bool arrayElement;
+    // True if the segment is "*" and selects every element of the array.
+    bool anyElement;
+};
+
+/**
+ * @brief A property path resolved to sequence numbers.
+ */
+struct BejPath
+{
+    struct BejPathStep steps[BEJ_MAX_PATH_DEPTH];
+    // Number of steps in use. 0 selects the whole resource.
+    uint32_t depth;
+};
+
+/**
+ * @brief Resolve a Redfish property path to sequence numbers.
+ *
+ * Path segments are separated by '/'. A leading '/' is optional. Elements of
+ * an array are selected using their index. Segments starting with '@' are
+ * looked up in the annotation dictionary. For example "Status/Health",
+ * "Identifiers/0/DurableName" or "@odata.id". A "*" segment selects every
+ * element of an array. Such paths can only be used in a projection.
+ *
+ * The resolved path can be reused for any stream encoded using the same
+ * dictionaries.
+ *
+ * @param[in] dictionaries - dictionaries used for decoding.
+ * @param[in] path - a NULL terminated property path.
+ * @param[out] resolvedPath - resolved path.
+ * @return 0 if successful. bejErrorUnknownProperty if a segment is not in the
+ * dictionaries.
+ */
+int bejPathResolve(const struct BejDictionaries* dictionaries,
+                   const char* path, struct BejPath* resolvedPath);
+
+/**
+ * @brief A set of properties to keep while decoding, similar to a Redfish
+ * $select query.
+ *
+ * A property is decoded if it is selected by one of the paths, is a child of
+ * a selected property or is on the way to a selected property. Everything else
+ * is skipped using the value length without calling any callbacks.
+ */
+struct BejProjection
+{
+    // Paths resolved using bejPathResolve().
+    const struct BejPath* paths;
+    // Number of paths. At most BEJ_MAX_PROJECTION_PATHS.
+    uint32_t count;
+};
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "bej_common.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief One SFLV tuple of an encoded stream.
+ *
+ * Entries are stored in the order the tuples appear in the stream, so the
+ * children of a bejSet, bejArray or bejPropertyAnnotation follow their parent.
+ * All offsets are with respect to the start of the encoded PLDM block.
+ */
+struct BejTapeEntry
+{
+    // Offset to the start of the tuple.
+    uint32_t tupleOffset;
+    // Offset to the start of the value.
+    uint32_t valueOffset;
+    // Value portion size in bytes.
+    uint32_t valueLength;
+    // Index of the entry after this tuple and all of its children. This is
+    // the next sibling unless this is the last child of its parent.
+    uint32_t next;
+    // Sequence number of the tuple.
+    uint16_t sequenceNumber;
+    // Dictionary the sequence number belongs to.
+    uint8_t schema;
+    struct BejTupleF format;
+};
+
+/**
+ * @brief Caller provided memory for a tape.
+ */
+struct BejTape
+{
+    // Array with at least capacity entries.
+    struct BejTapeEntry* entries;
+    // Maximum number of entries.
+    uint32_t capacity;
+    // Number of entries in use. Set by bejTapeBuild().
+    uint32_t size;
+};
+
+/**
+ * @brief Get the number of tape entries needed for any encoded PLDM block of
+ * the given length.
+ *
+ * @param[in] blockLength - length of the encoded PLDM block.
+ * @return the maximum number of tuples the block can hold.
+ */
+uint32_t bejTapeGetMaxEntryCount(uint32_t blockLength);
+
+/**
+ * @brief Scan an encoded PLDM block and record the position of every tuple.
+ *
+ * This is a single pass over the stream that does not use dictionaries. The
+ * tape can later be used to jump to any tuple or skip over a whole subtree
+ * without parsing it again. Bytes after the root tuple are ignored.
+ *
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] blockLength - length of the encoded PLDM block.
+ * @param[inout] tape - tape with caller provided entries. Entry 0 is the root
+ * tuple.
+ * @return 0 if successful. bejErrorInvalidSize if the stream is malformed or
+ * the tape is too small.
+ */
+int bejTapeBuild(const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                 struct BejTape* tape);
+
+#ifdef __cplusplus
+}
+#endif
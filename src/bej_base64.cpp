@@ -0,0 +1,57 @@
+#include "bej_base64.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace libbej
+{
+
+static constexpr char base64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Two base64 characters for every 12 bit value.
+static constexpr std::array<std::array<char, 2>, 4096> base64Pairs = [] {
+    std::array<std::array<char, 2>, 4096> pairs{};
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        pairs[i] = {base64Alphabet[i >> 6], base64Alphabet[i & 0x3F]};
+    }
+    return pairs;
+}();
+
+void appendBase64(std::string& output, std::span<const uint8_t> data)
+{
+    const size_t start = output.size();
+    output.resize(start + (data.size() + 2) / 3 * 4);
+    char* out = output.data() + start;
+
+    const uint8_t* in = data.data();
+    const uint8_t* const end = in + data.size() / 3 * 3;
+    for (; in != end; in += 3, out += 4)
+    {
+        const uint32_t group = (static_cast<uint32_t>(in[0]) << 16) |
+                               (static_cast<uint32_t>(in[1]) << 8) | in[2];
+        memcpy(out, base64Pairs[group >> 12].data(), 2);
+        memcpy(out + 2, base64Pairs[group & 0xFFF].data(), 2);
+    }
+
+    switch (data.size() % 3)
+    {
+        case 1:
+            out[0] = base64Alphabet[in[0] >> 2];
+            out[1] = base64Alphabet[(in[0] & 0x03) << 4];
+            out[2] = '=';
+            out[3] = '=';
+            break;
+        case 2:
+            out[0] = base64Alphabet[in[0] >> 2];
+            out[1] = base64Alphabet[((in[0] & 0x03) << 4) | (in[1] >> 4)];
+            out[2] = base64Alphabet[(in[1] & 0x0F) << 2];
+            out[3] = '=';
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace libbej
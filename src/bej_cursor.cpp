@@ -0,0 +1,27 @@
+#include "bej_cursor.hpp"
+
+namespace libbej
+{
+
+BejEventRange::BejEventRange(const BejDictionaries& dictionaries,
+                             std::span<const uint8_t> encodedPldmBlock,
+                             const BejDecoderOptions* options)
+{
+    status = bejCursorInit(&cursor, &dictionaries, encodedPldmBlock.data(),
+                           encodedPldmBlock.size_bytes(), options);
+    if (status == 0)
+    {
+        next();
+    }
+}
+
+void BejEventRange::next()
+{
+    status = bejCursorNext(&cursor, &current);
+    if (status != 0)
+    {
+        current = nullptr;
+    }
+}
+
+} // namespace libbej
@@ -1,6 +1,8 @@
 #include "bej_decoder_core.h"
 
 #include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
+#include "bej_path.h"
 #include "stdio.h"
 
 #include <inttypes.h>
@@ -18,6 +20,139 @@ const uint32_t supportedBejVersions[] = {0xF1F0F000};
 //   value               : 1   (e.g. nnint(0) marking an empty Set/Array)
 static const uint32_t bejMinRootSflvSize = 5;
 
+// Upper bound on the number of tuples decoded from a single stream.
+static const uint64_t bejMaxDecodeOperations = 1000000;
+
+/**
+ * @brief Check whether the decoder stack is empty.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return true if the stack is empty.
+ */
+static inline bool bejStackEmpty(const struct BejHandleTypeFuncParam* params)
+{
+    if (params->stackStorage != NULL)
+    {
+        return params->stackStorage->size == 0;
+    }
+    return params->stackCallback->stackEmpty(params->stackDataPtr);
+}
+
+/**
+ * @brief Get the top of the decoder stack.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return the top entry or NULL if the stack is empty.
+ */
+static inline const struct BejStackProperty*
+    bejStackPeek(const struct BejHandleTypeFuncParam* params)
+{
+    if (params->stackStorage != NULL)
+    {
+        if (params->stackStorage->size == 0)
+        {
+            return NULL;
+        }
+        return &params->stackStorage->entries[params->stackStorage->size - 1];
+    }
+    return params->stackCallback->stackPeek(params->stackDataPtr);
+}
+
+/**
+ * @brief Remove the top of the decoder stack.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ */
+static inline void bejStackPop(struct BejHandleTypeFuncParam* params)
+{
+    if (params->stackStorage != NULL)
+    {
+        if (params->stackStorage->size > 0)
+        {
+            --params->stackStorage->size;
+            --params->state.sectionDepth;
+        }
+        return;
+    }
+    params->stackCallback->stackPop(params->stackDataPtr);
+    --params->state.sectionDepth;
+}
+
+/**
+ * @brief Push an entry to the decoder stack.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] property - entry to push.
+ * @return 0 if successful.
+ */
+static inline int bejStackPush(struct BejHandleTypeFuncParam* params,
+                               const struct BejStackProperty* property)
+{
+    if (params->stackStorage != NULL)
+    {
+        if (params->stackStorage->size >= params->stackStorage->capacity)
+        {
+            fprintf(stderr, "Decoder stack is full. Capacity: %u\n",
+                    params->stackStorage->capacity);
+            return bejErrorInvalidSize;
+        }
+        params->stackStorage->entries[params->stackStorage->size++] = *property;
+        ++params->state.sectionDepth;
+        return 0;
+    }
+    RETURN_IF_IERROR(
+        params->stackCallback->stackPush(property, params->stackDataPtr));
+    ++params->state.sectionDepth;
+    return 0;
+}
+
+/**
+ * @brief Switch to the projection state of the children of a section pushed
+ * to the stack.
+ *
+ * @param[inout] params - a valid BejHandleTypeFuncParam struct with the
+ * projection state of the children set by bejProjectionSelect().
+ */
+static inline void
+    bejProjectionEnterSection(struct BejHandleTypeFuncParam* params)
+{
+    struct BejDecoderStates* state = &params->state;
+    if (params->childProjectionDepth > state->projectionDepth)
+    {
+        // The section matches one more path step.
+        state->projectionMasks[params->childProjectionDepth] =
+            params->childProjectionMask;
+    }
+    state->projectionMask = params->childProjectionMask;
+    state->projectionDepth = params->childProjectionDepth;
+}
+
+/**
+ * @brief Restore the projection state of the parent section once a section
+ * is popped from the stack.
+ *
+ * @param[inout] params - a valid BejHandleTypeFuncParam struct.
+ */
+static inline void
+    bejProjectionLeaveSection(struct BejHandleTypeFuncParam* params)
+{
+    struct BejDecoderStates* state = &params->state;
+    // The open sections are the root set, one section for each path step
+    // matched and then the sections of a selected property. Only the sections
+    // matching a path step and the selected property itself change the state.
+    const uint32_t open = state->sectionDepth;
+    if (open == 0 || open > state->projectionDepth + 1)
+    {
+        return;
+    }
+    if (open <= state->projectionDepth)
+    {
+        // A section matching a path step ended.
+        state->projectionDepth = open - 1;
+    }
+    state->projectionMask = state->projectionMasks[state->projectionDepth];
+}
+
 /**
  * @brief Call a callback function. If the callback function is NULL, this will
  * not do anything. If the callback function returns a non-zero value, this will
@@ -194,6 +329,38 @@ static uint32_t bejGetFirstTupleOffset(
     return valueStartOffset + bejGetNnintSize(params->sflv.value);
 }
 
+/**
+ * @brief Get a property from a dictionary used by the decoder.
+ *
+ * @param[in] params - a BejHandleTypeFuncParam struct pointing to valid
+ * dictionaries.
+ * @param[in] dictionary - dictionary containing the sequence number.
+ * @param[in] dictIndex - index of the dictionary. Can be NULL.
+ * @param[in] startingPropertyOffset - offset of the starting property for
+ * the search.
+ * @param[in] sequenceNumber - sequence number of the property.
+ * @param[out] prop - if the search is successful, this will point to a valid
+ * property.
+ * @return 0 if successful.
+ */
+static int bejDecoderGetProperty(const struct BejHandleTypeFuncParam* params,
+                                 const uint8_t* dictionary,
+                                 const struct BejDictionaryIndex* dictIndex,
+                                 uint16_t startingPropertyOffset,
+                                 uint16_t sequenceNumber,
+                                 const struct BejDictionaryProperty** prop)
+{
+    if (params->dictionariesPrepared)
+    {
+        return bejDictIndexGetPreparedProperty(
+            dictionary, dictIndex, startingPropertyOffset, sequenceNumber,
+            prop);
+    }
+    return bejDictIndexGetProperty(dictionary, dictIndex,
+                                   startingPropertyOffset, sequenceNumber,
+                                   prop);
+}
+
 /**
  * @brief Get the correct property and the dictionary it belongs to.
  *
@@ -215,15 +382,18 @@ static int bejGetDictionaryAndProperty(
     const struct BejDictionaryProperty** prop)
 {
     uint16_t dictPropOffset;
+    const struct BejDictionaryIndex* dictIndex;
     // We need to pick the correct dictionary.
     if (schemaType == bejPrimary)
     {
         *dictionary = params->mainDictionary;
+        dictIndex = params->mainDictIndex;
         dictPropOffset = params->state.mainDictPropOffset;
     }
     else if (schemaType == bejAnnotation)
     {
         *dictionary = params->annotDictionary;
+        dictIndex = params->annotDictIndex;
         if (params->sflv.format.readOnlyPropertyAndTopLevelAnnotation)
         {
             dictPropOffset = bejDictGetFirstAnnotatedPropertyOffset();
@@ -240,8 +410,8 @@ static int bejGetDictionaryAndProperty(
         return bejErrorInvalidSchemaType;
     }
 
-    int ret =
-        bejDictGetProperty(*dictionary, dictPropOffset, sequenceNumber, prop);
+    int ret = bejDecoderGetProperty(params, *dictionary, dictIndex,
+                                    dictPropOffset, sequenceNumber, prop);
     if (ret != 0)
     {
         fprintf(stderr, "Failed to get dictionary property for offset: %u\n",
@@ -252,861 +422,2756 @@ static int bejGetDictionaryAndProperty(
 }
 
 /**
- * @brief Find and return the property name of the current encoded segment. If
- * the params->state.addPropertyName is false, this will return an empty string.
+ * @brief Check that a decoded string has a single NULL terminator at its end.
  *
- * @param[in] params - a valid populated BejHandleTypeFuncParam.
- * @return 0 if successful.
+ * @param[in] value - decoded string.
+ * @param[in] length - encoded length of the string. Includes the NULL
+ * terminator.
+ * @return 0 if the string is valid.
  */
-static const char* bejGetPropName(struct BejHandleTypeFuncParam* params)
+static int bejCheckStringValue(const char* value, size_t length)
 {
-    const uint8_t* dictionary;
-    const struct BejDictionaryProperty* prop;
-    if (!params->state.addPropertyName ||
-        (bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
-                                     params->sflv.tupleS.sequenceNumber,
-                                     &dictionary, &prop) != 0))
+    if (memchr(value, '\0', length) != value + length - 1)
     {
-        return "";
+        fprintf(stderr, "Invalid BEJ string length: %zu\n", length);
+        return bejErrorInvalidSize;
     }
-    return bejDictGetPropertyName(dictionary, prop->nameOffset,
-                                  prop->nameLength);
+    return 0;
 }
 
 /**
- * @brief Look for section endings.
- *
- * This figures out whether the current encoded segment marks a section
- * ending. If so, this function will update the decoder state and pop the stack
- * used to memorize endings. This function should be called after updating the
- * encodedStreamOffset to the end of decoded SFLV tuple.
+ * @brief Add an event to the queue of a cursor.
  *
- * @param[in] params - a valid BejHandleTypeFuncParam which contains the decoder
- * state.
- * @param[in] canBeEmpty - if true, the stack being empty is not an error. If
- * false, stack cannot be empty.
+ * @param[inout] cursor - a valid cursor.
+ * @param[in] type - type of the event.
+ * @param[in] propertyName - name of the property. NULL for set and array ends.
+ * @param[in] value - value of the event. NULL for set and array ends.
  * @return 0 if successful.
  */
-static int bejProcessEnding(struct BejHandleTypeFuncParam* params,
-                            bool canBeEmpty)
+static int bejCursorAddEvent(struct BejCursor* cursor,
+                             enum BejCursorEventType type,
+                             const char* propertyName,
+                             const union BejValue* value)
 {
-    if (params->stackCallback->stackEmpty(params->stackDataPtr) && !canBeEmpty)
+    if (cursor->eventCount >= BEJ_CURSOR_MAX_EVENTS)
     {
-        // If bejProcessEnding has been called after adding an appropriate JSON
-        // property, then stack cannot be empty.
-        fprintf(stderr, "Ending stack cannot be empty.\n");
+        fprintf(stderr, "Cursor event queue is full\n");
         return bejErrorUnknown;
     }
-
-    while (!params->stackCallback->stackEmpty(params->stackDataPtr))
+    struct BejCursorEvent* event =
+        &cursor->events[(cursor->eventHead + cursor->eventCount) %
+                        BEJ_CURSOR_MAX_EVENTS];
+    ++cursor->eventCount;
+    event->type = type;
+    event->propertyName = propertyName;
+    event->annotatedPropertyName = NULL;
+    event->id = (struct BejPropertyId){
+        .sequenceNumber = 0,
+        .dictPropOffset = 0,
+        .schema = 0,
+        .nameLength = 0,
+    };
+    if (value != NULL)
     {
-        const struct BejStackProperty* const ending =
-            params->stackCallback->stackPeek(params->stackDataPtr);
-        // Check whether the current offset location matches the expected ending
-        // offset. If so, we are done with that section.
-        if (params->state.encodedStreamOffset == ending->streamEndOffset)
-        {
-            // Since we are going out of a section, we need to reset the
-            // dictionary property offsets to this section's parent property
-            // start.
-            params->state.mainDictPropOffset = ending->mainDictPropOffset;
-            params->state.annoDictPropOffset = ending->annoDictPropOffset;
-            params->state.addPropertyName = ending->addPropertyName;
-
-            if (ending->sectionType == bejSectionSet)
-            {
-                RETURN_IF_CALLBACK_IERROR(
-                    params->decodedCallback->callbackSetEnd,
-                    params->callbacksDataPtr);
-            }
-            else if (ending->sectionType == bejSectionArray)
-            {
-                RETURN_IF_CALLBACK_IERROR(
-                    params->decodedCallback->callbackArrayEnd,
-                    params->callbacksDataPtr);
-            }
-            params->stackCallback->stackPop(params->stackDataPtr);
-        }
-        else
-        {
-            RETURN_IF_CALLBACK_IERROR(
-                params->decodedCallback->callbackPropertyEnd,
-                params->callbacksDataPtr);
-            // Do not change the parent dictionary property offset since we are
-            // still inside the same section.
-            return 0;
-        }
+        event->value = *value;
+    }
+    if (propertyName != NULL)
+    {
+        struct BejHandleTypeFuncParam* params = &cursor->params;
+        // Set by the decoder right before the event.
+        event->id = params->propertyId;
+        // An annotation applies to the value that follows it.
+        event->annotatedPropertyName = params->annotatedPropertyName;
+        params->annotatedPropertyName = NULL;
     }
     return 0;
 }
 
 /**
- * @brief Check whether the current encoded segment being decoded is an array
- * element.
- *
- * @param[in] params - a valid BejHandleTypeFuncParam struct.
- * @return true if the encoded segment is an array element. Else false.
+ * @brief State of bejDecodePldmBlockBatched().
  */
-static bool bejIsArrayElement(const struct BejHandleTypeFuncParam* params)
+struct BejBatchDecoder
 {
-    // If the encoded segment enters an array section, we are adding a
-    // BejSectionArray to the stack. Therefore if the stack is empty, encoded
-    // segment cannot be an array element.
-    if (params->stackCallback->stackEmpty(params->stackDataPtr))
-    {
-        return false;
-    }
-    const struct BejStackProperty* const ending =
-        params->stackCallback->stackPeek(params->stackDataPtr);
-    // If the stack top element holds a BejSectionArray, encoded segment is
-    // an array element.
-    return ending->sectionType == bejSectionArray;
-}
+    struct BejHandleTypeFuncParam params;
+    struct BejStackProperty stack[BEJ_MAX_STACK_DEPTH];
+    struct BejStackStorage stackStorage;
+    // Events of the current batch.
+    struct BejBatchEvent* events;
+    uint32_t capacity;
+    uint32_t count;
+    // Reals of the current batch.
+    struct BejReal reals[BEJ_BATCH_MAX_REALS];
+    uint32_t realCount;
+    // Number of open sets and arrays.
+    uint16_t depth;
+    int (*callbackBatch)(const struct BejBatchEvent* events, uint32_t count,
+                         const struct BejReal* reals, void* dataPtr);
+    void* dataPtr;
+};
 
 /**
- * @brief Decodes a BejSet type SFLV BEJ tuple.
+ * @brief Add an event to the current batch. A full batch is passed to
+ * callbackBatch first.
  *
- * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[inout] batch - a valid batch decoder.
+ * @param[in] type - type of the event.
+ * @param[in] propertyName - name of the property. NULL for set and array ends.
+ * @param[in] value - value of the event. NULL for set and array ends.
  * @return 0 if successful.
  */
-static int bejHandleBejSet(struct BejHandleTypeFuncParam* params)
+static int bejBatchAddEvent(struct BejBatchDecoder* batch,
+                            enum BejCursorEventType type,
+                            const char* propertyName,
+                            const union BejValue* value)
 {
-    uint16_t sequenceNumber = params->sflv.tupleS.sequenceNumber;
-    // Check whether this BejSet is an array element or not.
-    if (bejIsArrayElement(params))
-    {
-        // Dictionary only contains an entry for element 0.
-        sequenceNumber = 0;
-    }
-    const uint8_t* dictionary;
-    const struct BejDictionaryProperty* prop;
-    RETURN_IF_IERROR(
-        bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
-                                    sequenceNumber, &dictionary, &prop));
-
-    const char* propName = "";
-    if (params->state.addPropertyName)
+    if (batch->count == batch->capacity ||
+        (type == bejCursorReal && batch->realCount == BEJ_BATCH_MAX_REALS))
     {
-        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
-                                          prop->nameLength);
+        RETURN_IF_IERROR(batch->callbackBatch(batch->events, batch->count,
+                                              batch->reals, batch->dataPtr));
+        batch->count = 0;
+        batch->realCount = 0;
     }
-
-    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackSetStart,
-                              propName, params->callbacksDataPtr);
-
-    // Move the offset to the next SFLV tuple (or end). Make sure that this is
-    // called before calling bejProcessEnding.
-    params->state.encodedStreamOffset = bejGetFirstTupleOffset(params);
-
-    uint64_t elements = bejGetNnint(params->sflv.value);
-    // If its an empty set, we are done here.
-    if (elements == 0)
+    if (type == bejCursorSetEnd || type == bejCursorArrayEnd)
     {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackSetEnd,
-                                  params->callbacksDataPtr);
-        // Since this is an ending of a property (empty array), we should call
-        // bejProcessEnding. Unless the whole JSON object is an empty set (which
-        // shouldn't be the case), stack cannot be empty.
-        bejProcessEnding(params, /*canBeEmpty=*/false);
-        return 0;
+        --batch->depth;
     }
-
-    // Update the states for the next encoding segment.
-    struct BejStackProperty newEnding = {
-        .sectionType = bejSectionSet,
-        .addPropertyName = params->state.addPropertyName,
-        .mainDictPropOffset = params->state.mainDictPropOffset,
-        .annoDictPropOffset = params->state.annoDictPropOffset,
-        .streamEndOffset = params->sflv.valueEndOffset,
+    struct BejBatchEvent* event = &batch->events[batch->count++];
+    event->propertyName = propertyName;
+    event->annotatedPropertyName = NULL;
+    event->id = (struct BejPropertyId){
+        .sequenceNumber = 0,
+        .dictPropOffset = 0,
+        .schema = 0,
+        .nameLength = 0,
     };
-    RETURN_IF_IERROR(
-        params->stackCallback->stackPush(&newEnding, params->stackDataPtr));
-    params->state.addPropertyName = true;
-    if (params->sflv.tupleS.schema == bejAnnotation)
+    event->valueLength = 0;
+    event->depth = batch->depth;
+    event->propertyNameLength = 0;
+    event->type = (uint8_t)type;
+    if (propertyName != NULL)
     {
-        // Since this set is an annotated type, we need to advance the
-        // annotation dictionary for decoding the next segment.
-        params->state.annoDictPropOffset = prop->childPointerOffset;
+        struct BejHandleTypeFuncParam* params = &batch->params;
+        // Set by the decoder right before the event.
+        event->id = params->propertyId;
+        // Array elements and the root set are passed without a name.
+        if (propertyName[0] != '\0')
+        {
+            event->propertyNameLength = params->propertyId.nameLength;
+        }
+        // An annotation applies to the value that follows it.
+        event->annotatedPropertyName = params->annotatedPropertyName;
+        params->annotatedPropertyName = NULL;
     }
-    else
+    switch (type)
     {
-        params->state.mainDictPropOffset = prop->childPointerOffset;
+        case bejCursorSetStart:
+        case bejCursorArrayStart:
+            event->value.elementCount = value->elementCount;
+            // The stack storage limits the nesting to BEJ_MAX_STACK_DEPTH.
+            ++batch->depth;
+            break;
+        case bejCursorInteger:
+            event->value.integer = value->integer;
+            break;
+        case bejCursorEnum:
+            event->value.enumValue = value->enumValue;
+            break;
+        case bejCursorString:
+            event->value.string = value->string.value;
+            // Limited by the 32 bit length of the encoded value.
+            event->valueLength = (uint32_t)value->string.length;
+            break;
+        case bejCursorReal:
+            event->value.realIndex = batch->realCount;
+            batch->reals[batch->realCount++] = value->real;
+            break;
+        case bejCursorBool:
+            event->value.boolean = value->boolean;
+            break;
+        case bejCursorResourceLink:
+            event->value.linkId = value->linkId;
+            break;
+        case bejCursorSetEnd:
+        case bejCursorArrayEnd:
+        case bejCursorNull:
+            break;
     }
     return 0;
 }
 
 /**
- * @brief Decodes a BejArray type SFLV BEJ tuple.
+ * @brief Pass a decoded property to the event sink of the decoder.
  *
- * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] params - a valid BejHandleTypeFuncParam struct with an event
+ * sink other than bejEventSinkCallbacks.
+ * @param[in] type - type of the event.
+ * @param[in] propertyName - name of the property. NULL for set and array ends.
+ * @param[in] value - value of the event. NULL for set and array ends.
  * @return 0 if successful.
  */
-static int bejHandleBejArray(struct BejHandleTypeFuncParam* params)
+static int bejSinkAddEvent(struct BejHandleTypeFuncParam* params,
+                           enum BejCursorEventType type,
+                           const char* propertyName,
+                           const union BejValue* value)
 {
-    const uint8_t* dictionary;
-    const struct BejDictionaryProperty* prop;
-    RETURN_IF_IERROR(bejGetDictionaryAndProperty(
-        params, params->sflv.tupleS.schema, params->sflv.tupleS.sequenceNumber,
-        &dictionary, &prop));
-
-    const char* propName = "";
-    if (params->state.addPropertyName)
-    {
-        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
-                                          prop->nameLength);
-    }
-
-    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackArrayStart,
-                              propName, params->callbacksDataPtr);
-
-    // Move the offset to the next SFLV tuple (or end). Make sure that this is
-    // called before calling bejProcessEnding.
-    params->state.encodedStreamOffset = bejGetFirstTupleOffset(params);
-
-    uint64_t elements = bejGetNnint(params->sflv.value);
-    // If its an empty array, we are done here.
-    if (elements == 0)
+    switch (params->eventSink)
     {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackArrayEnd,
-                                  params->callbacksDataPtr);
-        // Since this is an ending of a property (empty array), we should call
-        // bejProcessEnding. Stack cannot be empty since there should be at
-        // least 1 parent in the stack.
-        bejProcessEnding(params, /*canBeEmpty=*/false);
-        return 0;
+        case bejEventSinkCursor:
+            return bejCursorAddEvent(
+                (struct BejCursor*)params->callbacksDataPtr, type,
+                propertyName, value);
+        case bejEventSinkBatch:
+            return bejBatchAddEvent(
+                (struct BejBatchDecoder*)params->callbacksDataPtr, type,
+                propertyName, value);
+        case bejEventSinkCallbacks:
+        default:
+            break;
     }
+    fprintf(stderr, "Invalid event sink: %d\n", (int)params->eventSink);
+    return bejErrorUnknown;
+}
 
-    // Update the state for next segment decoding.
-    struct BejStackProperty newEnding = {
-        .sectionType = bejSectionArray,
-        .addPropertyName = params->state.addPropertyName,
-        .mainDictPropOffset = params->state.mainDictPropOffset,
-        .annoDictPropOffset = params->state.annoDictPropOffset,
-        .streamEndOffset = params->sflv.valueEndOffset,
-    };
-    RETURN_IF_IERROR(
-        params->stackCallback->stackPush(&newEnding, params->stackDataPtr));
-    // We do not add property names for array elements.
-    params->state.addPropertyName = false;
-    if (params->sflv.tupleS.schema == bejAnnotation)
-    {
-        // Since this array is an annotated type, we need to advance the
-        // annotation dictionary for decoding the next segment.
-        params->state.annoDictPropOffset = prop->childPointerOffset;
-    }
-    else
+/**
+ * @brief Pass the start of a set to the consumer of the decoder.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct. The set is the
+ * current tuple.
+ * @param[in] propName - name of the property.
+ * @return 0 if successful.
+ */
+static int bejEmitSetStart(struct BejHandleTypeFuncParam* params,
+                           const char* propName)
+{
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        params->state.mainDictPropOffset = prop->childPointerOffset;
+        union BejValue value = {.elementCount =
+                                    bejGetNnint(params->sflv.value)};
+        return bejSinkAddEvent(params, bejCursorSetStart, propName, &value);
     }
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackSetStart,
+                              propName, params->callbacksDataPtr);
     return 0;
 }
 
 /**
- * @brief Decodes a BejNull type SFLV BEJ tuple.
+ * @brief Pass the end of a set to the consumer of the decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
  * @return 0 if successful.
  */
-static int bejHandleBejNull(struct BejHandleTypeFuncParam* params)
+static int bejEmitSetEnd(struct BejHandleTypeFuncParam* params)
 {
-    const char* propName = bejGetPropName(params);
-    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull, propName,
+    if (params->eventSink != bejEventSinkCallbacks)
+    {
+        return bejSinkAddEvent(params, bejCursorSetEnd, NULL, NULL);
+    }
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackSetEnd,
                               params->callbacksDataPtr);
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejInteger type SFLV BEJ tuple.
+ * @brief Pass the start of an array to the consumer of the decoder.
  *
- * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] params - a valid BejHandleTypeFuncParam struct. The array is the
+ * current tuple.
+ * @param[in] propName - name of the property.
  * @return 0 if successful.
  */
-static int bejHandleBejInteger(struct BejHandleTypeFuncParam* params)
+static int bejEmitArrayStart(struct BejHandleTypeFuncParam* params,
+                             const char* propName)
 {
-    const char* propName = bejGetPropName(params);
-
-    if (params->sflv.valueLength == 0)
-    {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
-    }
-    else
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        RETURN_IF_CALLBACK_IERROR(
-            params->decodedCallback->callbackInteger, propName,
-            bejGetIntegerValue(params->sflv.value, params->sflv.valueLength),
-            params->callbacksDataPtr);
+        union BejValue value = {.elementCount =
+                                    bejGetNnint(params->sflv.value)};
+        return bejSinkAddEvent(params, bejCursorArrayStart, propName, &value);
     }
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackArrayStart,
+                              propName, params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejEnum type SFLV BEJ tuple.
+ * @brief Pass the end of an array to the consumer of the decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
  * @return 0 if successful.
  */
-static int bejHandleBejEnum(struct BejHandleTypeFuncParam* params)
+static int bejEmitArrayEnd(struct BejHandleTypeFuncParam* params)
 {
-    uint16_t sequenceNumber = params->sflv.tupleS.sequenceNumber;
-    if (bejIsArrayElement(params))
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        sequenceNumber = 0;
+        return bejSinkAddEvent(params, bejCursorArrayEnd, NULL, NULL);
     }
-    const uint8_t* dictionary;
-    const struct BejDictionaryProperty* prop;
-    RETURN_IF_IERROR(
-        bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
-                                    sequenceNumber, &dictionary, &prop));
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackArrayEnd,
+                              params->callbacksDataPtr);
+    return 0;
+}
 
-    const char* propName = "";
-    if (params->state.addPropertyName)
+/**
+ * @brief Pass a null value to the consumer of the decoder.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @return 0 if successful.
+ */
+static int bejEmitNull(struct BejHandleTypeFuncParam* params,
+                       const char* propName)
+{
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
-                                          prop->nameLength);
+        return bejSinkAddEvent(params, bejCursorNull, propName,
+                               &(union BejValue){.integer = 0});
     }
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull, propName,
+                              params->callbacksDataPtr);
+    return 0;
+}
 
-    if (params->sflv.valueLength == 0)
-    {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
-    }
-    else
+/**
+ * @brief Pass an integer value to the consumer of the decoder.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @param[in] value - decoded value.
+ * @return 0 if successful.
+ */
+static int bejEmitInteger(struct BejHandleTypeFuncParam* params,
+                          const char* propName, int64_t value)
+{
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        // Get the string for enum value.
-        uint16_t enumValueSequenceN =
-            (uint16_t)(bejGetNnint(params->sflv.value));
-        const struct BejDictionaryProperty* enumValueProp;
-        RETURN_IF_IERROR(
-            bejDictGetProperty(dictionary, prop->childPointerOffset,
-                               enumValueSequenceN, &enumValueProp));
-        const char* enumValueName = bejDictGetPropertyName(
-            dictionary, enumValueProp->nameOffset, enumValueProp->nameLength);
-
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackEnum,
-                                  propName, enumValueName,
-                                  params->callbacksDataPtr);
+        return bejSinkAddEvent(params, bejCursorInteger, propName,
+                               &(union BejValue){.integer = value});
     }
-    // Update the offset to point to the next possible SFLV tuple.
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackInteger,
+                              propName, value, params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejString type SFLV BEJ tuple.
+ * @brief Pass an enum value to the consumer of the decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @param[in] value - name of the enum value.
  * @return 0 if successful.
  */
-static int bejHandleBejString(struct BejHandleTypeFuncParam* params)
+static int bejEmitEnum(struct BejHandleTypeFuncParam* params,
+                       const char* propName, const char* value)
 {
-    // TODO: Handle deferred bindings.
-    const char* propName = bejGetPropName(params);
-
-    if (params->sflv.valueLength == 0)
-    {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
-    }
-    else
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        RETURN_IF_CALLBACK_IERROR(
-            params->decodedCallback->callbackString, propName,
-            (const char*)(params->sflv.value), params->sflv.valueLength,
-            params->callbacksDataPtr);
+        return bejSinkAddEvent(params, bejCursorEnum, propName,
+                               &(union BejValue){.enumValue = value});
     }
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackEnum, propName,
+                              value, params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejReal type SFLV BEJ tuple.
+ * @brief Pass the string value of the current tuple to the consumer of the
+ * decoder.
  *
- * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] params - a valid BejHandleTypeFuncParam struct with a non empty
+ * string value.
+ * @param[in] propName - name of the property.
  * @return 0 if successful.
  */
-static int bejHandleBejReal(struct BejHandleTypeFuncParam* params)
+static int bejEmitString(struct BejHandleTypeFuncParam* params,
+                         const char* propName)
 {
-    const char* propName = bejGetPropName(params);
-
-    if (params->sflv.valueLength == 0)
+    const char* value = (const char*)(params->sflv.value);
+    const uint32_t length = params->sflv.valueLength;
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
+        // The encoded length includes the NULL terminator.
+        RETURN_IF_IERROR(bejCheckStringValue(value, length));
+        union BejValue event = {
+            .string = {.value = value, .length = length - 1}};
+        return bejSinkAddEvent(params, bejCursorString, propName, &event);
     }
-    else
+    const struct BejDecodedCallbackExtensions* extensions =
+        params->callbackExtensions;
+    if (params->decodedCallback->callbackString == NULL &&
+        extensions->callbackStringBegin != NULL)
     {
-        // Real value has the following format.
-        // nnint      - Length of whole
-        // bejInteger - whole (includes sign for the overall real number)
-        // nnint      - Leading zero count for fract
-        // nnint      - fract
-        // nnint      - Length of exp
-        // bejInteger - exp (includes sign for the exponent)
-        uint8_t wholeByteLen = (uint8_t)bejGetNnint(params->sflv.value);
-        const uint8_t* wholeBejInt =
-            params->sflv.value + bejGetNnintSize(params->sflv.value);
-        const uint8_t* fractZeroCountNnint = wholeBejInt + wholeByteLen;
-        const uint8_t* fractNnint =
-            fractZeroCountNnint + bejGetNnintSize(fractZeroCountNnint);
-        const uint8_t* lenExpNnint = fractNnint + bejGetNnintSize(fractNnint);
-        const uint8_t* expBejInt = lenExpNnint + bejGetNnintSize(lenExpNnint);
-
-        struct BejReal realValue;
-        realValue.whole = bejGetIntegerValue(wholeBejInt, wholeByteLen);
-        realValue.zeroCount = bejGetNnint(fractZeroCountNnint);
-        realValue.fract = bejGetNnint(fractNnint);
-        realValue.expLen = (uint8_t)bejGetNnint(lenExpNnint);
-        if (realValue.expLen != 0)
-        {
-            realValue.exp = bejGetIntegerValue(
-                expBejInt, (uint8_t)bejGetNnint(lenExpNnint));
-        }
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackReal,
-                                  propName, &realValue,
-                                  params->callbacksDataPtr);
+        // The whole value is passed as a single fragment.
+        RETURN_IF_IERROR(extensions->callbackStringBegin(
+            propName, length, params->callbacksDataPtr));
+        RETURN_IF_IERROR(extensions->callbackStringFragment(
+            value, length, params->callbacksDataPtr));
+        return extensions->callbackStringEnd(params->callbacksDataPtr);
     }
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackString,
+                              propName, value, length,
+                              params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejBoolean type SFLV BEJ tuple.
+ * @brief Pass a real value to the consumer of the decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @param[in] value - decoded value.
  * @return 0 if successful.
  */
-static int bejHandleBejBoolean(struct BejHandleTypeFuncParam* params)
+static int bejEmitReal(struct BejHandleTypeFuncParam* params,
+                       const char* propName, const struct BejReal* value)
 {
-    const char* propName = bejGetPropName(params);
-
-    if (params->sflv.valueLength == 0)
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
+        return bejSinkAddEvent(params, bejCursorReal, propName,
+                               &(union BejValue){.real = *value});
     }
-    else
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackReal, propName,
+                              value, params->callbacksDataPtr);
+    return 0;
+}
+
+/**
+ * @brief Pass a boolean value to the consumer of the decoder.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @param[in] value - decoded value.
+ * @return 0 if successful.
+ */
+static int bejEmitBool(struct BejHandleTypeFuncParam* params,
+                       const char* propName, bool value)
+{
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackBool,
-                                  propName, *(params->sflv.value) > 0,
-                                  params->callbacksDataPtr);
+        return bejSinkAddEvent(params, bejCursorBool, propName,
+                               &(union BejValue){.boolean = value});
     }
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackBool, propName,
+                              value, params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes a BejPropertyAnnotation type SFLV BEJ tuple.
+ * @brief Pass the start of a property annotation to the consumer of the
+ * decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the annotated property.
  * @return 0 if successful.
  */
-static int bejHandleBejPropertyAnnotation(struct BejHandleTypeFuncParam* params)
+static int bejEmitAnnotation(struct BejHandleTypeFuncParam* params,
+                             const char* propName)
 {
-    // TODO: Handle colon-delimited string values.
-
-    // Property annotation has the form OuterProperty@Annotation. First
-    // processing the outer property name.
-    const uint8_t* outerDictionary;
-    const struct BejDictionaryProperty* outerProp;
-    RETURN_IF_IERROR(bejGetDictionaryAndProperty(
-        params, params->sflv.tupleS.schema, params->sflv.tupleS.sequenceNumber,
-        &outerDictionary, &outerProp));
-
-    const char* propName = bejDictGetPropertyName(
-        outerDictionary, outerProp->nameOffset, outerProp->nameLength);
+    if (params->eventSink != bejEventSinkCallbacks)
+    {
+        // Reported with the annotation value instead of a separate event.
+        params->annotatedPropertyName = propName;
+        return 0;
+    }
     RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackAnnotation,
                               propName, params->callbacksDataPtr);
-
-    // Mark the ending of the property annotation.
-    struct BejStackProperty newEnding = {
-        .sectionType = bejSectionNoType,
-        .addPropertyName = params->state.addPropertyName,
-        .mainDictPropOffset = params->state.mainDictPropOffset,
-        .annoDictPropOffset = params->state.annoDictPropOffset,
-        .streamEndOffset = params->sflv.valueEndOffset,
-    };
-    // Update the states for the next encoding segment.
-    RETURN_IF_IERROR(
-        params->stackCallback->stackPush(&newEnding, params->stackDataPtr));
-    params->state.addPropertyName = true;
-    // We might have to change this for nested annotations.
-    params->state.mainDictPropOffset = outerProp->childPointerOffset;
-    // Point to the start of the value for next decoding.
-    params->state.encodedStreamOffset =
-        params->sflv.valueEndOffset - params->sflv.valueLength;
     return 0;
 }
 
 /**
- * @brief Decodes a BejResourceLink type SFLV BEJ tuple.
+ * @brief Pass a resource link to the consumer of the decoder.
  *
  * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] propName - name of the property.
+ * @param[in] linkId - PDR ID of the link.
  * @return 0 if successful.
  */
-static int bejHandleBejResourceLink(struct BejHandleTypeFuncParam* params)
+static int bejEmitResourceLink(struct BejHandleTypeFuncParam* params,
+                               const char* propName, uint64_t linkId)
 {
-    const char* propName = bejGetPropName(params);
-
-    if (params->sflv.valueLength == 0)
-    {
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackNull,
-                                  propName, params->callbacksDataPtr);
-    }
-    else
+    if (params->eventSink != bejEventSinkCallbacks)
     {
-        if (params->sflv.valueLength < bejGetNnintSize(params->sflv.value))
-        {
-            return bejErrorInvalidSize;
-        }
-        // ResourceLink value is a PDR ID (NNINT).
-        uint64_t pdrId = bejGetNnint(params->sflv.value);
-        RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackResourceLink,
-                                  propName, pdrId, params->callbacksDataPtr);
+        return bejSinkAddEvent(params, bejCursorResourceLink, propName,
+                               &(union BejValue){.linkId = linkId});
     }
-    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
-    return bejProcessEnding(params, /*canBeEmpty=*/false);
+    RETURN_IF_CALLBACK_IERROR(params->decodedCallback->callbackResourceLink,
+                              propName, linkId, params->callbacksDataPtr);
+    return 0;
 }
 
 /**
- * @brief Decodes an encoded bej stream.
+ * @brief Look for section endings.
  *
- * @param[in] schemaDictionary - main schema dictionary to use.
- * @param[in] annotationDictionary - annotation dictionary
- * @param[in] enStream - encoded stream without the PLDM header.
- * @param[in] streamLen - length of the enStream.
- * @param[in] stackCallback - callbacks for stack handlers.
- * @param[in] decodedCallback - callbacks for extracting decoded properties.
- * @param[in] callbacksDataPtr - data pointer to pass to decoded callbacks. This
- * can be used pass additional data.
- * @param[in] stackDataPtr - data pointer to pass to stack callbacks. This can
- * be used pass additional data.
- * @param[in] trailingPolicy - how to handle buffer bytes past the encoded
- * payload (i.e. past the root SFLV's value length).
+ * This figures out whether the current encoded segment marks a section
+ * ending. If so, this function will update the decoder state and pop the stack
+ * used to memorize endings. This function should be called after updating the
+ * encodedStreamOffset to the end of decoded SFLV tuple.
  *
+ * @param[in] params - a valid BejHandleTypeFuncParam which contains the decoder
+ * state.
+ * @param[in] canBeEmpty - if true, the stack being empty is not an error. If
+ * false, stack cannot be empty.
  * @return 0 if successful.
  */
-static int bejDecode(
-    const uint8_t* schemaDictionary, const uint8_t* annotationDictionary,
-    const uint8_t* enStream, uint32_t streamLen,
-    const struct BejStackCallback* stackCallback,
-    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
-    void* stackDataPtr, enum BejTrailingDataPolicy trailingPolicy)
+static int bejProcessEnding(struct BejHandleTypeFuncParam* params,
+                            bool canBeEmpty)
 {
-    struct BejHandleTypeFuncParam params = {
-        .state =
-            {
-                // We only add names of set properties. We don't use names for
-                // array
-                // properties. Here we are omitting the name of the root set.
-                .addPropertyName = false,
-                // At start, parent property from the main dictionary is the
-                // first property.
-                .mainDictPropOffset = bejDictGetPropertyHeadOffset(),
-                .annoDictPropOffset = bejDictGetFirstAnnotatedPropertyOffset(),
-                // Current location of the encoded segment we are processing.
-                .encodedStreamOffset = 0,
-                .encodedSubStream = enStream,
-                .streamLen = streamLen,
-            },
-        .mainDictionary = schemaDictionary,
-        .annotDictionary = annotationDictionary,
-        .decodedCallback = decodedCallback,
-        .stackCallback = stackCallback,
-        .callbacksDataPtr = callbacksDataPtr,
-        .stackDataPtr = stackDataPtr,
-    };
-
-    uint64_t maxOperations = 1000000;
-    uint64_t operationCount = 0;
-
-    // BEJ is self-delimiting via the root SFLV's value length field. Derive
-    // the actual payload size from the encoded data itself so callers may
-    // pass an over-sized buffer (e.g. a fixed-size PLDM message) and the
-    // trailing padding bytes are safely ignored instead of being mis-parsed
-    // as more SFLV tuples.
-    //
-    // Reject buffers smaller than the smallest legal non-empty root tuple
-    // before bejInitSFLVStruct dereferences past the buffer.
-    if (streamLen < bejMinRootSflvSize)
+    if (bejStackEmpty(params) && !canBeEmpty)
     {
-        fprintf(stderr, "Stream too short for a BEJ root tuple (%u < %u)\n",
-                streamLen, bejMinRootSflvSize);
-        return bejErrorInvalidSize;
+        // If bejProcessEnding has been called after adding an appropriate JSON
+        // property, then stack cannot be empty.
+        fprintf(stderr, "Ending stack cannot be empty.\n");
+        return bejErrorUnknown;
     }
-    if (!bejInitSFLVStruct(&params))
+
+    while (!bejStackEmpty(params))
     {
+        const struct BejStackProperty* const ending = bejStackPeek(params);
+        // Check whether the current offset location matches the expected ending
+        // offset. If so, we are done with that section.
+        if (params->state.encodedStreamOffset == ending->streamEndOffset)
+        {
+            // Since we are going out of a section, we need to reset the
+            // dictionary property offsets to this section's parent property
+            // start.
+            params->state.mainDictPropOffset = ending->mainDictPropOffset;
+            params->state.annoDictPropOffset = ending->annoDictPropOffset;
+            params->state.addPropertyName = ending->addPropertyName;
+            // The section end replaces the property end of its last child.
+            params->state.pendingPropertyEnd = false;
+
+            if (ending->sectionType == bejSectionSet)
+            {
+                RETURN_IF_IERROR(bejEmitSetEnd(params));
+            }
+            else if (ending->sectionType == bejSectionArray)
+            {
+                RETURN_IF_IERROR(bejEmitArrayEnd(params));
+            }
+            bejStackPop(params);
+            bejProjectionLeaveSection(params);
+        }
+        else
+        {
+            // callbackPropertyEnd is called once the next property is
+            // decoded. The remaining properties of the section might be
+            // skipped by a projection.
+            params->state.pendingPropertyEnd = true;
+            // Do not change the parent dictionary property offset since we are
+            // still inside the same section.
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether the current encoded segment being decoded is an array
+ * element.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return true if the encoded segment is an array element. Else false.
+ */
+static bool bejIsArrayElement(const struct BejHandleTypeFuncParam* params)
+{
+    // If the encoded segment enters an array section, we are adding a
+    // BejSectionArray to the stack. Therefore if the stack is empty, encoded
+    // segment cannot be an array element.
+    if (bejStackEmpty(params))
+    {
+        return false;
+    }
+    const struct BejStackProperty* const ending = bejStackPeek(params);
+    // If the stack top element holds a BejSectionArray, encoded segment is
+    // an array element.
+    return ending->sectionType == bejSectionArray;
+}
+
+/**
+ * @brief Record the identity of the current property and pass it to
+ * callbackPropertyId. Does nothing if params->needPropertyId is false.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @param[in] dictionary - dictionary of the property. NULL if the property is
+ * not in the dictionary.
+ * @param[in] prop - the property in the dictionary.
+ * @return 0 if successful.
+ */
+static int bejSetPropertyId(struct BejHandleTypeFuncParam* params,
+                            const uint8_t* dictionary,
+                            const struct BejDictionaryProperty* prop)
+{
+    if (!params->needPropertyId)
+    {
+        return 0;
+    }
+    params->propertyId = (struct BejPropertyId){
+        .sequenceNumber = params->sflv.tupleS.sequenceNumber,
+        .dictPropOffset = 0,
+        .schema = params->sflv.tupleS.schema,
+        .nameLength = 0,
+    };
+    if (dictionary != NULL)
+    {
+        params->propertyId.dictPropOffset =
+            (uint16_t)((const uint8_t*)prop - dictionary);
+        // nameLength includes the NULL terminator.
+        params->propertyId.nameLength =
+            (prop->nameLength > 0) ? prop->nameLength - 1 : 0;
+    }
+    RETURN_IF_CALLBACK_IERROR(params->callbackExtensions->callbackPropertyId,
+                              &params->propertyId, params->callbacksDataPtr);
+    return 0;
+}
+
+/**
+ * @brief Find the property name and the identity of the current encoded
+ * segment. If the params->state.addPropertyName is false, the name is an
+ * empty string. The dictionary is only searched if the name or the identity
+ * is needed.
+ *
+ * @param[in] params - a valid populated BejHandleTypeFuncParam.
+ * @param[out] propName - name of the property.
+ * @return 0 if successful.
+ */
+static int bejGetPropName(struct BejHandleTypeFuncParam* params,
+                          const char** propName)
+{
+    *propName = "";
+    if (!params->state.addPropertyName && !params->needPropertyId)
+    {
+        // Array elements and unnamed properties need no lookup.
+        return 0;
+    }
+    uint16_t sequenceNumber = params->sflv.tupleS.sequenceNumber;
+    if (bejIsArrayElement(params))
+    {
+        // Dictionary only contains an entry for element 0.
+        sequenceNumber = 0;
+    }
+    const uint8_t* dictionary;
+    const struct BejDictionaryProperty* prop;
+    if (bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
+                                    sequenceNumber, &dictionary, &prop) != 0)
+    {
+        // Unknown properties are passed without a name.
+        return bejSetPropertyId(params, NULL, NULL);
+    }
+    if (params->state.addPropertyName)
+    {
+        *propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
+                                           prop->nameLength);
+    }
+    return bejSetPropertyId(params, dictionary, prop);
+}
+
+/**
+ * @brief Decodes a BejSet type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejSet(struct BejHandleTypeFuncParam* params)
+{
+    uint16_t sequenceNumber = params->sflv.tupleS.sequenceNumber;
+    // Check whether this BejSet is an array element or not.
+    if (bejIsArrayElement(params))
+    {
+        // Dictionary only contains an entry for element 0.
+        sequenceNumber = 0;
+    }
+    const uint8_t* dictionary;
+    const struct BejDictionaryProperty* prop;
+    RETURN_IF_IERROR(
+        bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
+                                    sequenceNumber, &dictionary, &prop));
+
+    const char* propName = "";
+    if (params->state.addPropertyName)
+    {
+        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
+                                          prop->nameLength);
+    }
+    RETURN_IF_IERROR(bejSetPropertyId(params, dictionary, prop));
+
+    RETURN_IF_IERROR(bejEmitSetStart(params, propName));
+
+    // Move the offset to the next SFLV tuple (or end). Make sure that this is
+    // called before calling bejProcessEnding.
+    params->state.encodedStreamOffset = bejGetFirstTupleOffset(params);
+
+    uint64_t elements = bejGetNnint(params->sflv.value);
+    // If its an empty set, we are done here.
+    if (elements == 0)
+    {
+        RETURN_IF_IERROR(bejEmitSetEnd(params));
+        // Since this is an ending of a property (empty array), we should call
+        // bejProcessEnding. Unless the whole JSON object is an empty set (which
+        // shouldn't be the case), stack cannot be empty.
+        bejProcessEnding(params, /*canBeEmpty=*/false);
+        return 0;
+    }
+
+    // Update the states for the next encoding segment.
+    struct BejStackProperty newEnding = {
+        .sectionType = bejSectionSet,
+        .addPropertyName = params->state.addPropertyName,
+        .mainDictPropOffset = params->state.mainDictPropOffset,
+        .annoDictPropOffset = params->state.annoDictPropOffset,
+        .streamEndOffset = params->sflv.valueEndOffset,
+    };
+    RETURN_IF_IERROR(bejStackPush(params, &newEnding));
+    params->state.addPropertyName = true;
+    bejProjectionEnterSection(params);
+    if (params->sflv.tupleS.schema == bejAnnotation)
+    {
+        // Since this set is an annotated type, we need to advance the
+        // annotation dictionary for decoding the next segment.
+        params->state.annoDictPropOffset = prop->childPointerOffset;
+    }
+    else
+    {
+        params->state.mainDictPropOffset = prop->childPointerOffset;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodes a BejArray type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejArray(struct BejHandleTypeFuncParam* params)
+{
+    const uint8_t* dictionary;
+    const struct BejDictionaryProperty* prop;
+    RETURN_IF_IERROR(bejGetDictionaryAndProperty(
+        params, params->sflv.tupleS.schema, params->sflv.tupleS.sequenceNumber,
+        &dictionary, &prop));
+
+    const char* propName = "";
+    if (params->state.addPropertyName)
+    {
+        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
+                                          prop->nameLength);
+    }
+    RETURN_IF_IERROR(bejSetPropertyId(params, dictionary, prop));
+
+    RETURN_IF_IERROR(bejEmitArrayStart(params, propName));
+
+    // Move the offset to the next SFLV tuple (or end). Make sure that this is
+    // called before calling bejProcessEnding.
+    params->state.encodedStreamOffset = bejGetFirstTupleOffset(params);
+
+    uint64_t elements = bejGetNnint(params->sflv.value);
+    // If its an empty array, we are done here.
+    if (elements == 0)
+    {
+        RETURN_IF_IERROR(bejEmitArrayEnd(params));
+        // Since this is an ending of a property (empty array), we should call
+        // bejProcessEnding. Stack cannot be empty since there should be at
+        // least 1 parent in the stack.
+        bejProcessEnding(params, /*canBeEmpty=*/false);
+        return 0;
+    }
+
+    // Update the state for next segment decoding.
+    struct BejStackProperty newEnding = {
+        .sectionType = bejSectionArray,
+        .addPropertyName = params->state.addPropertyName,
+        .mainDictPropOffset = params->state.mainDictPropOffset,
+        .annoDictPropOffset = params->state.annoDictPropOffset,
+        .streamEndOffset = params->sflv.valueEndOffset,
+    };
+    RETURN_IF_IERROR(bejStackPush(params, &newEnding));
+    // We do not add property names for array elements.
+    params->state.addPropertyName = false;
+    bejProjectionEnterSection(params);
+    if (params->sflv.tupleS.schema == bejAnnotation)
+    {
+        // Since this array is an annotated type, we need to advance the
+        // annotation dictionary for decoding the next segment.
+        params->state.annoDictPropOffset = prop->childPointerOffset;
+    }
+    else
+    {
+        params->state.mainDictPropOffset = prop->childPointerOffset;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodes a BejNull type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejNull(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+    RETURN_IF_IERROR(bejEmitNull(params, propName));
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejInteger type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejInteger(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        RETURN_IF_IERROR(bejEmitInteger(
+            params, propName,
+            bejGetIntegerValue(params->sflv.value, params->sflv.valueLength)));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejEnum type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejEnum(struct BejHandleTypeFuncParam* params)
+{
+    uint16_t sequenceNumber = params->sflv.tupleS.sequenceNumber;
+    if (bejIsArrayElement(params))
+    {
+        sequenceNumber = 0;
+    }
+    const uint8_t* dictionary;
+    const struct BejDictionaryProperty* prop;
+    RETURN_IF_IERROR(
+        bejGetDictionaryAndProperty(params, params->sflv.tupleS.schema,
+                                    sequenceNumber, &dictionary, &prop));
+
+    const char* propName = "";
+    if (params->state.addPropertyName)
+    {
+        propName = bejDictGetPropertyName(dictionary, prop->nameOffset,
+                                          prop->nameLength);
+    }
+    RETURN_IF_IERROR(bejSetPropertyId(params, dictionary, prop));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        // Get the string for enum value.
+        uint16_t enumValueSequenceN =
+            (uint16_t)(bejGetNnint(params->sflv.value));
+        const struct BejDictionaryIndex* dictIndex =
+            params->sflv.tupleS.schema == bejAnnotation
+                ? params->annotDictIndex
+                : params->mainDictIndex;
+        const struct BejDictionaryProperty* enumValueProp;
+        RETURN_IF_IERROR(bejDecoderGetProperty(
+            params, dictionary, dictIndex, prop->childPointerOffset,
+            enumValueSequenceN, &enumValueProp));
+        const char* enumValueName = bejDictGetPropertyName(
+            dictionary, enumValueProp->nameOffset, enumValueProp->nameLength);
+
+        RETURN_IF_IERROR(bejEmitEnum(params, propName, enumValueName));
+    }
+    // Update the offset to point to the next possible SFLV tuple.
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejString type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejString(struct BejHandleTypeFuncParam* params)
+{
+    // TODO: Handle deferred bindings.
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        RETURN_IF_IERROR(bejEmitString(params, propName));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejBytestring type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejBytestring(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    // The event sinks have no bytestring event.
+    if (params->sflv.valueLength == 0 ||
+        params->eventSink != bejEventSinkCallbacks ||
+        params->callbackExtensions->callbackBytestring == NULL)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        // The bytes are passed without copying them.
+        RETURN_IF_IERROR(params->callbackExtensions->callbackBytestring(
+            propName, params->sflv.value, params->sflv.valueLength,
+            params->callbacksDataPtr));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejReal type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejReal(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        // Real value has the following format.
+        // nnint      - Length of whole
+        // bejInteger - whole (includes sign for the overall real number)
+        // nnint      - Leading zero count for fract
+        // nnint      - fract
+        // nnint      - Length of exp
+        // bejInteger - exp (includes sign for the exponent)
+        uint8_t wholeByteLen = (uint8_t)bejGetNnint(params->sflv.value);
+        const uint8_t* wholeBejInt =
+            params->sflv.value + bejGetNnintSize(params->sflv.value);
+        const uint8_t* fractZeroCountNnint = wholeBejInt + wholeByteLen;
+        const uint8_t* fractNnint =
+            fractZeroCountNnint + bejGetNnintSize(fractZeroCountNnint);
+        const uint8_t* lenExpNnint = fractNnint + bejGetNnintSize(fractNnint);
+        const uint8_t* expBejInt = lenExpNnint + bejGetNnintSize(lenExpNnint);
+
+        struct BejReal realValue;
+        realValue.whole = bejGetIntegerValue(wholeBejInt, wholeByteLen);
+        realValue.zeroCount = bejGetNnint(fractZeroCountNnint);
+        realValue.fract = bejGetNnint(fractNnint);
+        realValue.expLen = (uint8_t)bejGetNnint(lenExpNnint);
+        if (realValue.expLen != 0)
+        {
+            realValue.exp = bejGetIntegerValue(
+                expBejInt, (uint8_t)bejGetNnint(lenExpNnint));
+        }
+        RETURN_IF_IERROR(bejEmitReal(params, propName, &realValue));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejBoolean type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejBoolean(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        RETURN_IF_IERROR(
+            bejEmitBool(params, propName, *(params->sflv.value) > 0));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Decodes a BejPropertyAnnotation type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejPropertyAnnotation(struct BejHandleTypeFuncParam* params)
+{
+    // TODO: Handle colon-delimited string values.
+
+    // Property annotation has the form OuterProperty@Annotation. First
+    // processing the outer property name.
+    const uint8_t* outerDictionary;
+    const struct BejDictionaryProperty* outerProp;
+    RETURN_IF_IERROR(bejGetDictionaryAndProperty(
+        params, params->sflv.tupleS.schema, params->sflv.tupleS.sequenceNumber,
+        &outerDictionary, &outerProp));
+
+    const char* propName = bejDictGetPropertyName(
+        outerDictionary, outerProp->nameOffset, outerProp->nameLength);
+    RETURN_IF_IERROR(bejSetPropertyId(params, outerDictionary, outerProp));
+    RETURN_IF_IERROR(bejEmitAnnotation(params, propName));
+
+    // Mark the ending of the property annotation.
+    struct BejStackProperty newEnding = {
+        .sectionType = bejSectionNoType,
+        .addPropertyName = params->state.addPropertyName,
+        .mainDictPropOffset = params->state.mainDictPropOffset,
+        .annoDictPropOffset = params->state.annoDictPropOffset,
+        .streamEndOffset = params->sflv.valueEndOffset,
+    };
+    // Update the states for the next encoding segment.
+    RETURN_IF_IERROR(bejStackPush(params, &newEnding));
+    params->state.addPropertyName = true;
+    bejProjectionEnterSection(params);
+    // We might have to change this for nested annotations.
+    params->state.mainDictPropOffset = outerProp->childPointerOffset;
+    // Point to the start of the value for next decoding.
+    params->state.encodedStreamOffset =
+        params->sflv.valueEndOffset - params->sflv.valueLength;
+    return 0;
+}
+
+/**
+ * @brief Decodes a BejResourceLink type SFLV BEJ tuple.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam struct.
+ * @return 0 if successful.
+ */
+static int bejHandleBejResourceLink(struct BejHandleTypeFuncParam* params)
+{
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+
+    if (params->sflv.valueLength == 0)
+    {
+        RETURN_IF_IERROR(bejEmitNull(params, propName));
+    }
+    else
+    {
+        if (params->sflv.valueLength < bejGetNnintSize(params->sflv.value))
+        {
+            return bejErrorInvalidSize;
+        }
+        // ResourceLink value is a PDR ID (NNINT).
+        uint64_t pdrId = bejGetNnint(params->sflv.value);
+        RETURN_IF_IERROR(bejEmitResourceLink(params, propName, pdrId));
+    }
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Find the tuple selected by a path and prepare the decoder state to
+ * decode only that tuple.
+ *
+ * Sets and arrays that are not on the path are skipped using their value
+ * length, so the cost depends on the path depth and the number of siblings
+ * along it rather than the size of the stream.
+ *
+ * @param[inout] params - decoder parameters with params->sflv holding the
+ * root tuple.
+ * @param[in] path - a resolved path with at least one step.
+ * @return 0 if successful. bejErrorUnknownProperty if the stream does not
+ * contain the property.
+ */
+static int bejFindPath(struct BejHandleTypeFuncParam* params,
+                       const struct BejPath* path)
+{
+    // The root tuple is at the start of the stream.
+    const uint8_t* enStream = params->state.encodedSubStream;
+    for (uint32_t i = 0; i < path->depth; ++i)
+    {
+        const struct BejPathStep* step = &path->steps[i];
+        if (step->anyElement)
+        {
+            fprintf(stderr, "Path selects more than one array element\n");
+            return bejErrorNotSupported;
+        }
+        const enum BejPrincipalDataType expectedType =
+            step->arrayElement ? bejArray : bejSet;
+        if (params->sflv.format.principalDataType != expectedType ||
+            params->sflv.valueLength == 0 ||
+            bejGetNnintSize(params->sflv.value) > params->sflv.valueLength)
+        {
+            return bejErrorUnknownProperty;
+        }
+
+        const uint32_t end = params->sflv.valueEndOffset;
+        uint32_t offset = bejGetFirstTupleOffset(params);
+        bool found = false;
+        while (offset < end)
+        {
+            params->state.encodedStreamOffset = offset;
+            params->state.encodedSubStream = enStream + offset;
+            if (!bejInitSFLVStruct(params) ||
+                params->sflv.valueEndOffset > end)
+            {
+                return bejErrorInvalidSize;
+            }
+            // Annotations of a property use the property sequence number.
+            if (params->sflv.tupleS.sequenceNumber == step->sequenceNumber &&
+                params->sflv.tupleS.schema == step->schema &&
+                params->sflv.format.principalDataType != bejPropertyAnnotation)
+            {
+                found = true;
+                break;
+            }
+            // Skip the whole tuple without looking at its value.
+            offset = params->sflv.valueEndOffset;
+        }
+        if (!found)
+        {
+            return bejErrorUnknownProperty;
+        }
+    }
+
+    const struct BejPathStep* last = &path->steps[path->depth - 1];
+    if (last->schema == bejAnnotation)
+    {
+        params->state.annoDictPropOffset = last->dictPropOffset;
+    }
+    else
+    {
+        params->state.mainDictPropOffset = last->dictPropOffset;
+    }
+    // Output the value without its property name.
+    params->state.addPropertyName = false;
+
+    // Mark the ending of the selected tuple so that it is decoded like a
+    // complete stream.
+    struct BejStackProperty newEnding = {
+        .sectionType = bejSectionNoType,
+        .addPropertyName = false,
+        .mainDictPropOffset = params->state.mainDictPropOffset,
+        .annoDictPropOffset = params->state.annoDictPropOffset,
+        .streamEndOffset = params->sflv.valueEndOffset,
+    };
+    return bejStackPush(params, &newEnding);
+}
+
+/**
+ * @brief Check whether the current tuple is selected by the projection.
+ *
+ * Also sets the projection state used for the children of the tuple.
+ *
+ * @param[inout] params - a valid populated BejHandleTypeFuncParam.
+ * @return true if the tuple should be decoded. false if it should be skipped.
+ */
+static bool bejProjectionSelect(struct BejHandleTypeFuncParam* params)
+{
+    params->childProjectionMask = params->state.projectionMask;
+    params->childProjectionDepth = params->state.projectionDepth;
+    // Root tuple and the children of selected properties are always decoded.
+    if (params->state.projectionMask == 0 || bejStackEmpty(params))
+    {
+        return true;
+    }
+
+    const bool arrayElement = bejIsArrayElement(params);
+    const uint32_t depth = params->state.projectionDepth;
+    uint32_t matched = 0;
+    for (uint32_t i = 0; i < params->projection->count; ++i)
+    {
+        if ((params->state.projectionMask & (UINT32_C(1) << i)) == 0)
+        {
+            continue;
+        }
+        const struct BejPath* path = &params->projection->paths[i];
+        const struct BejPathStep* step = &path->steps[depth];
+        // Sequence number of an array element is its index.
+        const bool sameSequence =
+            step->sequenceNumber == params->sflv.tupleS.sequenceNumber;
+        bool match;
+        if (arrayElement)
+        {
+            match = step->arrayElement && (step->anyElement || sameSequence);
+        }
+        else
+        {
+            match = !step->arrayElement && sameSequence &&
+                    step->schema == params->sflv.tupleS.schema;
+        }
+        if (!match)
+        {
+            continue;
+        }
+        if (path->depth == depth + 1)
+        {
+            // The whole property is selected.
+            params->childProjectionMask = 0;
+            return true;
+        }
+        matched |= UINT32_C(1) << i;
+    }
+    // Property annotations are only decoded along with a selected property.
+    if (matched == 0 ||
+        params->sflv.format.principalDataType == bejPropertyAnnotation)
+    {
+        return false;
+    }
+    params->childProjectionMask = matched;
+    params->childProjectionDepth = depth + 1;
+    return true;
+}
+
+/**
+ * @brief Skip the current tuple without decoding its value.
+ *
+ * @param[in] params - a valid populated BejHandleTypeFuncParam.
+ * @return 0 if successful.
+ */
+static int bejSkipTuple(struct BejHandleTypeFuncParam* params)
+{
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    // Nothing was decoded. So only the sections ending here need processing.
+    // The root tuple is never skipped. So the stack cannot be empty.
+    const struct BejStackProperty* const ending = bejStackPeek(params);
+    if (params->state.encodedStreamOffset != ending->streamEndOffset)
+    {
+        return 0;
+    }
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Get the initial projection state.
+ *
+ * @param[in] projection - projection to validate. Can be NULL.
+ * @param[out] mask - projection mask for the children of the root tuple.
+ * @return 0 if successful.
+ */
+static int bejProjectionInit(const struct BejProjection* projection,
+                             uint32_t* mask)
+{
+    *mask = 0;
+    if (projection == NULL)
+    {
+        return 0;
+    }
+    if (projection->count > BEJ_MAX_PROJECTION_PATHS)
+    {
+        fprintf(stderr, "Too many projection paths: %u\n", projection->count);
+        return bejErrorNotSupported;
+    }
+    if (projection->count > 0)
+    {
+        NULL_CHECK(projection->paths, "projection paths");
+    }
+    for (uint32_t i = 0; i < projection->count; ++i)
+    {
+        if (projection->paths[i].depth == 0)
+        {
+            // The whole resource is selected.
+            *mask = 0;
+            return 0;
+        }
+        if (projection->paths[i].depth > BEJ_MAX_PATH_DEPTH)
+        {
+            fprintf(stderr, "Invalid projection path depth: %u\n",
+                    projection->paths[i].depth);
+            return bejErrorInvalidSize;
+        }
+        *mask |= UINT32_C(1) << i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Call the callbacks due before the value of a selected tuple.
+ *
+ * @param[in] params - a valid populated BejHandleTypeFuncParam.
+ * @return 0 if successful.
+ */
+static int bejBeginTuple(struct BejHandleTypeFuncParam* params)
+{
+    if (params->state.pendingPropertyEnd)
+    {
+        params->state.pendingPropertyEnd = false;
+        RETURN_IF_CALLBACK_IERROR(
+            params->decodedCallback->callbackPropertyEnd,
+            params->callbacksDataPtr);
+    }
+
+    if (params->sflv.format.readOnlyPropertyAndTopLevelAnnotation)
+    {
+        RETURN_IF_CALLBACK_IERROR(
+            params->decodedCallback
+                ->callbackReadonlyPropertyAndTopLevelAnnotation,
+            params->sflv.tupleS.sequenceNumber, params->callbacksDataPtr);
+    }
+    return 0;
+}
+
+/**
+ * @brief Decode the tuple described by params->sflv.
+ *
+ * @param[in] params - a valid populated BejHandleTypeFuncParam. The value of
+ * the tuple should be available unless the tuple is skipped by a projection.
+ * @return 0 if successful.
+ */
+static int bejDecodeTuple(struct BejHandleTypeFuncParam* params)
+{
+    if (!bejProjectionSelect(params))
+    {
+        return bejSkipTuple(params);
+    }
+    RETURN_IF_IERROR(bejBeginTuple(params));
+
+    // TODO: Handle nullable property types. These are indicated by
+    // params->sflv.format.nullableProperty
+    switch (params->sflv.format.principalDataType)
+    {
+        case bejSet:
+            RETURN_IF_IERROR(bejHandleBejSet(params));
+            break;
+        case bejArray:
+            RETURN_IF_IERROR(bejHandleBejArray(params));
+            break;
+        case bejNull:
+            RETURN_IF_IERROR(bejHandleBejNull(params));
+            break;
+        case bejInteger:
+            RETURN_IF_IERROR(bejHandleBejInteger(params));
+            break;
+        case bejEnum:
+            RETURN_IF_IERROR(bejHandleBejEnum(params));
+            break;
+        case bejString:
+            RETURN_IF_IERROR(bejHandleBejString(params));
+            break;
+        case bejReal:
+            RETURN_IF_IERROR(bejHandleBejReal(params));
+            break;
+        case bejBoolean:
+            RETURN_IF_IERROR(bejHandleBejBoolean(params));
+            break;
+        case bejBytestring:
+            RETURN_IF_IERROR(bejHandleBejBytestring(params));
+            break;
+        case bejChoice:
+            // TODO: Add support for BejChoice decoding.
+            fprintf(stderr, "No BejChoice support\n");
+            RETURN_IF_IERROR(bejHandleBejNull(params));
+            break;
+        case bejPropertyAnnotation:
+            RETURN_IF_IERROR(bejHandleBejPropertyAnnotation(params));
+            break;
+        case bejResourceLink:
+            RETURN_IF_IERROR(bejHandleBejResourceLink(params));
+            break;
+        case bejResourceLinkExpansion:
+            // TODO: Add support for BejResourceLinkExpansion decoding.
+            fprintf(stderr, "No BejResourceLinkExpansion support\n");
+            RETURN_IF_IERROR(bejHandleBejNull(params));
+            break;
+        default:
+            fprintf(stderr, "Unknown Bej format: %u\n",
+                    params->sflv.format.principalDataType);
+            RETURN_IF_IERROR(bejHandleBejNull(params));
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Close the remaining sections once the whole payload is decoded.
+ *
+ * @param[in] params - a valid BejHandleTypeFuncParam.
+ * @return 0 if successful.
+ */
+static int bejDecodeEnd(struct BejHandleTypeFuncParam* params)
+{
+    RETURN_IF_IERROR(bejProcessEnding(params, /*canBeEmpty=*/true));
+    if (!bejStackEmpty(params))
+    {
+        fprintf(stderr, "Ending stack should be empty but its not. Something "
+                        "must have gone wrong with the encoding\n");
+        return bejErrorUnknown;
+    }
+    return 0;
+}
+
+/**
+ * @brief React to bytes that lie past the encoded payload according to the
+ * caller-selected policy.
+ *
+ * @param[in] payloadLen - length of the encoded payload.
+ * @param[in] streamLen - number of bytes received. Not less than payloadLen.
+ * @param[in] trailingPolicy - policy for handling trailing bytes.
+ * @return 0 if the trailing bytes are accepted.
+ */
+static int bejCheckTrailingBytes(uint32_t payloadLen, uint32_t streamLen,
+                                 enum BejTrailingDataPolicy trailingPolicy)
+{
+    if (payloadLen >= streamLen)
+    {
+        return 0;
+    }
+    const uint32_t trailingBytes = streamLen - payloadLen;
+    switch (trailingPolicy)
+    {
+        case bejTrailingError:
+            fprintf(
+                stderr,
+                "BEJ has %u trailing bytes after root SFLV (payloadLen=%u, streamLen=%u)\n",
+                trailingBytes, payloadLen, streamLen);
+            return bejErrorInvalidSize;
+        case bejTrailingWarn:
+            fprintf(
+                stderr,
+                "BEJ has %u trailing bytes after root SFLV (payloadLen=%u, streamLen=%u); ignored\n",
+                trailingBytes, payloadLen, streamLen);
+            break;
+        case bejTrailingIgnore:
+        default:
+            break;
+    }
+    return 0;
+}
+
+// Used when the caller has no callback extensions.
+static const struct BejDecodedCallbackExtensions bejNoCallbackExtensions = {
+    .callbackBytestring = NULL,
+    .callbackStringBegin = NULL,
+    .callbackStringFragment = NULL,
+    .callbackStringEnd = NULL,
+    .callbackPropertyId = NULL,
+};
+
+/**
+ * @brief Initialize the decoder parameters for decoding from the root tuple.
+ *
+ * The encoded stream is not set.
+ *
+ * @param[out] params - decoder parameters to initialize.
+ * @param[in] schemaDictionary - main schema dictionary to use.
+ * @param[in] annotationDictionary - annotation dictionary
+ * @param[in] dictionaryIndexes - indexes of the dictionaries. Can be NULL.
+ * @param[in] stackCallback - callbacks for stack handlers.
+ * @param[in] stackStorage - library managed stack memory. If not NULL, this is
+ * used instead of stackCallback.
+ * @param[in] decodedCallback - callbacks for extracting decoded properties.
+ * @param[in] callbackExtensions - additional callbacks. Can be NULL.
+ * @param[in] callbacksDataPtr - data pointer to pass to decoded callbacks.
+ * @param[in] stackDataPtr - data pointer to pass to stack callbacks.
+ * @param[in] projection - properties to decode. Can be NULL.
+ * @return 0 if successful.
+ */
+static int bejInitDecoderParams(
+    struct BejHandleTypeFuncParam* params, const uint8_t* schemaDictionary,
+    const uint8_t* annotationDictionary,
+    const struct BejDictionaryIndexes* dictionaryIndexes,
+    const struct BejStackCallback* stackCallback,
+    struct BejStackStorage* stackStorage,
+    const struct BejDecodedCallback* decodedCallback,
+    const struct BejDecodedCallbackExtensions* callbackExtensions,
+    void* callbacksDataPtr, void* stackDataPtr,
+    const struct BejProjection* projection)
+{
+    if (callbackExtensions == NULL)
+    {
+        callbackExtensions = &bejNoCallbackExtensions;
+    }
+    if (callbackExtensions->callbackStringBegin != NULL)
+    {
+        NULL_CHECK(callbackExtensions->callbackStringFragment,
+                   "callbackStringFragment");
+        NULL_CHECK(callbackExtensions->callbackStringEnd, "callbackStringEnd");
+    }
+    *params = (struct BejHandleTypeFuncParam){
+        .state =
+            {
+                // We only add names of set properties. We don't use names for
+                // array
+                // properties. Here we are omitting the name of the root set.
+                .addPropertyName = false,
+                // At start, parent property from the main dictionary is the
+                // first property.
+                .mainDictPropOffset = bejDictGetPropertyHeadOffset(),
+                .annoDictPropOffset = bejDictGetFirstAnnotatedPropertyOffset(),
+                // Current location of the encoded segment we are processing.
+                .encodedStreamOffset = 0,
+                .encodedSubStream = NULL,
+                .streamLen = 0,
+                .sectionDepth = 0,
+                .projectionMask = 0,
+                .projectionDepth = 0,
+                .projectionMasks = {0},
+                .pendingPropertyEnd = false,
+            },
+        .mainDictionary = schemaDictionary,
+        .annotDictionary = annotationDictionary,
+        .mainDictIndex = NULL,
+        .annotDictIndex = NULL,
+        .dictionariesPrepared = false,
+        .decodedCallback = decodedCallback,
+        .callbackExtensions = callbackExtensions,
+        .stackCallback = stackCallback,
+        .callbacksDataPtr = callbacksDataPtr,
+        .stackDataPtr = stackDataPtr,
+        .stackStorage = stackStorage,
+        .projection = projection,
+        .childProjectionMask = 0,
+        .childProjectionDepth = 0,
+        .propertyId =
+            {
+                .sequenceNumber = 0,
+                .dictPropOffset = 0,
+                .schema = 0,
+                .nameLength = 0,
+            },
+        .needPropertyId = (callbackExtensions->callbackPropertyId != NULL),
+        .eventSink = bejEventSinkCallbacks,
+        .annotatedPropertyName = NULL,
+    };
+    RETURN_IF_IERROR(
+        bejProjectionInit(projection, &params->state.projectionMask));
+    params->state.projectionMasks[0] = params->state.projectionMask;
+
+    if (stackStorage != NULL)
+    {
+        stackStorage->size = 0;
+    }
+
+    if (dictionaryIndexes != NULL)
+    {
+        params->mainDictIndex = dictionaryIndexes->schemaIndex;
+        params->annotDictIndex = dictionaryIndexes->annotationIndex;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read the root tuple and find the length of the encoded payload.
+ *
+ * @param[inout] params - decoder parameters with the encoded stream set.
+ * @param[in] trailingPolicy - how to handle buffer bytes past the encoded
+ * payload (i.e. past the root SFLV's value length).
+ * @param[out] payloadLen - length of the encoded payload.
+ * @return 0 if successful.
+ */
+static int bejInitRootTuple(struct BejHandleTypeFuncParam* params,
+                            enum BejTrailingDataPolicy trailingPolicy,
+                            uint32_t* payloadLen)
+{
+    const uint32_t streamLen = params->state.streamLen;
+    // BEJ is self-delimiting via the root SFLV's value length field. Derive
+    // the actual payload size from the encoded data itself so callers may
+    // pass an over-sized buffer (e.g. a fixed-size PLDM message) and the
+    // trailing padding bytes are safely ignored instead of being mis-parsed
+    // as more SFLV tuples.
+    //
+    // Reject buffers smaller than the smallest legal non-empty root tuple
+    // before bejInitSFLVStruct dereferences past the buffer.
+    if (streamLen < bejMinRootSflvSize)
+    {
+        fprintf(stderr, "Stream too short for a BEJ root tuple (%u < %u)\n",
+                streamLen, bejMinRootSflvSize);
+        return bejErrorInvalidSize;
+    }
+    if (!bejInitSFLVStruct(params))
+    {
+        return bejErrorInvalidSize;
+    }
+    if (params->sflv.valueEndOffset > streamLen)
+    {
+        fprintf(
+            stderr,
+            "Root tuple extends beyond buffer. valueEndOffset: %u, streamLen: %u\n",
+            params->sflv.valueEndOffset, streamLen);
+        return bejErrorInvalidSize;
+    }
+    *payloadLen = params->sflv.valueEndOffset;
+
+    // The bound check above already rejected the case where payloadLen >
+    // streamLen, so any difference here means the buffer is over-sized.
+    return bejCheckTrailingBytes(*payloadLen, streamLen, trailingPolicy);
+}
+
+/**
+ * @brief Decodes an encoded bej stream with initialized decoder parameters.
+ *
+ * @param[inout] params - decoder parameters initialized by
+ * bejInitDecoderParams().
+ * @param[in] enStream - encoded stream without the PLDM header.
+ * @param[in] streamLen - length of the enStream.
+ * @param[in] trailingPolicy - how to handle buffer bytes past the encoded
+ * payload (i.e. past the root SFLV's value length).
+ * @param[in] path - if not NULL, only the property selected by the path is
+ * decoded.
+ *
+ * @return 0 if successful.
+ */
+static int bejDecodeStream(struct BejHandleTypeFuncParam* params,
+                           const uint8_t* enStream, uint32_t streamLen,
+                           enum BejTrailingDataPolicy trailingPolicy,
+                           const struct BejPath* path)
+{
+    params->state.encodedSubStream = enStream;
+    params->state.streamLen = streamLen;
+
+    uint64_t operationCount = 0;
+    uint32_t payloadLen;
+    RETURN_IF_IERROR(bejInitRootTuple(params, trailingPolicy, &payloadLen));
+
+    uint32_t decodeEnd = payloadLen;
+    bool pathArrayElement = false;
+    if (path != NULL && path->depth > 0)
+    {
+        RETURN_IF_IERROR(bejFindPath(params, path));
+        decodeEnd = params->sflv.valueEndOffset;
+        pathArrayElement = path->steps[path->depth - 1].arrayElement;
+    }
+    const uint32_t decodeStart = params->state.encodedStreamOffset;
+
+    while (params->state.encodedStreamOffset < decodeEnd)
+    {
+        if (++operationCount > bejMaxDecodeOperations)
+        {
+            fprintf(stderr, "BEJ decoding exceeded max operations\n");
+            return bejErrorNotSupported;
+        }
+        // Go to the next encoded segment in the encoded stream.
+        params->state.encodedSubStream =
+            enStream + params->state.encodedStreamOffset;
+        if (!bejInitSFLVStruct(params))
+        {
+            return bejErrorInvalidSize;
+        }
+
+        // Make sure that the next value segment (SFLV) is within the payload
+        if (params->sflv.valueEndOffset > decodeEnd)
+        {
+            fprintf(
+                stderr,
+                "Value goes beyond payload length. SFLV Offset: %u, valueEndOffset: %u, payloadLen: %u\n",
+                params->state.encodedStreamOffset, params->sflv.valueEndOffset,
+                decodeEnd);
+            return bejErrorInvalidSize;
+        }
+
+        if (pathArrayElement &&
+            params->state.encodedStreamOffset == decodeStart)
+        {
+            // The selected array element is decoded without its array. The
+            // dictionary only contains an entry for element 0.
+            params->sflv.tupleS.sequenceNumber = 0;
+        }
+
+        RETURN_IF_IERROR(bejDecodeTuple(params));
+    }
+    return bejDecodeEnd(params);
+}
+
+/**
+ * @brief Decodes an encoded bej stream.
+ *
+ * @param[in] schemaDictionary - main schema dictionary to use.
+ * @param[in] annotationDictionary - annotation dictionary
+ * @param[in] dictionaryIndexes - indexes of the dictionaries. Can be NULL.
+ * @param[in] enStream - encoded stream without the PLDM header.
+ * @param[in] streamLen - length of the enStream.
+ * @param[in] stackCallback - callbacks for stack handlers.
+ * @param[in] stackStorage - library managed stack memory. If not NULL, this is
+ * used instead of stackCallback.
+ * @param[in] decodedCallback - callbacks for extracting decoded properties.
+ * @param[in] callbackExtensions - additional callbacks. Can be NULL.
+ * @param[in] callbacksDataPtr - data pointer to pass to decoded callbacks. This
+ * can be used pass additional data.
+ * @param[in] stackDataPtr - data pointer to pass to stack callbacks. This can
+ * be used pass additional data.
+ * @param[in] trailingPolicy - how to handle buffer bytes past the encoded
+ * payload (i.e. past the root SFLV's value length).
+ * @param[in] path - if not NULL, only the property selected by the path is
+ * decoded.
+ * @param[in] projection - if not NULL, only the properties selected by the
+ * projection are decoded. Cannot be used with a path.
+ *
+ * @return 0 if successful.
+ */
+static int bejDecode(
+    const uint8_t* schemaDictionary, const uint8_t* annotationDictionary,
+    const struct BejDictionaryIndexes* dictionaryIndexes,
+    const uint8_t* enStream, uint32_t streamLen,
+    const struct BejStackCallback* stackCallback,
+    struct BejStackStorage* stackStorage,
+    const struct BejDecodedCallback* decodedCallback,
+    const struct BejDecodedCallbackExtensions* callbackExtensions,
+    void* callbacksDataPtr, void* stackDataPtr,
+    enum BejTrailingDataPolicy trailingPolicy, const struct BejPath* path,
+    const struct BejProjection* projection)
+{
+    struct BejHandleTypeFuncParam params;
+    RETURN_IF_IERROR(bejInitDecoderParams(
+        &params, schemaDictionary, annotationDictionary, dictionaryIndexes,
+        stackCallback, stackStorage, decodedCallback, callbackExtensions,
+        callbacksDataPtr, stackDataPtr, projection));
+    return bejDecodeStream(&params, enStream, streamLen, trailingPolicy, path);
+}
+
+/**
+ * @brief Check if a bej version is supported by this decoder
+ *
+ * @param[in] bejVersion - the bej version in the received encoded stream
+ * @return true if supported.
+ */
+static bool bejIsSupported(uint32_t bejVersion)
+{
+    for (uint32_t i = 0; i < sizeof(supportedBejVersions) / sizeof(uint32_t);
+         ++i)
+    {
+        if (bejVersion == supportedBejVersions[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int bejDecodePldmBlock(const struct BejDictionaries* dictionaries,
+                       const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                       const struct BejStackCallback* stackCallback,
+                       const struct BejDecodedCallback* decodedCallback,
+                       void* callbacksDataPtr, void* stackDataPtr)
+{
+    return bejDecodePldmBlockWithPolicy(
+        dictionaries, encodedPldmBlock, blockLength, stackCallback,
+        decodedCallback, callbacksDataPtr, stackDataPtr, bejTrailingIgnore);
+}
+
+int bejDecodePldmBlockWithPolicy(
+    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
+    uint32_t blockLength, const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, enum BejTrailingDataPolicy trailingPolicy)
+{
+    struct BejDecoderOptions options = {
+        .trailingPolicy = trailingPolicy,
+        .dictionaryIndexes = NULL,
+        .stackStorage = NULL,
+        .projection = NULL,
+        .callbackExtensions = NULL,
+    };
+    return bejDecodePldmBlockWithOptions(
+        dictionaries, encodedPldmBlock, blockLength, stackCallback,
+        decodedCallback, callbacksDataPtr, stackDataPtr, &options);
+}
+
+/**
+ * @brief Check the callbacks used for decoding.
+ *
+ * @param[in] stackCallback - callbacks for stack handlers.
+ * @param[in] stackStorage - library managed stack memory. If not NULL,
+ * stackCallback is not used.
+ * @param[in] decodedCallback - callbacks for extracting decoded properties.
+ * @return 0 if the callbacks can be used.
+ */
+static int bejValidateCallbacks(
+    const struct BejStackCallback* stackCallback,
+    const struct BejStackStorage* stackStorage,
+    const struct BejDecodedCallback* decodedCallback)
+{
+    if (stackStorage != NULL)
+    {
+        NULL_CHECK(stackStorage->entries, "stackStorage entries");
+    }
+    else
+    {
+        NULL_CHECK(stackCallback, "stackCallback");
+        NULL_CHECK(stackCallback->stackEmpty, "stackEmpty");
+        NULL_CHECK(stackCallback->stackPeek, "stackPeek");
+        NULL_CHECK(stackCallback->stackPop, "stackPop");
+        NULL_CHECK(stackCallback->stackPush, "stackPush");
+    }
+
+    NULL_CHECK(decodedCallback, "decodedCallback");
+    return 0;
+}
+
+/**
+ * @brief Check the callbacks and the PLDM block header before decoding.
+ *
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] blockLength - length of the PLDM block.
+ * @param[in] stackCallback - callbacks for stack handlers.
+ * @param[in] stackStorage - library managed stack memory. If not NULL,
+ * stackCallback is not used.
+ * @param[in] decodedCallback - callbacks for extracting decoded properties.
+ * @return 0 if the block can be decoded.
+ */
+static int bejValidatePldmBlock(
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejStackStorage* stackStorage,
+    const struct BejDecodedCallback* decodedCallback)
+{
+    NULL_CHECK(encodedPldmBlock, "encodedPldmBlock");
+    RETURN_IF_IERROR(
+        bejValidateCallbacks(stackCallback, stackStorage, decodedCallback));
+
+    uint32_t pldmHeaderSize = sizeof(struct BejPldmBlockHeader);
+    if (blockLength < pldmHeaderSize)
+    {
+        fprintf(stderr, "Invalid pldm block size: %u\n", blockLength);
+        return bejErrorInvalidSize;
+    }
+
+    const struct BejPldmBlockHeader* pldmHeader =
+        (const struct BejPldmBlockHeader*)encodedPldmBlock;
+
+    if (!bejIsSupported(pldmHeader->bejVersion))
+    {
+        fprintf(stderr, "Bej decoder doesn't support the bej version: %u\n",
+                pldmHeader->bejVersion);
+        return bejErrorNotSupported;
+    }
+
+    if (pldmHeader->schemaClass == bejAnnotationSchemaClass)
+    {
+        fprintf(stderr,
+                "Encoder schema class cannot be BejAnnotationSchemaClass\n");
+        return bejErrorNotSupported;
+    }
+    // TODO: Add support for CollectionMemberType schema class.
+    if (pldmHeader->schemaClass == bejCollectionMemberTypeSchemaClass)
+    {
+        fprintf(stderr, "Decoder doesn't support "
+                        "bejCollectionMemberTypeSchemaClass yet.\n");
+        return bejErrorNotSupported;
+    }
+    // TODO: Add support for Error schema class.
+    if (pldmHeader->schemaClass == bejErrorSchemaClass)
+    {
+        fprintf(stderr, "Decoder doesn't support BejErrorSchemaClass yet.\n");
+        return bejErrorNotSupported;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check the sizes of the dictionaries against their headers.
+ *
+ * @param[in] dictionaries - dictionaries with valid schema and annotation
+ * dictionaries.
+ * @return 0 if the dictionaries are valid.
+ */
+static int bejValidateDictionaries(const struct BejDictionaries* dictionaries)
+{
+    const struct BejDictionaryHeader* schemaDictionaryHeader =
+        ((const struct BejDictionaryHeader*)dictionaries->schemaDictionary);
+    if (schemaDictionaryHeader->dictionarySize !=
+        dictionaries->schemaDictionarySize)
+    {
+        fprintf(stderr, "Invalid schema dictionary size: %u. Expected: %u.\n",
+                schemaDictionaryHeader->dictionarySize,
+                dictionaries->schemaDictionarySize);
+        return bejErrorInvalidSize;
+    }
+
+    const struct BejDictionaryHeader* annotationDictionaryHeader =
+        ((const struct BejDictionaryHeader*)dictionaries->annotationDictionary);
+    if (annotationDictionaryHeader->dictionarySize !=
+        dictionaries->annotationDictionarySize)
+    {
+        fprintf(stderr,
+                "Invalid annotation dictionary size: %u. Expected: %u.\n",
+                annotationDictionaryHeader->dictionarySize,
+                dictionaries->annotationDictionarySize);
+        return bejErrorInvalidSize;
+    }
+
+    if (dictionaries->errorDictionary != NULL)
+    {
+        const struct BejDictionaryHeader* errorDictionaryHeader =
+            ((const struct BejDictionaryHeader*)dictionaries->errorDictionary);
+        if (errorDictionaryHeader->dictionarySize !=
+            dictionaries->errorDictionarySize)
+        {
+            fprintf(stderr,
+                    "Invalid error dictionary size: %u. Expected: %u.\n",
+                    errorDictionaryHeader->dictionarySize,
+                    dictionaries->errorDictionarySize);
+            return bejErrorInvalidSize;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Decode a PLDM block using plain dictionaries.
+ *
+ * @param[in] dictionaries - dictionaries needed for decoding.
+ * @param[in] path - if not NULL, only the property selected by the path is
+ * decoded.
+ * @return 0 if successful.
+ */
+static int bejDecodePldmBlockWithPath(
+    const struct BejDictionaries* dictionaries, const struct BejPath* path,
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options)
+{
+    NULL_CHECK(dictionaries, "dictionaries");
+    NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
+    NULL_CHECK(dictionaries->annotationDictionary, "annotationDictionary");
+
+    struct BejStackStorage* stackStorage =
+        (options != NULL) ? options->stackStorage : NULL;
+    RETURN_IF_IERROR(bejValidatePldmBlock(encodedPldmBlock, blockLength,
+                                          stackCallback, stackStorage,
+                                          decodedCallback));
+
+    RETURN_IF_IERROR(bejValidateDictionaries(dictionaries));
+
+    enum BejTrailingDataPolicy trailingPolicy = bejTrailingIgnore;
+    const struct BejDictionaryIndexes* dictionaryIndexes = NULL;
+    const struct BejProjection* projection = NULL;
+    const struct BejDecodedCallbackExtensions* callbackExtensions = NULL;
+    if (options != NULL)
+    {
+        trailingPolicy = options->trailingPolicy;
+        dictionaryIndexes = options->dictionaryIndexes;
+        projection = options->projection;
+        callbackExtensions = options->callbackExtensions;
+    }
+    if (path != NULL && projection != NULL)
+    {
+        fprintf(stderr, "Projection cannot be used with a path\n");
+        return bejErrorNotSupported;
+    }
+
+    // Skip the PLDM header.
+    uint32_t pldmHeaderSize = sizeof(struct BejPldmBlockHeader);
+    const uint8_t* enStream = encodedPldmBlock + pldmHeaderSize;
+    uint32_t streamLen = blockLength - pldmHeaderSize;
+    return bejDecode(dictionaries->schemaDictionary,
+                     dictionaries->annotationDictionary, dictionaryIndexes,
+                     enStream, streamLen, stackCallback, stackStorage,
+                     decodedCallback, callbackExtensions, callbacksDataPtr,
+                     stackDataPtr, trailingPolicy, path, projection);
+}
+
+int bejDecodePldmBlockWithOptions(
+    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
+    uint32_t blockLength, const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options)
+{
+    return bejDecodePldmBlockWithPath(
+        dictionaries, NULL, encodedPldmBlock, blockLength, stackCallback,
+        decodedCallback, callbacksDataPtr, stackDataPtr, options);
+}
+
+int bejDecodePldmBlockPath(
+    const struct BejDictionaries* dictionaries, const struct BejPath* path,
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options)
+{
+    NULL_CHECK(path, "path");
+    return bejDecodePldmBlockWithPath(
+        dictionaries, path, encodedPldmBlock, blockLength, stackCallback,
+        decodedCallback, callbacksDataPtr, stackDataPtr, options);
+}
+
+int bejDecodePldmBlockPrepared(
+    const struct BejDictionaryIndexes* preparedDictionaries,
+    const uint8_t* encodedPldmBlock, uint32_t blockLength,
+    const struct BejStackCallback* stackCallback,
+    const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
+    void* stackDataPtr, const struct BejDecoderOptions* options)
+{
+    NULL_CHECK(preparedDictionaries, "preparedDictionaries");
+    if (!bejDictIndexIsPrepared(preparedDictionaries->schemaIndex) ||
+        !bejDictIndexIsPrepared(preparedDictionaries->annotationIndex))
+    {
+        fprintf(stderr, "Dictionaries are not prepared\n");
+        return bejErrorNotSupported;
+    }
+
+    struct BejStackStorage* stackStorage =
+        (options != NULL) ? options->stackStorage : NULL;
+    RETURN_IF_IERROR(bejValidatePldmBlock(encodedPldmBlock, blockLength,
+                                          stackCallback, stackStorage,
+                                          decodedCallback));
+
+    // Dictionary headers were validated while preparing the dictionaries.
+    enum BejTrailingDataPolicy trailingPolicy = bejTrailingIgnore;
+    const struct BejProjection* projection = NULL;
+    const struct BejDecodedCallbackExtensions* callbackExtensions = NULL;
+    if (options != NULL)
+    {
+        trailingPolicy = options->trailingPolicy;
+        projection = options->projection;
+        callbackExtensions = options->callbackExtensions;
+    }
+
+    struct BejHandleTypeFuncParam params;
+    RETURN_IF_IERROR(bejInitDecoderParams(
+        &params, preparedDictionaries->schemaIndex->dictionary,
+        preparedDictionaries->annotationIndex->dictionary, preparedDictionaries,
+        stackCallback, stackStorage, decodedCallback, callbackExtensions,
+        callbacksDataPtr, stackDataPtr, projection));
+    // Checked above, so the lookups trust the indexes.
+    params.dictionariesPrepared = true;
+
+    // Skip the PLDM header.
+    uint32_t pldmHeaderSize = sizeof(struct BejPldmBlockHeader);
+    return bejDecodeStream(&params, encodedPldmBlock + pldmHeaderSize,
+                           blockLength - pldmHeaderSize, trailingPolicy, NULL);
+}
+
+int bejIncrementalDecoderInit(struct BejIncrementalDecoder* decoder,
+                              const struct BejDictionaries* dictionaries,
+                              const struct BejStackCallback* stackCallback,
+                              const struct BejDecodedCallback* decodedCallback,
+                              void* callbacksDataPtr, void* stackDataPtr,
+                              uint8_t* buffer, uint32_t bufferCapacity,
+                              const struct BejDecoderOptions* options)
+{
+    NULL_CHECK(decoder, "decoder");
+    NULL_CHECK(dictionaries, "dictionaries");
+    NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
+    NULL_CHECK(dictionaries->annotationDictionary, "annotationDictionary");
+    NULL_CHECK(buffer, "buffer");
+
+    struct BejStackStorage* stackStorage = NULL;
+    const struct BejDictionaryIndexes* dictionaryIndexes = NULL;
+    const struct BejProjection* projection = NULL;
+    const struct BejDecodedCallbackExtensions* callbackExtensions = NULL;
+    decoder->trailingPolicy = bejTrailingIgnore;
+    if (options != NULL)
+    {
+        stackStorage = options->stackStorage;
+        dictionaryIndexes = options->dictionaryIndexes;
+        projection = options->projection;
+        callbackExtensions = options->callbackExtensions;
+        decoder->trailingPolicy = options->trailingPolicy;
+    }
+    RETURN_IF_IERROR(
+        bejValidateCallbacks(stackCallback, stackStorage, decodedCallback));
+    RETURN_IF_IERROR(bejValidateDictionaries(dictionaries));
+
+    decoder->buffer = buffer;
+    decoder->bufferCapacity = bufferCapacity;
+    decoder->bufferSize = 0;
+    decoder->headerSize = 0;
+    decoder->receivedLength = 0;
+    decoder->payloadLength = 0;
+    decoder->operationCount = 0;
+    decoder->stringRemaining = 0;
+    decoder->stringOffset = 0;
+    decoder->done = false;
+    return bejInitDecoderParams(
+        &decoder->params, dictionaries->schemaDictionary,
+        dictionaries->annotationDictionary, dictionaryIndexes, stackCallback,
+        stackStorage, decodedCallback, callbackExtensions, callbacksDataPtr,
+        stackDataPtr, projection);
+}
+
+/**
+ * @brief Get the number of bytes of the current tuple needed to decode it.
+ *
+ * Only the part of the value the decoder reads is needed. Sets and arrays
+ * need their element count and skipped tuples need only their header. If the
+ * header is available, params->sflv is initialized.
+ *
+ * @param[inout] decoder - a valid incremental decoder.
+ * @param[in] tuple - start of the current tuple.
+ * @param[in] available - number of bytes available from tuple.
+ * @param[out] needed - number of bytes needed from tuple. If this is larger
+ * than available, it might grow once more bytes are available.
+ * @return 0 if successful.
+ */
+static int bejIncrementalGetNeededBytes(struct BejIncrementalDecoder* decoder,
+                                        const uint8_t* tuple,
+                                        uint32_t available, uint32_t* needed)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    // Sequence number and format.
+    const uint32_t valueLenNnintOffset =
+        sizeof(uint8_t) + (uint32_t)tuple[0] + sizeof(uint8_t);
+    if (available <= valueLenNnintOffset)
+    {
+        *needed = valueLenNnintOffset + sizeof(uint8_t);
+        return 0;
+    }
+    const uint32_t valueOffset = valueLenNnintOffset + sizeof(uint8_t) +
+                                 (uint32_t)tuple[valueLenNnintOffset];
+    if (available < valueOffset)
+    {
+        *needed = valueOffset;
+        return 0;
+    }
+
+    params->state.encodedSubStream = tuple;
+    params->state.streamLen = params->state.encodedStreamOffset + available;
+    if (!bejInitSFLVStruct(params))
+    {
+        return bejErrorInvalidSize;
+    }
+    if (decoder->payloadLength == 0)
+    {
+        // This is the root tuple. Its value length bounds the payload.
+        decoder->payloadLength = params->sflv.valueEndOffset;
+    }
+    else if (params->sflv.valueEndOffset > decoder->payloadLength)
+    {
+        fprintf(
+            stderr,
+            "Value goes beyond payload length. SFLV Offset: %u, valueEndOffset: %u, payloadLen: %u\n",
+            params->state.encodedStreamOffset, params->sflv.valueEndOffset,
+            decoder->payloadLength);
         return bejErrorInvalidSize;
     }
-    if (params.sflv.valueEndOffset > streamLen)
+
+    *needed = valueOffset;
+    if (!bejProjectionSelect(params))
+    {
+        return 0;
+    }
+    switch (params->sflv.format.principalDataType)
+    {
+        case bejSet:
+        case bejArray:
+        {
+            // Only the nnint holding the number of elements is needed. The
+            // elements are decoded as separate tuples.
+            if (params->sflv.valueLength == 0)
+            {
+                fprintf(stderr, "Missing element count at offset: %u\n",
+                        params->state.encodedStreamOffset);
+                return bejErrorInvalidSize;
+            }
+            if (available == valueOffset)
+            {
+                *needed = valueOffset + sizeof(uint8_t);
+                return 0;
+            }
+            const uint32_t countSize =
+                sizeof(uint8_t) + (uint32_t)tuple[valueOffset];
+            if (countSize > params->sflv.valueLength)
+            {
+                fprintf(stderr, "Invalid element count at offset: %u\n",
+                        params->state.encodedStreamOffset);
+                return bejErrorInvalidSize;
+            }
+            *needed = valueOffset + countSize;
+            break;
+        }
+        case bejPropertyAnnotation:
+            // The value is the annotation tuple itself.
+            break;
+        case bejString:
+            if (params->callbackExtensions->callbackStringBegin != NULL)
+            {
+                // The value can be passed in fragments as it arrives.
+                break;
+            }
+            *needed = valueOffset + params->sflv.valueLength;
+            break;
+        default:
+            *needed = valueOffset + params->sflv.valueLength;
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Start passing a string whose value is only partly available.
+ *
+ * @param[inout] decoder - a valid incremental decoder. params->sflv describes
+ * the string tuple.
+ * @param[in] tuple - start of the string tuple.
+ * @param[in] available - number of bytes available from tuple.
+ * @return 0 if successful.
+ */
+static int bejIncrementalBeginString(struct BejIncrementalDecoder* decoder,
+                                     const uint8_t* tuple, uint32_t available)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    const struct BejDecodedCallbackExtensions* callback =
+        params->callbackExtensions;
+    const uint32_t valueOffset = (uint32_t)(params->sflv.value - tuple);
+    const uint32_t fragmentLength = available - valueOffset;
+
+    RETURN_IF_IERROR(bejBeginTuple(params));
+    const char* propName;
+    RETURN_IF_IERROR(bejGetPropName(params, &propName));
+    RETURN_IF_IERROR(callback->callbackStringBegin(
+        propName, params->sflv.valueLength, params->callbacksDataPtr));
+    if (fragmentLength > 0)
+    {
+        RETURN_IF_IERROR(callback->callbackStringFragment(
+            (const char*)(params->sflv.value), fragmentLength,
+            params->callbacksDataPtr));
+    }
+    decoder->stringRemaining = params->sflv.valueLength - fragmentLength;
+    decoder->stringOffset = params->state.encodedStreamOffset + available;
+    return 0;
+}
+
+/**
+ * @brief Pass the next bytes of a string started by
+ * bejIncrementalBeginString().
+ *
+ * Once the whole value is passed, the string is finished and the decoder
+ * moves to the next tuple.
+ *
+ * @param[inout] decoder - a valid incremental decoder.
+ * @param[in] bytes - bytes at decoder->stringOffset.
+ * @param[in] available - number of bytes available.
+ * @return 0 if successful.
+ */
+static int bejIncrementalContinueString(struct BejIncrementalDecoder* decoder,
+                                        const uint8_t* bytes,
+                                        uint32_t available)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    const struct BejDecodedCallbackExtensions* callback =
+        params->callbackExtensions;
+    const uint32_t fragmentLength = (available < decoder->stringRemaining)
+                                        ? available
+                                        : decoder->stringRemaining;
+    RETURN_IF_IERROR(callback->callbackStringFragment(
+        (const char*)bytes, fragmentLength, params->callbacksDataPtr));
+    decoder->stringRemaining -= fragmentLength;
+    decoder->stringOffset += fragmentLength;
+    if (decoder->stringRemaining > 0)
+    {
+        return 0;
+    }
+    RETURN_IF_IERROR(callback->callbackStringEnd(params->callbacksDataPtr));
+    params->state.encodedStreamOffset = params->sflv.valueEndOffset;
+    return bejProcessEnding(params, /*canBeEmpty=*/false);
+}
+
+/**
+ * @brief Check whether the current tuple is a string to pass in fragments.
+ *
+ * @param[in] decoder - a valid incremental decoder. params->sflv describes
+ * the current tuple.
+ * @param[in] tuple - start of the current tuple.
+ * @param[in] available - number of bytes available from tuple.
+ * @return true if the tuple is a selected string whose value is not
+ * completely available and callbackStringBegin is set.
+ */
+static bool bejIncrementalIsPartialString(struct BejIncrementalDecoder* decoder,
+                                          const uint8_t* tuple,
+                                          uint32_t available)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    if (params->callbackExtensions->callbackStringBegin == NULL ||
+        params->sflv.format.principalDataType != bejString ||
+        params->sflv.valueLength == 0)
     {
-        fprintf(
-            stderr,
-            "Root tuple extends beyond buffer. valueEndOffset: %u, streamLen: %u\n",
-            params.sflv.valueEndOffset, streamLen);
-        return bejErrorInvalidSize;
+        return false;
     }
-    const uint32_t payloadLen = params.sflv.valueEndOffset;
+    const uint32_t valueOffset = (uint32_t)(params->sflv.value - tuple);
+    return valueOffset + params->sflv.valueLength > available &&
+           bejProjectionSelect(params);
+}
 
-    // React to bytes that lie past the encoded payload according to the
-    // caller-selected policy. The bound check above already rejected the
-    // case where payloadLen > streamLen, so any difference here means the
-    // buffer is over-sized.
-    if (payloadLen < streamLen)
+/**
+ * @brief Finish the payload or check the budget after a decoded tuple.
+ *
+ * @param[inout] decoder - a valid incremental decoder.
+ * @param[in] chunkEnd - encoded stream offset of the end of the chunk.
+ * @param[in] startCount - operation count at the start of this call.
+ * @param[in] budget - limits for this call. Can be NULL.
+ * @return 0 if successful. bejErrorWouldBlock if the budget ran out.
+ */
+static int bejIncrementalNextTuple(struct BejIncrementalDecoder* decoder,
+                                   uint32_t chunkEnd, uint64_t startCount,
+                                   const struct BejDecodeBudget* budget)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    if (params->state.encodedStreamOffset >= decoder->payloadLength)
+    {
+        RETURN_IF_IERROR(bejDecodeEnd(params));
+        decoder->bufferSize = 0;
+        decoder->done = true;
+    }
+    else if (budget != NULL &&
+             ((budget->maxTuples != 0 &&
+               decoder->operationCount - startCount >= budget->maxTuples) ||
+              (budget->yield != NULL && budget->yield(budget->dataPtr))))
     {
-        const uint32_t trailingBytes = streamLen - payloadLen;
-        switch (trailingPolicy)
+        // Bytes up to the end of the buffer are used. The rest of the
+        // chunk is fed again.
+        uint32_t resumeOffset =
+            params->state.encodedStreamOffset + decoder->bufferSize;
+        if (resumeOffset < chunkEnd)
         {
-            case bejTrailingError:
-                fprintf(
-                    stderr,
-                    "BEJ has %u trailing bytes after root SFLV (payloadLen=%u, streamLen=%u)\n",
-                    trailingBytes, payloadLen, streamLen);
-                return bejErrorInvalidSize;
-            case bejTrailingWarn:
-                fprintf(
-                    stderr,
-                    "BEJ has %u trailing bytes after root SFLV (payloadLen=%u, streamLen=%u); ignored\n",
-                    trailingBytes, payloadLen, streamLen);
-                break;
-            case bejTrailingIgnore:
-            default:
-                break;
+            decoder->receivedLength = resumeOffset;
+            return bejErrorWouldBlock;
         }
     }
+    return 0;
+}
 
-    while (params.state.encodedStreamOffset < payloadLen)
+/**
+ * @brief Decode the tuples completed by a new chunk.
+ *
+ * decoder->buffer holds the bytes of a split tuple starting at
+ * params.state.encodedStreamOffset. The remaining bytes come from the chunk.
+ *
+ * If the budget runs out, decoder->receivedLength is moved back to the end of
+ * the bytes used so far.
+ *
+ * @param[inout] decoder - a valid incremental decoder.
+ * @param[in] chunk - the new chunk.
+ * @param[in] chunkOffset - offset of the chunk from the start of the encoded
+ * stream.
+ * @param[in] budget - limits for this call. Can be NULL.
+ * @return 0 if successful. bejErrorWouldBlock if the budget ran out.
+ */
+static int bejIncrementalDecode(struct BejIncrementalDecoder* decoder,
+                                const uint8_t* chunk, uint32_t chunkOffset,
+                                const struct BejDecodeBudget* budget)
+{
+    struct BejHandleTypeFuncParam* params = &decoder->params;
+    const uint32_t chunkEnd = decoder->receivedLength;
+    const uint64_t startCount = decoder->operationCount;
+    while (!decoder->done)
     {
-        if (++operationCount > maxOperations)
+        if (decoder->stringRemaining > 0)
         {
-            fprintf(stderr, "BEJ decoding exceeded max operations\n");
-            return bejErrorNotSupported;
+            // Pass the bytes of a string that arrived with this chunk.
+            if (decoder->stringOffset >= chunkEnd)
+            {
+                return 0;
+            }
+            RETURN_IF_IERROR(bejIncrementalContinueString(
+                decoder, chunk + (decoder->stringOffset - chunkOffset),
+                chunkEnd - decoder->stringOffset));
+            if (decoder->stringRemaining > 0)
+            {
+                return 0;
+            }
+            RETURN_IF_IERROR(bejIncrementalNextTuple(decoder, chunkEnd,
+                                                     startCount, budget));
+            continue;
         }
-        // Go to the next encoded segment in the encoded stream.
-        params.state.encodedSubStream =
-            enStream + params.state.encodedStreamOffset;
-        if (!bejInitSFLVStruct(&params))
+
+        const uint32_t offset = params->state.encodedStreamOffset;
+        const uint8_t* tuple;
+        uint32_t available;
+        if (decoder->bufferSize > 0)
         {
-            return bejErrorInvalidSize;
+            tuple = decoder->buffer;
+            available = decoder->bufferSize;
+        }
+        else
+        {
+            // Skipped values might end in a later chunk.
+            if (offset >= chunkEnd)
+            {
+                return 0;
+            }
+            tuple = chunk + (offset - chunkOffset);
+            available = chunkEnd - offset;
         }
 
-        // Make sure that the next value segment (SFLV) is within the payload
-        if (params.sflv.valueEndOffset > payloadLen)
+        uint32_t needed;
+        RETURN_IF_IERROR(
+            bejIncrementalGetNeededBytes(decoder, tuple, available, &needed));
+        if (needed > available)
         {
-            fprintf(
-                stderr,
-                "Value goes beyond payload length. SFLV Offset: %u, valueEndOffset: %u, payloadLen: %u\n",
-                params.state.encodedStreamOffset, params.sflv.valueEndOffset,
-                payloadLen);
-            return bejErrorInvalidSize;
+            if (needed > decoder->bufferCapacity)
+            {
+                fprintf(
+                    stderr,
+                    "Tuple at offset %u needs %u bytes. Buffer capacity: %u\n",
+                    offset, needed, decoder->bufferCapacity);
+                return bejErrorInvalidSize;
+            }
+            if (decoder->bufferSize == 0)
+            {
+                // Keep the start of the tuple until the next chunk.
+                memcpy(decoder->buffer, tuple, available);
+                decoder->bufferSize = available;
+                return 0;
+            }
+            const uint32_t nextOffset = offset + decoder->bufferSize;
+            if (nextOffset >= chunkEnd)
+            {
+                return 0;
+            }
+            uint32_t copySize = needed - decoder->bufferSize;
+            if (copySize > chunkEnd - nextOffset)
+            {
+                copySize = chunkEnd - nextOffset;
+            }
+            memcpy(decoder->buffer + decoder->bufferSize,
+                   chunk + (nextOffset - chunkOffset), copySize);
+            decoder->bufferSize += copySize;
+            continue;
         }
 
-        if (params.sflv.format.readOnlyPropertyAndTopLevelAnnotation)
+        if (++decoder->operationCount > bejMaxDecodeOperations)
+        {
+            fprintf(stderr, "BEJ decoding exceeded max operations\n");
+            return bejErrorNotSupported;
+        }
+        if (bejIncrementalIsPartialString(decoder, tuple, available))
         {
-            RETURN_IF_CALLBACK_IERROR(
-                params.decodedCallback
-                    ->callbackReadonlyPropertyAndTopLevelAnnotation,
-                params.sflv.tupleS.sequenceNumber, params.callbacksDataPtr);
+            // Everything available belongs to the string.
+            RETURN_IF_IERROR(
+                bejIncrementalBeginString(decoder, tuple, available));
+            decoder->bufferSize = 0;
+            continue;
         }
+        RETURN_IF_IERROR(bejDecodeTuple(params));
 
-        // TODO: Handle nullable property types. These are indicated by
-        // params.sflv.format.nullableProperty
-        switch (params.sflv.format.principalDataType)
+        if (decoder->bufferSize > 0)
         {
-            case bejSet:
-                RETURN_IF_IERROR(bejHandleBejSet(&params));
-                break;
-            case bejArray:
-                RETURN_IF_IERROR(bejHandleBejArray(&params));
-                break;
-            case bejNull:
-                RETURN_IF_IERROR(bejHandleBejNull(&params));
-                break;
-            case bejInteger:
-                RETURN_IF_IERROR(bejHandleBejInteger(&params));
-                break;
-            case bejEnum:
-                RETURN_IF_IERROR(bejHandleBejEnum(&params));
-                break;
-            case bejString:
-                RETURN_IF_IERROR(bejHandleBejString(&params));
-                break;
-            case bejReal:
-                RETURN_IF_IERROR(bejHandleBejReal(&params));
-                break;
-            case bejBoolean:
-                RETURN_IF_IERROR(bejHandleBejBoolean(&params));
-                break;
-            case bejBytestring:
-                // TODO: Add support for BejBytestring decoding.
-                fprintf(stderr, "No BejBytestring support\n");
-                RETURN_IF_IERROR(bejHandleBejNull(&params));
-                break;
-            case bejChoice:
-                // TODO: Add support for BejChoice decoding.
-                fprintf(stderr, "No BejChoice support\n");
-                RETURN_IF_IERROR(bejHandleBejNull(&params));
-                break;
-            case bejPropertyAnnotation:
-                RETURN_IF_IERROR(bejHandleBejPropertyAnnotation(&params));
-                break;
-            case bejResourceLink:
-                RETURN_IF_IERROR(bejHandleBejResourceLink(&params));
-                break;
-            case bejResourceLinkExpansion:
-                // TODO: Add support for BejResourceLinkExpansion decoding.
-                fprintf(stderr, "No BejResourceLinkExpansion support\n");
-                RETURN_IF_IERROR(bejHandleBejNull(&params));
-                break;
-            default:
-                fprintf(stderr, "Unknown Bej format: %u\n",
-                        params.sflv.format.principalDataType);
-                RETURN_IF_IERROR(bejHandleBejNull(&params));
-                break;
+            // Drop the decoded bytes. Children of a set or an array might
+            // already be in the buffer.
+            const uint32_t consumed =
+                params->state.encodedStreamOffset - offset;
+            if (consumed < decoder->bufferSize)
+            {
+                memmove(decoder->buffer, decoder->buffer + consumed,
+                        decoder->bufferSize - consumed);
+                decoder->bufferSize -= consumed;
+            }
+            else
+            {
+                decoder->bufferSize = 0;
+            }
         }
-    }
-    RETURN_IF_IERROR(bejProcessEnding(&params, /*canBeEmpty=*/true));
-    if (!params.stackCallback->stackEmpty(params.stackDataPtr))
-    {
-        fprintf(stderr, "Ending stack should be empty but its not. Something "
-                        "must have gone wrong with the encoding\n");
-        return bejErrorUnknown;
+
+        RETURN_IF_IERROR(
+            bejIncrementalNextTuple(decoder, chunkEnd, startCount, budget));
     }
     return 0;
 }
 
-/**
- * @brief Check if a bej version is supported by this decoder
- *
- * @param[in] bejVersion - the bej version in the received encoded stream
- * @return true if supported.
- */
-static bool bejIsSupported(uint32_t bejVersion)
+int bejIncrementalDecoderFeed(struct BejIncrementalDecoder* decoder,
+                              const uint8_t* chunk, uint32_t chunkLength)
 {
-    for (uint32_t i = 0; i < sizeof(supportedBejVersions) / sizeof(uint32_t);
-         ++i)
+    uint32_t consumed;
+    return bejIncrementalDecoderFeedBudgeted(decoder, chunk, chunkLength, NULL,
+                                             &consumed);
+}
+
+int bejIncrementalDecoderFeedBudgeted(struct BejIncrementalDecoder* decoder,
+                                      const uint8_t* chunk,
+                                      uint32_t chunkLength,
+                                      const struct BejDecodeBudget* budget,
+                                      uint32_t* consumed)
+{
+    NULL_CHECK(decoder, "decoder");
+    NULL_CHECK(consumed, "consumed");
+    *consumed = chunkLength;
+    if (chunkLength == 0)
     {
-        if (bejVersion == supportedBejVersions[i])
+        return 0;
+    }
+    NULL_CHECK(chunk, "chunk");
+
+    // Collect the PLDM block header first.
+    if (decoder->headerSize < sizeof(decoder->header))
+    {
+        uint32_t copySize = sizeof(decoder->header) - decoder->headerSize;
+        if (copySize > chunkLength)
         {
-            return true;
+            copySize = chunkLength;
+        }
+        memcpy(decoder->header + decoder->headerSize, chunk, copySize);
+        decoder->headerSize += copySize;
+        chunk += copySize;
+        chunkLength -= copySize;
+        if (decoder->headerSize < sizeof(decoder->header))
+        {
+            return 0;
         }
+        RETURN_IF_IERROR(bejValidatePldmBlock(
+            decoder->header, sizeof(decoder->header),
+            decoder->params.stackCallback, decoder->params.stackStorage,
+            decoder->params.decodedCallback));
     }
-    return false;
+
+    if ((UINT32_MAX - decoder->receivedLength) < chunkLength)
+    {
+        fprintf(stderr, "Encoded stream is too large\n");
+        return bejErrorInvalidSize;
+    }
+    const uint32_t chunkOffset = decoder->receivedLength;
+    decoder->receivedLength += chunkLength;
+    if (decoder->done || chunkLength == 0)
+    {
+        return 0;
+    }
+    int ret = bejIncrementalDecode(decoder, chunk, chunkOffset, budget);
+    if (ret == bejErrorWouldBlock)
+    {
+        *consumed -= chunkOffset + chunkLength - decoder->receivedLength;
+    }
+    return ret;
 }
 
-int bejDecodePldmBlock(const struct BejDictionaries* dictionaries,
-                       const uint8_t* encodedPldmBlock, uint32_t blockLength,
-                       const struct BejStackCallback* stackCallback,
-                       const struct BejDecodedCallback* decodedCallback,
-                       void* callbacksDataPtr, void* stackDataPtr)
+int bejIncrementalDecoderFinish(struct BejIncrementalDecoder* decoder)
 {
-    return bejDecodePldmBlockWithPolicy(
-        dictionaries, encodedPldmBlock, blockLength, stackCallback,
-        decodedCallback, callbacksDataPtr, stackDataPtr, bejTrailingIgnore);
+    NULL_CHECK(decoder, "decoder");
+    if (!decoder->done)
+    {
+        fprintf(stderr,
+                "Encoded stream ended before the payload. Received: %u\n",
+                decoder->receivedLength);
+        return bejErrorInvalidSize;
+    }
+    return bejCheckTrailingBytes(decoder->payloadLength,
+                                 decoder->receivedLength,
+                                 decoder->trailingPolicy);
 }
 
-int bejDecodePldmBlockWithPolicy(
-    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
-    uint32_t blockLength, const struct BejStackCallback* stackCallback,
+int bejDecodePldmBlockVectored(
+    const struct BejDictionaries* dictionaries, const struct BejIoVec* segments,
+    uint32_t segmentCount, const struct BejStackCallback* stackCallback,
     const struct BejDecodedCallback* decodedCallback, void* callbacksDataPtr,
-    void* stackDataPtr, enum BejTrailingDataPolicy trailingPolicy)
+    void* stackDataPtr, uint8_t* bounceBuffer, uint32_t bounceBufferCapacity,
+    const struct BejDecoderOptions* options)
+{
+    if (segmentCount > 0)
+    {
+        NULL_CHECK(segments, "segments");
+    }
+    struct BejIncrementalDecoder decoder;
+    RETURN_IF_IERROR(bejIncrementalDecoderInit(
+        &decoder, dictionaries, stackCallback, decodedCallback,
+        callbacksDataPtr, stackDataPtr, bounceBuffer, bounceBufferCapacity,
+        options));
+    for (uint32_t i = 0; i < segmentCount; ++i)
+    {
+        RETURN_IF_IERROR(bejIncrementalDecoderFeed(
+            &decoder, segments[i].base, segments[i].length));
+    }
+    return bejIncrementalDecoderFinish(&decoder);
+}
+
+// Used with the event sinks. The events don't go through callbacks.
+static const struct BejDecodedCallback bejEventSinkCallback = {
+    .callbackSetStart = NULL,
+    .callbackSetEnd = NULL,
+    .callbackArrayStart = NULL,
+    .callbackArrayEnd = NULL,
+    .callbackPropertyEnd = NULL,
+    .callbackNull = NULL,
+    .callbackInteger = NULL,
+    .callbackEnum = NULL,
+    .callbackString = NULL,
+    .callbackReal = NULL,
+    .callbackBool = NULL,
+    .callbackAnnotation = NULL,
+    .callbackResourceLink = NULL,
+    .callbackReadonlyPropertyAndTopLevelAnnotation = NULL,
+};
+
+int bejCursorInit(struct BejCursor* cursor,
+                  const struct BejDictionaries* dictionaries,
+                  const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                  const struct BejDecoderOptions* options)
 {
+    NULL_CHECK(cursor, "cursor");
     NULL_CHECK(dictionaries, "dictionaries");
     NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
     NULL_CHECK(dictionaries->annotationDictionary, "annotationDictionary");
 
-    NULL_CHECK(encodedPldmBlock, "encodedPldmBlock");
-
-    NULL_CHECK(stackCallback, "stackCallback");
-    NULL_CHECK(stackCallback->stackEmpty, "stackEmpty");
-    NULL_CHECK(stackCallback->stackPeek, "stackPeek");
-    NULL_CHECK(stackCallback->stackPop, "stackPop");
-    NULL_CHECK(stackCallback->stackPush, "stackPush");
-
-    NULL_CHECK(decodedCallback, "decodedCallback");
-
-    uint32_t pldmHeaderSize = sizeof(struct BejPldmBlockHeader);
-    if (blockLength < pldmHeaderSize)
+    cursor->stackStorage = (struct BejStackStorage){
+        .entries = cursor->stack,
+        .capacity = BEJ_MAX_STACK_DEPTH,
+        .size = 0,
+    };
+    RETURN_IF_IERROR(bejValidatePldmBlock(encodedPldmBlock, blockLength, NULL,
+                                          &cursor->stackStorage,
+                                          &bejEventSinkCallback));
+    RETURN_IF_IERROR(bejValidateDictionaries(dictionaries));
+
+    enum BejTrailingDataPolicy trailingPolicy = bejTrailingIgnore;
+    const struct BejDictionaryIndexes* dictionaryIndexes = NULL;
+    const struct BejProjection* projection = NULL;
+    if (options != NULL)
     {
-        fprintf(stderr, "Invalid pldm block size: %u\n", blockLength);
-        return bejErrorInvalidSize;
+        trailingPolicy = options->trailingPolicy;
+        dictionaryIndexes = options->dictionaryIndexes;
+        projection = options->projection;
     }
 
-    const struct BejPldmBlockHeader* pldmHeader =
-        (const struct BejPldmBlockHeader*)encodedPldmBlock;
+    cursor->eventHead = 0;
+    cursor->eventCount = 0;
+    cursor->operationCount = 0;
+    cursor->done = false;
+    cursor->enStream = encodedPldmBlock + sizeof(struct BejPldmBlockHeader);
+    struct BejHandleTypeFuncParam* params = &cursor->params;
+    RETURN_IF_IERROR(bejInitDecoderParams(
+        params, dictionaries->schemaDictionary,
+        dictionaries->annotationDictionary, dictionaryIndexes, NULL,
+        &cursor->stackStorage, &bejEventSinkCallback, NULL, (void*)cursor,
+        NULL, projection));
+    // The events are queued directly by the tuple handlers.
+    params->eventSink = bejEventSinkCursor;
+    // Every event carries the identity of its property.
+    params->needPropertyId = true;
+    params->state.encodedSubStream = cursor->enStream;
+    params->state.streamLen = blockLength - sizeof(struct BejPldmBlockHeader);
+    return bejInitRootTuple(params, trailingPolicy, &cursor->payloadLength);
+}
 
-    if (!bejIsSupported(pldmHeader->bejVersion))
-    {
-        fprintf(stderr, "Bej decoder doesn't support the bej version: %u\n",
-                pldmHeader->bejVersion);
-        return bejErrorNotSupported;
-    }
+int bejCursorNext(struct BejCursor* cursor,
+                  const struct BejCursorEvent** event)
+{
+    NULL_CHECK(cursor, "cursor");
+    NULL_CHECK(event, "event");
+    *event = NULL;
 
-    if (pldmHeader->schemaClass == bejAnnotationSchemaClass)
-    {
-        fprintf(stderr,
-                "Encoder schema class cannot be BejAnnotationSchemaClass\n");
-        return bejErrorNotSupported;
-    }
-    // TODO: Add support for CollectionMemberType schema class.
-    if (pldmHeader->schemaClass == bejCollectionMemberTypeSchemaClass)
-    {
-        fprintf(stderr, "Decoder doesn't support "
-                        "bejCollectionMemberTypeSchemaClass yet.\n");
-        return bejErrorNotSupported;
-    }
-    // TODO: Add support for Error schema class.
-    if (pldmHeader->schemaClass == bejErrorSchemaClass)
+    struct BejHandleTypeFuncParam* params = &cursor->params;
+    while (cursor->eventCount == 0)
     {
-        fprintf(stderr, "Decoder doesn't support BejErrorSchemaClass yet.\n");
-        return bejErrorNotSupported;
+        if (cursor->done)
+        {
+            return 0;
+        }
+        if (params->state.encodedStreamOffset >= cursor->payloadLength)
+        {
+            RETURN_IF_IERROR(bejDecodeEnd(params));
+            cursor->done = true;
+            continue;
+        }
+        if (++cursor->operationCount > bejMaxDecodeOperations)
+        {
+            fprintf(stderr, "BEJ decoding exceeded max operations\n");
+            return bejErrorNotSupported;
+        }
+        params->state.encodedSubStream =
+            cursor->enStream + params->state.encodedStreamOffset;
+        if (!bejInitSFLVStruct(params))
+        {
+            return bejErrorInvalidSize;
+        }
+        if (params->sflv.valueEndOffset > cursor->payloadLength)
+        {
+            fprintf(
+                stderr,
+                "Value goes beyond payload length. SFLV Offset: %u, valueEndOffset: %u, payloadLen: %u\n",
+                params->state.encodedStreamOffset, params->sflv.valueEndOffset,
+                cursor->payloadLength);
+            return bejErrorInvalidSize;
+        }
+        RETURN_IF_IERROR(bejDecodeTuple(params));
     }
 
-    const struct BejDictionaryHeader* schemaDictionaryHeader =
-        ((const struct BejDictionaryHeader*)dictionaries->schemaDictionary);
-    if (schemaDictionaryHeader->dictionarySize !=
-        dictionaries->schemaDictionarySize)
+    *event = &cursor->events[cursor->eventHead];
+    cursor->eventHead = (cursor->eventHead + 1) % BEJ_CURSOR_MAX_EVENTS;
+    --cursor->eventCount;
+    return 0;
+}
+
+uint32_t bejCursorRemainingBytes(const struct BejCursor* cursor)
+{
+    uint32_t offset = cursor->params.state.encodedStreamOffset;
+    return (offset < cursor->payloadLength) ? cursor->payloadLength - offset
+                                            : 0;
+}
+
+int bejDecodePldmBlockBatched(
+    const struct BejDictionaries* dictionaries, const uint8_t* encodedPldmBlock,
+    uint32_t blockLength, struct BejBatchEvent* events, uint32_t capacity,
+    int (*callbackBatch)(const struct BejBatchEvent* events, uint32_t count,
+                         const struct BejReal* reals, void* dataPtr),
+    void* dataPtr, const struct BejDecoderOptions* options)
+{
+    NULL_CHECK(dictionaries, "dictionaries");
+    NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
+    NULL_CHECK(dictionaries->annotationDictionary, "annotationDictionary");
+    NULL_CHECK(events, "events");
+    NULL_CHECK(callbackBatch, "callbackBatch");
+    if (capacity == 0)
     {
-        fprintf(stderr, "Invalid schema dictionary size: %u. Expected: %u.\n",
-                schemaDictionaryHeader->dictionarySize,
-                dictionaries->schemaDictionarySize);
+        fprintf(stderr, "Batch capacity is 0\n");
         return bejErrorInvalidSize;
     }
 
-    const struct BejDictionaryHeader* annotationDictionaryHeader =
-        ((const struct BejDictionaryHeader*)dictionaries->annotationDictionary);
-    if (annotationDictionaryHeader->dictionarySize !=
-        dictionaries->annotationDictionarySize)
+    struct BejBatchDecoder batch;
+    batch.stackStorage = (struct BejStackStorage){
+        .entries = batch.stack,
+        .capacity = BEJ_MAX_STACK_DEPTH,
+        .size = 0,
+    };
+    RETURN_IF_IERROR(bejValidatePldmBlock(encodedPldmBlock, blockLength, NULL,
+                                          &batch.stackStorage,
+                                          &bejEventSinkCallback));
+    RETURN_IF_IERROR(bejValidateDictionaries(dictionaries));
+
+    enum BejTrailingDataPolicy trailingPolicy = bejTrailingIgnore;
+    const struct BejDictionaryIndexes* dictionaryIndexes = NULL;
+    const struct BejProjection* projection = NULL;
+    if (options != NULL)
     {
-        fprintf(stderr,
-                "Invalid annotation dictionary size: %u. Expected: %u.\n",
-                annotationDictionaryHeader->dictionarySize,
-                dictionaries->annotationDictionarySize);
-        return bejErrorInvalidSize;
+        trailingPolicy = options->trailingPolicy;
+        dictionaryIndexes = options->dictionaryIndexes;
+        projection = options->projection;
     }
 
-    if (dictionaries->errorDictionary != NULL)
+    batch.events = events;
+    batch.capacity = capacity;
+    batch.count = 0;
+    batch.realCount = 0;
+    batch.depth = 0;
+    batch.callbackBatch = callbackBatch;
+    batch.dataPtr = dataPtr;
+    RETURN_IF_IERROR(bejInitDecoderParams(
+        &batch.params, dictionaries->schemaDictionary,
+        dictionaries->annotationDictionary, dictionaryIndexes, NULL,
+        &batch.stackStorage, &bejEventSinkCallback, NULL, (void*)&batch, NULL,
+        projection));
+    // The events are written directly by the tuple handlers.
+    batch.params.eventSink = bejEventSinkBatch;
+    // Every event carries the identity of its property.
+    batch.params.needPropertyId = true;
+    uint32_t pldmHeaderSize = sizeof(struct BejPldmBlockHeader);
+    RETURN_IF_IERROR(bejDecodeStream(
+        &batch.params, encodedPldmBlock + pldmHeaderSize,
+        blockLength - pldmHeaderSize, trailingPolicy, NULL));
+    if (batch.count > 0)
     {
-        const struct BejDictionaryHeader* errorDictionaryHeader =
-            ((const struct BejDictionaryHeader*)dictionaries->errorDictionary);
-        if (errorDictionaryHeader->dictionarySize !=
-            dictionaries->errorDictionarySize)
-        {
-            fprintf(stderr,
-                    "Invalid error dictionary size: %u. Expected: %u.\n",
-                    errorDictionaryHeader->dictionarySize,
-                    dictionaries->errorDictionarySize);
-            return bejErrorInvalidSize;
-        }
+        RETURN_IF_IERROR(
+            callbackBatch(events, batch.count, batch.reals, dataPtr));
     }
-
-    // Skip the PLDM header.
-    const uint8_t* enStream = encodedPldmBlock + pldmHeaderSize;
-    uint32_t streamLen = blockLength - pldmHeaderSize;
-    return bejDecode(dictionaries->schemaDictionary,
-                     dictionaries->annotationDictionary, enStream, streamLen,
-                     stackCallback, decodedCallback, callbacksDataPtr,
-                     stackDataPtr, trailingPolicy);
+    return 0;
 }
@@ -1,22 +1,37 @@
 #include "bej_decoder_json.hpp"
 
-#include <string.h>
-
-#include <format>
+#include "bej_base64.hpp"
+#include "bej_json_number.hpp"
+#include "bej_json_string.hpp"
 
-#define MAX_BEJ_STRING_LEN 65536
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
 
 namespace libbej
 {
 
 /**
- * @brief This structure is used to pass additional data to callback functions.
+ * @brief Find the JSON key of a property name.
+ *
+ * @param[in] params - a valid BejJsonParam struct.
+ * @param[in] propertyName - a NULL terminated string.
+ * @return the "Name": fragment or an empty view if no cache has the name.
  */
-struct BejJsonParam
+static std::string_view findKey(const struct BejJsonParam* params,
+                                const char* propertyName)
 {
-    bool* isPrevAnnotated;
-    std::string* output;
-};
+    std::string_view key;
+    if (params->schemaKeys != nullptr)
+    {
+        key = params->schemaKeys->find(propertyName);
+    }
+    if (key.empty() && params->annotationKeys != nullptr)
+    {
+        key = params->annotationKeys->find(propertyName);
+    }
+    return key;
+}
 
 /**
  * @brief Add a property name to output buffer.
@@ -31,6 +46,17 @@ static void addPropertyNameToOutput(struct BejJsonParam* params,
     {
         return;
     }
+    std::string_view key = findKey(params, propertyName);
+    if (!key.empty())
+    {
+        // The opening quote was added by the annotated property.
+        if (*params->isPrevAnnotated)
+        {
+            key.remove_prefix(1);
+        }
+        params->output->append(key);
+        return;
+    }
     if (!(*params->isPrevAnnotated))
     {
         params->output->push_back('\"');
@@ -39,6 +65,25 @@ static void addPropertyNameToOutput(struct BejJsonParam* params,
     params->output->append("\":");
 }
 
+/**
+ * @brief Pass the output to the sink if it has grown large enough.
+ *
+ * @param[in] params - a valid BejJsonParam struct.
+ * @param[in] minSize - smallest output size to flush.
+ * @return 0 if successful.
+ */
+static int flushOutput(struct BejJsonParam* params, size_t minSize)
+{
+    if (params->sink == nullptr || params->output->empty() ||
+        params->output->size() < minSize)
+    {
+        return 0;
+    }
+    int ret = (*params->sink)(*params->output);
+    params->output->clear();
+    return ret;
+}
+
 /**
  * @brief Callback for bejSet start.
  *
@@ -67,7 +112,7 @@ static int callbackSetEnd(void* dataPtr)
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
     params->output->push_back('}');
-    return 0;
+    return flushOutput(params, params->flushSize);
 }
 
 /**
@@ -98,7 +143,7 @@ static int callbackArrayEnd(void* dataPtr)
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
     params->output->push_back(']');
-    return 0;
+    return flushOutput(params, params->flushSize);
 }
 
 /**
@@ -113,7 +158,7 @@ static int callbackPropertyEnd(void* dataPtr)
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
     // Not a section ending. So add a comma.
     params->output->push_back(',');
-    return 0;
+    return flushOutput(params, params->flushSize);
 }
 
 /**
@@ -147,7 +192,7 @@ static int callbackInteger(const char* propertyName, int64_t value,
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
     addPropertyNameToOutput(params, propertyName);
-    params->output->append(std::to_string(value));
+    appendJsonInteger(*params->output, value);
     *params->isPrevAnnotated = false;
     return 0;
 }
@@ -185,23 +230,101 @@ static int callbackEnum(const char* propertyName, const char* value,
 static int callbackString(const char* propertyName, const char* value,
                           size_t length, void* dataPtr)
 {
-    if ((length > MAX_BEJ_STRING_LEN) ||
-        (strnlen(value, length) != (length - 1)))
+    struct BejJsonParam* params =
+        reinterpret_cast<struct BejJsonParam*>(dataPtr);
+    if ((length == 0) || (length > params->maxStringLength) ||
+        (value[length - 1] != '\0'))
     {
         fprintf(stderr,
-                "Incorrect BEJ string length %zu or it exceeds maximum %u.\n",
-                (length - 1), MAX_BEJ_STRING_LEN);
+                "Incorrect BEJ string length %zu or it exceeds maximum %zu.\n",
+                length, params->maxStringLength);
         return bejErrorInvalidSize;
     }
+    addPropertyNameToOutput(params, propertyName);
+    // Also finds any NULL character before the end of the string.
+    RETURN_IF_IERROR(appendJsonString(*params->output,
+                                      std::string_view(value, length - 1)));
+    *params->isPrevAnnotated = false;
+    return 0;
+}
+
+/**
+ * @brief Callback for the start of a bejString passed in fragments.
+ *
+ * @param[in] propertyName - a NULL terminated string.
+ * @param[in] length - length of the string including the NULL terminator.
+ * @param[in] dataPtr - pointing to a valid BejJsonParam struct.
+ * @return 0 if successful.
+ */
+static int callbackStringBegin(const char* propertyName, size_t length,
+                               void* dataPtr)
+{
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
+    if ((length == 0) || (length > params->maxStringLength))
+    {
+        fprintf(stderr,
+                "Incorrect BEJ string length %zu or it exceeds maximum %zu.\n",
+                length, params->maxStringLength);
+        return bejErrorInvalidSize;
+    }
     addPropertyNameToOutput(params, propertyName);
-    params->output->push_back('\"');
-    if (length > 0)
+    params->stringWriter.begin(*params->output);
+    params->stringRemaining = length;
+    return 0;
+}
+
+/**
+ * @brief Callback for a fragment of a bejString.
+ *
+ * @param[in] fragment - next bytes of the string.
+ * @param[in] length - number of bytes.
+ * @param[in] dataPtr - pointing to a valid BejJsonParam struct.
+ * @return 0 if successful.
+ */
+static int callbackStringFragment(const char* fragment, size_t length,
+                                  void* dataPtr)
+{
+    struct BejJsonParam* params =
+        reinterpret_cast<struct BejJsonParam*>(dataPtr);
+    if (length > params->stringRemaining)
     {
-        params->output->append(value, length - 1);
+        fprintf(stderr, "BEJ string fragment is too long: %zu\n", length);
+        return bejErrorInvalidSize;
     }
-    params->output->push_back('\"');
+    params->stringRemaining -= length;
+    if (params->stringRemaining == 0)
+    {
+        // Drop the NULL terminator.
+        if (length == 0 || fragment[length - 1] != '\0')
+        {
+            fprintf(stderr, "BEJ string is not NULL terminated\n");
+            return bejErrorInvalidSize;
+        }
+        --length;
+    }
+    RETURN_IF_IERROR(params->stringWriter.append(
+        *params->output, std::string_view(fragment, length)));
+    // A large string doesn't have to stay in the output until it ends.
+    return flushOutput(params, params->flushSize);
+}
+
+/**
+ * @brief Callback for the end of a bejString passed in fragments.
+ *
+ * @param[in] dataPtr - pointing to a valid BejJsonParam struct.
+ * @return 0 if successful.
+ */
+static int callbackStringEnd(void* dataPtr)
+{
+    struct BejJsonParam* params =
+        reinterpret_cast<struct BejJsonParam*>(dataPtr);
+    if (params->stringRemaining != 0)
+    {
+        fprintf(stderr, "BEJ string ended early\n");
+        return bejErrorInvalidSize;
+    }
+    RETURN_IF_IERROR(params->stringWriter.end(*params->output));
     *params->isPrevAnnotated = false;
     return 0;
 }
@@ -221,21 +344,13 @@ static int callbackReal(const char* propertyName, const struct BejReal* value,
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
 
     // Sanity check for zeroCount
-    if (value->zeroCount > 100)
+    if (value->zeroCount > maxJsonRealZeroCount)
     {
         return bejErrorInvalidSize;
     }
 
     addPropertyNameToOutput(params, propertyName);
-    params->output->append(std::to_string(value->whole));
-    params->output->push_back('.');
-    params->output->insert(params->output->cend(), value->zeroCount, '0');
-    params->output->append(std::to_string(value->fract));
-    if (value->expLen != 0)
-    {
-        params->output->push_back('e');
-        params->output->append(std::to_string(value->exp));
-    }
+    appendJsonReal(*params->output, *value);
     *params->isPrevAnnotated = false;
     return 0;
 }
@@ -269,8 +384,17 @@ static int callbackAnnotation(const char* propertyName, void* dataPtr)
 {
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
-    params->output->push_back('\"');
-    params->output->append(propertyName);
+    std::string_view key = findKey(params, propertyName);
+    if (!key.empty())
+    {
+        // Leave out the closing quote and the colon.
+        params->output->append(key.substr(0, key.size() - 2));
+    }
+    else
+    {
+        params->output->push_back('\"');
+        params->output->append(propertyName);
+    }
 
     // bejPropertyAnnotation type has the form "Status@Message.ExtendedInfo".
     // First the decoder will see "Status" part of the annotated property. This
@@ -300,11 +424,61 @@ static int callbackResourceLink(const char* propertyName, uint64_t linkId,
     struct BejJsonParam* params =
         reinterpret_cast<struct BejJsonParam*>(dataPtr);
     addPropertyNameToOutput(params, propertyName);
-    params->output->append(std::format("\"%L{}\"", linkId));
+    params->output->append("\"%L");
+    appendJsonInteger(*params->output, linkId);
+    params->output->push_back('\"');
+    *params->isPrevAnnotated = false;
+    return 0;
+}
+
+/**
+ * @brief Callback for bejBytestring type.
+ *
+ * @param[in] propertyName - a NULL terminated string.
+ * @param[in] value - bytes of the value.
+ * @param[in] length - number of bytes.
+ * @param[in] dataPtr - pointing to a valid BejJsonParam struct.
+ * @return 0 if successful.
+ */
+static int callbackBytestring(const char* propertyName, const uint8_t* value,
+                              size_t length, void* dataPtr)
+{
+    struct BejJsonParam* params =
+        reinterpret_cast<struct BejJsonParam*>(dataPtr);
+    addPropertyNameToOutput(params, propertyName);
+    // JSON has no binary type. Redfish uses base64 strings for binary data.
+    params->output->push_back('\"');
+    appendBase64(*params->output, std::span(value, length));
+    params->output->push_back('\"');
     *params->isPrevAnnotated = false;
     return 0;
 }
 
+static const struct BejDecodedCallback jsonDecodedCallback = {
+    .callbackSetStart = callbackSetStart,
+    .callbackSetEnd = callbackSetEnd,
+    .callbackArrayStart = callbackArrayStart,
+    .callbackArrayEnd = callbackArrayEnd,
+    .callbackPropertyEnd = callbackPropertyEnd,
+    .callbackNull = callbackNull,
+    .callbackInteger = callbackInteger,
+    .callbackEnum = callbackEnum,
+    .callbackString = callbackString,
+    .callbackReal = callbackReal,
+    .callbackBool = callbackBool,
+    .callbackAnnotation = callbackAnnotation,
+    .callbackResourceLink = callbackResourceLink,
+    .callbackReadonlyPropertyAndTopLevelAnnotation = nullptr,
+};
+
+static const struct BejDecodedCallbackExtensions jsonCallbackExtensions = {
+    .callbackBytestring = callbackBytestring,
+    .callbackStringBegin = callbackStringBegin,
+    .callbackStringFragment = callbackStringFragment,
+    .callbackStringEnd = callbackStringEnd,
+    .callbackPropertyId = nullptr,
+};
+
 /**
  * @brief Callback for stackEmpty.
  *
@@ -367,59 +541,254 @@ static int stackPush(const struct BejStackProperty* const property,
     return 0;
 }
 
+static const struct BejStackCallback jsonStackCallback = {
+    .stackEmpty = stackEmpty,
+    .stackPeek = stackPeek,
+    .stackPop = stackPop,
+    .stackPush = stackPush,
+};
+
+BejJsonOutputSink makeFdOutputSink(int fd)
+{
+    return [fd](std::string_view data) {
+        while (!data.empty())
+        {
+            ssize_t written = ::write(fd, data.data(), data.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                fprintf(stderr, "Failed to write the JSON output: %s\n",
+                        strerror(errno));
+                return static_cast<int>(bejErrorUnknown);
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        return 0;
+    };
+}
+
+BejJsonParam BejDecoderJson::makeCallbackData()
+{
+    output.clear();
+    isPrevAnnotated = false;
+    if (sink)
+    {
+        // The output is flushed after the property that crosses flushSize.
+        output.reserve(sinkFlushSize + sinkFlushSize / 2);
+    }
+    return BejJsonParam{
+        .isPrevAnnotated = &isPrevAnnotated,
+        .output = &output,
+        .sink = sink ? &sink : nullptr,
+        .flushSize = sinkFlushSize,
+        .schemaKeys = schemaKeys,
+        .annotationKeys = annotationKeys,
+        .maxStringLength = maxStringLength,
+        .stringWriter = {},
+        .stringRemaining = 0,
+    };
+}
+
+int BejDecoderJson::finishOutput(int ret)
+{
+    if (ret != 0 || !sink)
+    {
+        return ret;
+    }
+    BejJsonParam callbackData = {
+        .isPrevAnnotated = &isPrevAnnotated,
+        .output = &output,
+        .sink = &sink,
+        .flushSize = sinkFlushSize,
+        .schemaKeys = schemaKeys,
+        .annotationKeys = annotationKeys,
+        .maxStringLength = maxStringLength,
+        .stringWriter = {},
+        .stringRemaining = 0,
+    };
+    return flushOutput(&callbackData, 0);
+}
+
+BejStackStorage* BejDecoderJson::resetStack(BejStackStorage& storage)
+{
+    stack.clear();
+    if (fixedStack.empty())
+    {
+        return nullptr;
+    }
+    storage = {
+        .entries = fixedStack.data(),
+        .capacity = static_cast<uint32_t>(fixedStack.size()),
+        .size = 0,
+    };
+    return &storage;
+}
+
 int BejDecoderJson::decode(const BejDictionaries& dictionaries,
                            const std::span<const uint8_t> encodedPldmBlock)
 {
-    // Clear the previous output if any.
+    return decodePldmBlock(&dictionaries, nullptr, nullptr, nullptr,
+                           encodedPldmBlock);
+}
+
+int BejDecoderJson::decode(const BejDictionaries& dictionaries,
+                           const std::span<const uint8_t> encodedPldmBlock,
+                           const BejProjection& projection)
+{
+    return decodePldmBlock(&dictionaries, nullptr, nullptr, &projection,
+                           encodedPldmBlock);
+}
+
+int BejDecoderJson::decodePrepared(
+    const BejDictionaryIndexes& preparedDictionaries,
+    const std::span<const uint8_t> encodedPldmBlock)
+{
+    return decodePldmBlock(nullptr, &preparedDictionaries, nullptr, nullptr,
+                           encodedPldmBlock);
+}
+
+int BejDecoderJson::decodePath(const BejDictionaries& dictionaries,
+                               const BejPath& path,
+                               const std::span<const uint8_t> encodedPldmBlock)
+{
+    return decodePldmBlock(&dictionaries, nullptr, &path, nullptr,
+                           encodedPldmBlock);
+}
+
+int BejDecoderJson::decodePath(const BejDictionaries& dictionaries,
+                               const std::string& path,
+                               const std::span<const uint8_t> encodedPldmBlock)
+{
     output.clear();
+    BejPath resolvedPath;
+    RETURN_IF_IERROR(
+        bejPathResolve(&dictionaries, path.c_str(), &resolvedPath));
+    return decodePath(dictionaries, resolvedPath, encodedPldmBlock);
+}
 
+int BejDecoderJson::decodePldmBlock(
+    const BejDictionaries* dictionaries,
+    const BejDictionaryIndexes* preparedDictionaries, const BejPath* path,
+    const BejProjection* projection,
+    const std::span<const uint8_t> encodedPldmBlock)
+{
     // The dictionaries have to be traversed in a depth first manner. This is
     // using a stack to implement it non-recursively. Going into a set or an
     // array or a property annotation section means that we have to jump to the
     // child dictionary offset start point but needs to retrieve the parent
     // dictionary offset start once all the children are processed. This stack
     // will hold the parent dictionary offsets and endings for each section.
-    stack.clear();
+    struct BejStackStorage stackStorage;
 
-    struct BejStackCallback stackCallback = {
-        .stackEmpty = stackEmpty,
-        .stackPeek = stackPeek,
-        .stackPop = stackPop,
-        .stackPush = stackPush,
-    };
+    // Clears the previous output if any.
+    struct BejJsonParam callbackData = makeCallbackData();
 
-    struct BejDecodedCallback decodedCallback = {
-        .callbackSetStart = callbackSetStart,
-        .callbackSetEnd = callbackSetEnd,
-        .callbackArrayStart = callbackArrayStart,
-        .callbackArrayEnd = callbackArrayEnd,
-        .callbackPropertyEnd = callbackPropertyEnd,
-        .callbackNull = callbackNull,
-        .callbackInteger = callbackInteger,
-        .callbackEnum = callbackEnum,
-        .callbackString = callbackString,
-        .callbackReal = callbackReal,
-        .callbackBool = callbackBool,
-        .callbackAnnotation = callbackAnnotation,
-        .callbackResourceLink = callbackResourceLink,
-        .callbackReadonlyPropertyAndTopLevelAnnotation = nullptr,
+    struct BejDecoderOptions options = {
+        .trailingPolicy = trailingPolicy,
+        .dictionaryIndexes = dictionaryIndexes,
+        .stackStorage = resetStack(stackStorage),
+        .projection = projection,
+        .callbackExtensions = &jsonCallbackExtensions,
     };
 
-    isPrevAnnotated = false;
-    struct BejJsonParam callbackData = {
-        .isPrevAnnotated = &isPrevAnnotated,
-        .output = &output,
+    int ret;
+    if (preparedDictionaries != nullptr)
+    {
+        ret = bejDecodePldmBlockPrepared(
+            preparedDictionaries, encodedPldmBlock.data(),
+            encodedPldmBlock.size_bytes(), &jsonStackCallback,
+            &jsonDecodedCallback, (void*)(&callbackData), (void*)(&stack),
+            &options);
+    }
+    else if (path != nullptr)
+    {
+        ret = bejDecodePldmBlockPath(
+            dictionaries, path, encodedPldmBlock.data(),
+            encodedPldmBlock.size_bytes(), &jsonStackCallback,
+            &jsonDecodedCallback, (void*)(&callbackData), (void*)(&stack),
+            &options);
+    }
+    else
+    {
+        ret = bejDecodePldmBlockWithOptions(
+            dictionaries, encodedPldmBlock.data(),
+            encodedPldmBlock.size_bytes(), &jsonStackCallback,
+            &jsonDecodedCallback, (void*)(&callbackData), (void*)(&stack),
+            &options);
+    }
+    return finishOutput(ret);
+}
+
+int BejDecoderJson::decodeSegments(
+    const BejDictionaries& dictionaries,
+    const std::span<const std::span<const uint8_t>> segments)
+{
+    RETURN_IF_IERROR(decodeBegin(dictionaries));
+    for (const std::span<const uint8_t>& segment : segments)
+    {
+        RETURN_IF_IERROR(decodeChunk(segment));
+    }
+    return decodeEnd();
+}
+
+int BejDecoderJson::decodeBegin(const BejDictionaries& dictionaries,
+                                uint32_t maxSplitTupleSize)
+{
+    chunkCallbackData = makeCallbackData();
+    chunkBuffer.resize(maxSplitTupleSize);
+
+    struct BejDecoderOptions options = {
+        .trailingPolicy = trailingPolicy,
+        .dictionaryIndexes = dictionaryIndexes,
+        .stackStorage = resetStack(chunkStackStorage),
+        .projection = nullptr,
+        .callbackExtensions = &jsonCallbackExtensions,
     };
+    return bejIncrementalDecoderInit(
+        &incrementalDecoder, &dictionaries, &jsonStackCallback,
+        &jsonDecodedCallback, (void*)(&chunkCallbackData), (void*)(&stack),
+        chunkBuffer.data(), static_cast<uint32_t>(chunkBuffer.size()),
+        &options);
+}
+
+int BejDecoderJson::decodeChunk(const std::span<const uint8_t> chunk)
+{
+    return bejIncrementalDecoderFeed(&incrementalDecoder, chunk.data(),
+                                     chunk.size_bytes());
+}
 
-    return bejDecodePldmBlockWithPolicy(
-        &dictionaries, encodedPldmBlock.data(), encodedPldmBlock.size_bytes(),
-        &stackCallback, &decodedCallback, (void*)(&callbackData),
-        (void*)(&stack), trailingPolicy);
+/**
+ * @brief Check whether the deadline of a budgeted decode has passed.
+ */
+static bool deadlineReached(void* dataPtr)
+{
+    return std::chrono::steady_clock::now() >=
+           *reinterpret_cast<std::chrono::steady_clock::time_point*>(dataPtr);
+}
+
+int BejDecoderJson::decodeChunk(const std::span<const uint8_t> chunk,
+                                uint32_t maxTuples,
+                                std::chrono::steady_clock::time_point deadline,
+                                size_t& consumed)
+{
+    BejDecodeBudget budget = {
+        .maxTuples = maxTuples,
+        .yield = deadlineReached,
+        .dataPtr = (void*)(&deadline),
+    };
+    uint32_t used = 0;
+    int ret = bejIncrementalDecoderFeedBudgeted(
+        &incrementalDecoder, chunk.data(), chunk.size_bytes(), &budget, &used);
+    consumed = used;
+    return ret;
 }
 
-std::string BejDecoderJson::getOutput()
+int BejDecoderJson::decodeEnd()
 {
-    return output;
+    return finishOutput(bejIncrementalDecoderFinish(&incrementalDecoder));
 }
 
 } // namespace libbej
@@ -62,9 +62,9 @@ static bool bejValidatePropertyOffset(const uint8_t* dictionary,
     return true;
 }
 
-static bool bejValidatePropertyNameLength(
-    const uint8_t* dictionary, uint32_t dictionarySize, uint16_t nameOffset,
-    uint8_t nameLength)
+bool bejDictValidatePropertyName(const uint8_t* dictionary,
+                                 uint32_t dictionarySize, uint16_t nameOffset,
+                                 uint8_t nameLength)
 {
     if (nameLength == 0)
     {
@@ -128,9 +128,9 @@ int bejDictGetProperty(const uint8_t* dictionary,
             (const struct BejDictionaryProperty*)(dictionary + propertyOffset);
         if (p->sequenceNumber == sequenceNumber)
         {
-            if (!bejValidatePropertyNameLength(dictionary,
-                                               header->dictionarySize,
-                                               p->nameOffset, p->nameLength))
+            if (!bejDictValidatePropertyName(dictionary,
+                                             header->dictionarySize,
+                                             p->nameOffset, p->nameLength))
             {
                 return bejErrorInvalidSize;
             }
@@ -191,3 +191,62 @@ int bejDictGetPropertyByName(
     }
     return bejErrorUnknownProperty;
 }
+
+int bejDictValidate(const uint8_t* dictionary, uint32_t dictionarySize)
+{
+    NULL_CHECK(dictionary, "dictionary");
+
+    if (dictionarySize < sizeof(struct BejDictionaryHeader))
+    {
+        fprintf(stderr, "Dictionary is too small: %u\n", dictionarySize);
+        return bejErrorInvalidSize;
+    }
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)dictionary;
+    if (header->dictionarySize != dictionarySize)
+    {
+        fprintf(stderr, "Invalid dictionary size: %u. Expected: %u.\n",
+                header->dictionarySize, dictionarySize);
+        return bejErrorInvalidSize;
+    }
+    // Property table is followed by at least the uint8 CopyrightLength field.
+    uint32_t propertiesEnd =
+        bejDictGetPropertyHeadOffset() +
+        (uint32_t)header->entryCount * sizeof(struct BejDictionaryProperty);
+    if (propertiesEnd >= dictionarySize)
+    {
+        fprintf(stderr, "Dictionary properties go beyond dictionary size\n");
+        return bejErrorInvalidSize;
+    }
+
+    uint16_t propertyOffset = bejDictGetPropertyHeadOffset();
+    for (uint16_t index = 0; index < header->entryCount; ++index)
+    {
+        const struct BejDictionaryProperty* p =
+            (const struct BejDictionaryProperty*)(dictionary + propertyOffset);
+        if (!bejDictValidatePropertyName(dictionary, dictionarySize,
+                                         p->nameOffset, p->nameLength))
+        {
+            return bejErrorInvalidSize;
+        }
+        if (p->childCount != 0)
+        {
+            if (!bejValidatePropertyOffset(dictionary, p->childPointerOffset))
+            {
+                return bejErrorInvalidPropertyOffset;
+            }
+            if ((uint32_t)bejGetPropertyEntryIndex(p->childPointerOffset) +
+                    p->childCount >
+                header->entryCount)
+            {
+                fprintf(stderr,
+                        "Child range of property %u falls outside of "
+                        "dictionary properties\n",
+                        propertyOffset);
+                return bejErrorInvalidPropertyOffset;
+            }
+        }
+        propertyOffset += sizeof(struct BejDictionaryProperty);
+    }
+    return 0;
+}
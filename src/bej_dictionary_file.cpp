@@ -0,0 +1,354 @@
+#include "bej_dictionary_file.hpp"
+
+#include "bej_dictionary.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+namespace libbej
+{
+
+/**
+ * @brief Get the identity of a file from its status.
+ *
+ * @param[in] fileStat - status of the file.
+ * @return identity of the file.
+ */
+static BejDictionaryFileIdentity fileIdentityOf(const struct stat& fileStat)
+{
+    constexpr int64_t nsPerSecond = 1000000000;
+    return {
+        .device = static_cast<uint64_t>(fileStat.st_dev),
+        .inode = static_cast<uint64_t>(fileStat.st_ino),
+        .mtimeNs = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * nsPerSecond +
+                   fileStat.st_mtim.tv_nsec,
+        .ctimeNs = static_cast<int64_t>(fileStat.st_ctim.tv_sec) * nsPerSecond +
+                   fileStat.st_ctim.tv_nsec,
+    };
+}
+
+/**
+ * @brief Map a whole file read-only.
+ *
+ * @param[in] path - path to the file.
+ * @param[out] size - size of the file.
+ * @param[out] identity - if not nullptr, identity of the mapped file.
+ * @return the mapped memory or nullptr on failure.
+ */
+static const uint8_t* mapFile(const std::string& path, size_t& size,
+                              BejDictionaryFileIdentity* identity = nullptr)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    if (identity != nullptr)
+    {
+        *identity = fileIdentityOf(fileStat);
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing the file.
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    return static_cast<const uint8_t*>(mapped);
+}
+
+/**
+ * @brief Write a buffer to a file descriptor.
+ *
+ * @return true if the whole buffer is written.
+ */
+static bool writeAll(int fd, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Check that the range tables of a sidecar stay within the sidecar.
+ *
+ * @param[in] rangeSlots - range slots of the sidecar.
+ * @param[in] tables - range tables of the sidecar.
+ * @param[in] header - header of the sidecar.
+ * @return true if every range table is within bounds.
+ */
+static bool validateSidecarTables(const uint32_t* rangeSlots,
+                                  const uint16_t* tables,
+                                  const BejDictionaryIndexFileHeader& header)
+{
+    for (uint16_t i = 0; i < header.entryCount; ++i)
+    {
+        uint32_t position = rangeSlots[i];
+        if (position == BEJ_DICT_INDEX_NO_TABLE)
+        {
+            continue;
+        }
+        if (position >= header.tablesLength || tables[position] == 0 ||
+            tables[position] > 16)
+        {
+            return false;
+        }
+        uint64_t tableLength = 1 + 2 * (uint64_t(1) << tables[position]);
+        if (position + tableLength > header.tablesLength)
+        {
+            return false;
+        }
+        for (uint64_t entry = 1; entry < tableLength; ++entry)
+        {
+            uint16_t entryIndex = tables[position + entry];
+            if (entryIndex != BEJ_DICT_INDEX_EMPTY_ENTRY &&
+                entryIndex >= header.entryCount)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<MappedDictionary>
+    MappedDictionary::open(const std::string& dictionaryPath,
+                           const std::string& indexPath)
+{
+    std::unique_ptr<MappedDictionary> mapped(new MappedDictionary());
+    mapped->dictionary = mapFile(dictionaryPath, mapped->dictionarySize,
+                                 &mapped->fileIdentity);
+    if (mapped->dictionary == nullptr ||
+        mapped->dictionarySize > UINT32_MAX ||
+        mapped->dictionarySize < sizeof(BejDictionaryHeader))
+    {
+        return nullptr;
+    }
+
+    // A matching sidecar was written after validating this very file, so
+    // the dictionary is not validated again.
+    if (!indexPath.empty() && mapped->attachIndex(indexPath))
+    {
+        return mapped;
+    }
+    if (bejDictValidate(mapped->dictionary, mapped->dictionarySize) != 0)
+    {
+        return nullptr;
+    }
+
+    mapped->indexBuffer.resize(
+        bejDictIndexGetBufferSize(mapped->dictionary, mapped->dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    if (bejDictPrepare(mapped->dictionary, mapped->dictionarySize,
+                       mapped->indexBuffer.data(),
+                       mapped->indexBuffer.size() * sizeof(uint32_t),
+                       &mapped->dictionaryIndex) != 0)
+    {
+        return nullptr;
+    }
+    if (!indexPath.empty() && !mapped->writeIndex(indexPath))
+    {
+        // The sidecar only speeds up the next start. Keep going without it.
+        fprintf(stderr, "Failed to write dictionary index: %s\n",
+                indexPath.c_str());
+    }
+    return mapped;
+}
+
+MappedDictionary::~MappedDictionary()
+{
+    if (dictionary != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(dictionary), dictionarySize);
+    }
+    if (sidecar != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(sidecar), sidecarSize);
+    }
+}
+
+bool MappedDictionary::attachIndex(const std::string& indexPath)
+{
+    size_t size = 0;
+    const uint8_t* mappedSidecar = mapFile(indexPath, size);
+    if (mappedSidecar == nullptr)
+    {
+        return false;
+    }
+
+    if (size < sizeof(BejDictionaryIndexFileHeader))
+    {
+        munmap(const_cast<uint8_t*>(mappedSidecar), size);
+        return false;
+    }
+
+    const BejDictionaryHeader* dictionaryHeader =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary);
+    const BejDictionaryIndexFileHeader* header =
+        reinterpret_cast<const BejDictionaryIndexFileHeader*>(mappedSidecar);
+    const uint32_t* rangeSlots = reinterpret_cast<const uint32_t*>(
+        mappedSidecar + sizeof(BejDictionaryIndexFileHeader));
+    const uint16_t* tables =
+        reinterpret_cast<const uint16_t*>(rangeSlots + header->entryCount);
+    // A stale or foreign sidecar is ignored and rebuilt. Only the file status
+    // and the dictionary header are compared, the content is not read.
+    if (header->magic != bejDictionaryIndexFileMagic ||
+        header->version != bejDictionaryIndexFileVersion ||
+        header->file.device != fileIdentity.device ||
+        header->file.inode != fileIdentity.inode ||
+        header->file.mtimeNs != fileIdentity.mtimeNs ||
+        header->file.ctimeNs != fileIdentity.ctimeNs ||
+        header->dictionarySize != dictionarySize ||
+        header->dictionarySize != dictionaryHeader->dictionarySize ||
+        header->entryCount != dictionaryHeader->entryCount ||
+        header->versionTag != dictionaryHeader->versionTag ||
+        header->schemaVersion != dictionaryHeader->schemaVersion ||
+        size != sizeof(BejDictionaryIndexFileHeader) +
+                    header->entryCount * sizeof(uint32_t) +
+                    header->tablesLength * sizeof(uint16_t) ||
+        !validateSidecarTables(rangeSlots, tables, *header))
+    {
+        munmap(const_cast<uint8_t*>(mappedSidecar), size);
+        return false;
+    }
+
+    sidecar = mappedSidecar;
+    sidecarSize = size;
+    dictionaryIndex.dictionary = dictionary;
+    dictionaryIndex.entryCount = header->entryCount;
+    dictionaryIndex.rangeSlots = rangeSlots;
+    dictionaryIndex.tables = tables;
+    dictionaryIndex.tablesLength = header->tablesLength;
+    // The sidecar was written from a prepared index of this dictionary.
+    dictionaryIndex.validatedSize = header->validatedSize;
+    dictionaryIndex.preparedSeal = header->preparedSeal;
+    if (!bejDictIndexIsPrepared(&dictionaryIndex))
+    {
+        dictionaryIndex = {};
+        sidecar = nullptr;
+        sidecarSize = 0;
+        munmap(const_cast<uint8_t*>(mappedSidecar), size);
+        return false;
+    }
+    return true;
+}
+
+bool MappedDictionary::writeIndex(const std::string& indexPath) const
+{
+    BejDictionaryIndexFileHeader header = {
+        .magic = bejDictionaryIndexFileMagic,
+        .version = bejDictionaryIndexFileVersion,
+        .file = fileIdentity,
+        .dictionarySize = static_cast<uint32_t>(dictionarySize),
+        .entryCount = dictionaryIndex.entryCount,
+        .versionTag =
+            reinterpret_cast<const BejDictionaryHeader*>(dictionary)
+                ->versionTag,
+        .reserved = 0,
+        .schemaVersion =
+            reinterpret_cast<const BejDictionaryHeader*>(dictionary)
+                ->schemaVersion,
+        .tablesLength = dictionaryIndex.tablesLength,
+        .validatedSize = dictionaryIndex.validatedSize,
+        .preparedSeal = dictionaryIndex.preparedSeal,
+        .reserved2 = 0,
+    };
+
+    // Several processes might write the same sidecar. Each one uses its own
+    // temporary file and the last rename wins.
+    std::string tmpPath = indexPath + ".tmp." + std::to_string(getpid());
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool success =
+        writeAll(fd, &header, sizeof(header)) &&
+        writeAll(fd, dictionaryIndex.rangeSlots,
+                 dictionaryIndex.entryCount * sizeof(uint32_t)) &&
+        writeAll(fd, dictionaryIndex.tables,
+                 dictionaryIndex.tablesLength * sizeof(uint16_t)) &&
+        fsync(fd) == 0;
+    success = (close(fd) == 0) && success;
+    if (!success || rename(tmpPath.c_str(), indexPath.c_str()) != 0)
+    {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<MappedDictionaries> MappedDictionaries::open(
+    const std::string& schemaPath, const std::string& annotationPath,
+    const std::string& errorPath, const std::string& indexSuffix)
+{
+    auto sidecarPath = [&indexSuffix](const std::string& path) {
+        return indexSuffix.empty() ? std::string() : path + indexSuffix;
+    };
+
+    std::unique_ptr<MappedDictionaries> mapped(new MappedDictionaries());
+    mapped->schema =
+        MappedDictionary::open(schemaPath, sidecarPath(schemaPath));
+    mapped->annotation =
+        MappedDictionary::open(annotationPath, sidecarPath(annotationPath));
+    if (mapped->schema == nullptr || mapped->annotation == nullptr)
+    {
+        return nullptr;
+    }
+    if (!errorPath.empty())
+    {
+        mapped->error =
+            MappedDictionary::open(errorPath, sidecarPath(errorPath));
+        if (mapped->error == nullptr)
+        {
+            return nullptr;
+        }
+    }
+
+    mapped->bejDictionaries = {
+        .schemaDictionary = mapped->schema->data().data(),
+        .schemaDictionarySize =
+            static_cast<uint32_t>(mapped->schema->data().size()),
+        .annotationDictionary = mapped->annotation->data().data(),
+        .annotationDictionarySize =
+            static_cast<uint32_t>(mapped->annotation->data().size()),
+        .errorDictionary = nullptr,
+        .errorDictionarySize = 0,
+    };
+    if (mapped->error != nullptr)
+    {
+        mapped->bejDictionaries.errorDictionary =
+            mapped->error->data().data();
+        mapped->bejDictionaries.errorDictionarySize =
+            static_cast<uint32_t>(mapped->error->data().size());
+    }
+    mapped->bejIndexes = {
+        .schemaIndex = mapped->schema->index(),
+        .annotationIndex = mapped->annotation->index(),
+    };
+    return mapped;
+}
+
+} // namespace libbej
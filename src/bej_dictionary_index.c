@@ -0,0 +1,605 @@
+#include "bej_dictionary_index.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Get a property using its index within the dictionary.
+ *
+ * @param[in] dictionary - a valid dictionary.
+ * @param[in] entryIndex - index of the property. First property is at index 0.
+ * @return pointer to the property.
+ */
+static const struct BejDictionaryProperty* bejDictIndexGetEntry(
+    const uint8_t* dictionary, uint16_t entryIndex)
+{
+    size_t offset = bejDictGetPropertyHeadOffset() +
+                    (size_t)entryIndex * sizeof(struct BejDictionaryProperty);
+    return (const struct BejDictionaryProperty*)(dictionary + offset);
+}
+
+/**
+ * @brief Hash a property name using 32bit FNV-1a.
+ *
+ * @param[in] name - a NULL terminated string.
+ * @return hash of the name.
+ */
+static uint32_t bejDictIndexHashName(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    while (*name != '\0')
+    {
+        hash ^= (uint8_t)(*name++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Get the name of a property using its index within the dictionary.
+ *
+ * @param[in] dictionary - a valid dictionary.
+ * @param[in] entryIndex - index of the property.
+ * @return a NULL terminated string.
+ */
+static const char* bejDictIndexGetEntryName(const uint8_t* dictionary,
+                                            uint16_t entryIndex)
+{
+    const struct BejDictionaryProperty* p =
+        bejDictIndexGetEntry(dictionary, entryIndex);
+    return bejDictGetPropertyName(dictionary, p->nameOffset, p->nameLength);
+}
+
+/**
+ * @brief Get log2 of the range table capacity needed for a child range.
+ *
+ * Capacity is the smallest power of two that is at least twice the child
+ * count. This keeps the tables at most half full.
+ *
+ * @param[in] childCount - number of children in the range.
+ * @return log2 of the table capacity.
+ */
+static uint16_t bejDictIndexCapacityShift(uint16_t childCount)
+{
+    uint16_t shift = 1;
+    while (((uint32_t)1 << shift) < 2 * (uint32_t)childCount)
+    {
+        ++shift;
+    }
+    return shift;
+}
+
+/**
+ * @brief Get the number of uint16_t elements needed for a range table.
+ *
+ * @param[in] childCount - number of children in the range.
+ * @return number of uint16_t elements.
+ */
+static uint32_t bejDictIndexRangeTableLength(uint16_t childCount)
+{
+    // log2 of the capacity followed by the sequence number table and the
+    // name table.
+    return 1 + 2 * ((uint32_t)1 << bejDictIndexCapacityShift(childCount));
+}
+
+/**
+ * @brief Check whether a child range falls inside the dictionary.
+ *
+ * @param[in] header - dictionary header.
+ * @param[in] property - property owning the child range.
+ * @param[out] startIndex - index of the first child.
+ * @return true if the child range is valid and not empty.
+ */
+static bool bejDictIndexGetChildRange(
+    const struct BejDictionaryHeader* header,
+    const struct BejDictionaryProperty* property, uint16_t* startIndex)
+{
+    if (property->childCount == 0 ||
+        property->childPointerOffset < bejDictGetPropertyHeadOffset())
+    {
+        return false;
+    }
+    uint16_t relativeOffset =
+        property->childPointerOffset - bejDictGetPropertyHeadOffset();
+    if (relativeOffset % sizeof(struct BejDictionaryProperty))
+    {
+        return false;
+    }
+    *startIndex = relativeOffset / sizeof(struct BejDictionaryProperty);
+    return (uint32_t)(*startIndex) + property->childCount <= header->entryCount;
+}
+
+/**
+ * @brief Check that the header and the property table fit in the dictionary
+ * buffer.
+ *
+ * @param[in] dictionary - dictionary to check.
+ * @param[in] dictionarySize - size of the dictionary buffer in bytes.
+ * @return true if every property can be read.
+ */
+static bool bejDictIndexCheckSize(const uint8_t* dictionary,
+                                  uint32_t dictionarySize)
+{
+    if (dictionary == NULL ||
+        dictionarySize < sizeof(struct BejDictionaryHeader))
+    {
+        fprintf(stderr, "Dictionary is too small: %u\n", dictionarySize);
+        return false;
+    }
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)dictionary;
+    uint32_t propertiesEnd =
+        bejDictGetPropertyHeadOffset() +
+        (uint32_t)header->entryCount * sizeof(struct BejDictionaryProperty);
+    if (propertiesEnd > dictionarySize)
+    {
+        fprintf(stderr, "Dictionary properties go beyond dictionary size\n");
+        return false;
+    }
+    return true;
+}
+
+size_t bejDictIndexGetBufferSize(const uint8_t* dictionary,
+                                 uint32_t dictionarySize)
+{
+    if (!bejDictIndexCheckSize(dictionary, dictionarySize))
+    {
+        return 0;
+    }
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)dictionary;
+
+    // Child ranges shared by several properties are only indexed once. But
+    // counting them separately gives an upper bound without extra memory. The
+    // first property is the root of the dictionary and is treated as a range
+    // with a single child.
+    size_t tablesLength = bejDictIndexRangeTableLength(1);
+    for (uint16_t index = 0; index < header->entryCount; ++index)
+    {
+        const struct BejDictionaryProperty* p =
+            bejDictIndexGetEntry(dictionary, index);
+        if (p->childCount != 0)
+        {
+            tablesLength += bejDictIndexRangeTableLength(p->childCount);
+        }
+    }
+    return (size_t)header->entryCount * sizeof(uint32_t) +
+           tablesLength * sizeof(uint16_t);
+}
+
+/**
+ * @brief Fill the range table of a child range.
+ *
+ * @param[in] dictionary - a valid dictionary.
+ * @param[in] startIndex - index of the first child.
+ * @param[in] childCount - number of children in the range.
+ * @param[out] table - range table with enough space for the child count.
+ */
+static void bejDictIndexFillRangeTable(const uint8_t* dictionary,
+                                       uint16_t startIndex, uint16_t childCount,
+                                       uint16_t* table)
+{
+    uint16_t shift = bejDictIndexCapacityShift(childCount);
+    uint32_t mask = ((uint32_t)1 << shift) - 1;
+    table[0] = shift;
+    uint16_t* seqTable = table + 1;
+    uint16_t* nameTable = seqTable + mask + 1;
+    for (uint32_t i = 0; i <= mask; ++i)
+    {
+        seqTable[i] = BEJ_DICT_INDEX_EMPTY_ENTRY;
+        nameTable[i] = BEJ_DICT_INDEX_EMPTY_ENTRY;
+    }
+
+    for (uint16_t child = 0; child < childCount; ++child)
+    {
+        uint16_t entryIndex = startIndex + child;
+        uint16_t sequenceNumber =
+            bejDictIndexGetEntry(dictionary, entryIndex)->sequenceNumber;
+        uint32_t slot = sequenceNumber & mask;
+        // Only the first property with a given sequence number is added.
+        // That is the one a linear search would find.
+        while (seqTable[slot] != BEJ_DICT_INDEX_EMPTY_ENTRY &&
+               bejDictIndexGetEntry(dictionary, seqTable[slot])
+                       ->sequenceNumber != sequenceNumber)
+        {
+            slot = (slot + 1) & mask;
+        }
+        if (seqTable[slot] == BEJ_DICT_INDEX_EMPTY_ENTRY)
+        {
+            seqTable[slot] = entryIndex;
+        }
+
+        // Same for the names.
+        const char* name = bejDictIndexGetEntryName(dictionary, entryIndex);
+        slot = bejDictIndexHashName(name) & mask;
+        while (nameTable[slot] != BEJ_DICT_INDEX_EMPTY_ENTRY &&
+               strcmp(bejDictIndexGetEntryName(dictionary, nameTable[slot]),
+                      name) != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        if (nameTable[slot] == BEJ_DICT_INDEX_EMPTY_ENTRY)
+        {
+            nameTable[slot] = entryIndex;
+        }
+    }
+}
+
+int bejDictBuildIndex(const uint8_t* dictionary, uint32_t dictionarySize,
+                      void* buffer, size_t bufferSize,
+                      struct BejDictionaryIndex* index)
+{
+    NULL_CHECK(dictionary, "dictionary");
+    NULL_CHECK(buffer, "buffer");
+    NULL_CHECK(index, "index");
+
+    // Every property is read below. A truncated dictionary or one with a
+    // wrong entry count is rejected before that.
+    if (!bejDictIndexCheckSize(dictionary, dictionarySize))
+    {
+        return bejErrorInvalidSize;
+    }
+    if (bufferSize < bejDictIndexGetBufferSize(dictionary, dictionarySize))
+    {
+        fprintf(stderr, "Dictionary index buffer is too small: %zu\n",
+                bufferSize);
+        return bejErrorInvalidSize;
+    }
+
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)dictionary;
+    // The name tables hash and compare every name. Names found through them
+    // are not checked again.
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        const struct BejDictionaryProperty* p =
+            bejDictIndexGetEntry(dictionary, i);
+        if (!bejDictValidatePropertyName(dictionary, dictionarySize,
+                                         p->nameOffset, p->nameLength))
+        {
+            return bejErrorInvalidSize;
+        }
+    }
+    uint32_t* rangeSlots = buffer;
+    uint16_t* tables = (uint16_t*)(rangeSlots + header->entryCount);
+
+    // First pass: use the range slots to hold the largest child count of a
+    // range starting at each property.
+    memset(rangeSlots, 0, (size_t)header->entryCount * sizeof(uint32_t));
+    if (header->entryCount > 0)
+    {
+        rangeSlots[0] = 1;
+    }
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t startIndex;
+        const struct BejDictionaryProperty* p =
+            bejDictIndexGetEntry(dictionary, i);
+        if (bejDictIndexGetChildRange(header, p, &startIndex) &&
+            p->childCount > rangeSlots[startIndex])
+        {
+            rangeSlots[startIndex] = p->childCount;
+        }
+    }
+
+    // Second pass: build the range tables and replace the child counts with
+    // the table positions.
+    uint32_t tablesLength = 0;
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t childCount = (uint16_t)rangeSlots[i];
+        if (childCount == 0)
+        {
+            rangeSlots[i] = BEJ_DICT_INDEX_NO_TABLE;
+            continue;
+        }
+        bejDictIndexFillRangeTable(dictionary, i, childCount,
+                                   tables + tablesLength);
+        rangeSlots[i] = tablesLength;
+        tablesLength += bejDictIndexRangeTableLength(childCount);
+    }
+
+    index->dictionary = dictionary;
+    index->entryCount = header->entryCount;
+    index->rangeSlots = rangeSlots;
+    index->tables = tables;
+    index->tablesLength = tablesLength;
+    index->validatedSize = 0;
+    index->preparedSeal = 0;
+    return 0;
+}
+
+/**
+ * @brief Compute the seal of a prepared index.
+ *
+ * The seal ties the validated size to the index fields and to the header of
+ * the dictionary. A plain index, or a prepared one changed afterwards, does
+ * not carry a matching seal.
+ *
+ * @param[in] index - index to seal. Its dictionary should be readable.
+ * @return the seal.
+ */
+static uint32_t bejDictIndexComputeSeal(const struct BejDictionaryIndex* index)
+{
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)index->dictionary;
+    uint32_t values[] = {
+        index->validatedSize,  index->entryCount,
+        index->tablesLength,   header->dictionarySize,
+        header->entryCount,    header->versionTag,
+        header->schemaVersion, header->truncationFlag,
+    };
+    // FNV-1a over the values, starting from a library specific basis.
+    uint32_t seal = 0x42454a50u;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            seal ^= (values[i] >> shift) & 0xff;
+            seal *= 16777619u;
+        }
+    }
+    // Never 0, so a zero initialized index is not prepared.
+    return seal | 1;
+}
+
+int bejDictPrepare(const uint8_t* dictionary, uint32_t dictionarySize,
+                   void* buffer, size_t bufferSize,
+                   struct BejDictionaryIndex* index)
+{
+    RETURN_IF_IERROR(bejDictValidate(dictionary, dictionarySize));
+    RETURN_IF_IERROR(bejDictBuildIndex(dictionary, dictionarySize, buffer,
+                                       bufferSize, index));
+    index->validatedSize = dictionarySize;
+    index->preparedSeal = bejDictIndexComputeSeal(index);
+    return 0;
+}
+
+bool bejDictIndexIsPrepared(const struct BejDictionaryIndex* index)
+{
+    return index != NULL && index->dictionary != NULL &&
+           index->validatedSize != 0 &&
+           index->preparedSeal == bejDictIndexComputeSeal(index);
+}
+
+/**
+ * @brief Get the range table of the child range starting at a property.
+ *
+ * @param[in] index - a valid index.
+ * @param[in] startingPropertyOffset - offset of the first property of the
+ * range.
+ * @return the range table or NULL if the range is not indexed.
+ */
+static const uint16_t* bejDictIndexGetRangeTable(
+    const struct BejDictionaryIndex* index, uint16_t startingPropertyOffset)
+{
+    if (startingPropertyOffset < bejDictGetPropertyHeadOffset())
+    {
+        return NULL;
+    }
+    uint16_t relativeOffset =
+        startingPropertyOffset - bejDictGetPropertyHeadOffset();
+    uint16_t startIndex = relativeOffset / sizeof(struct BejDictionaryProperty);
+    if ((relativeOffset % sizeof(struct BejDictionaryProperty)) ||
+        startIndex >= index->entryCount ||
+        index->rangeSlots[startIndex] == BEJ_DICT_INDEX_NO_TABLE)
+    {
+        return NULL;
+    }
+    return index->tables + index->rangeSlots[startIndex];
+}
+
+/**
+ * @brief Get the dictionary offset of a property using its index.
+ *
+ * @param[in] entryIndex - index of the property.
+ * @return offset of the property.
+ */
+static uint16_t bejDictIndexGetEntryOffset(uint16_t entryIndex)
+{
+    return bejDictGetPropertyHeadOffset() +
+           entryIndex * sizeof(struct BejDictionaryProperty);
+}
+
+/**
+ * @brief Find a property in the range table starting at a property.
+ *
+ * @param[in] index - a valid index.
+ * @param[in] startingPropertyOffset - offset of the first property of the
+ * range.
+ * @param[in] sequenceNumber - sequence number of the property.
+ * @param[out] propertyOffset - if found, offset of the property.
+ * @return true if the property is found.
+ */
+static bool bejDictIndexFind(const struct BejDictionaryIndex* index,
+                             uint16_t startingPropertyOffset,
+                             uint16_t sequenceNumber, uint16_t* propertyOffset)
+{
+    const uint16_t* table =
+        bejDictIndexGetRangeTable(index, startingPropertyOffset);
+    if (table == NULL)
+    {
+        return false;
+    }
+    uint32_t mask = ((uint32_t)1 << table[0]) - 1;
+    const uint16_t* seqTable = table + 1;
+    uint32_t slot = sequenceNumber & mask;
+    for (uint32_t probe = 0; probe <= mask; ++probe)
+    {
+        uint16_t entryIndex = seqTable[slot];
+        if (entryIndex == BEJ_DICT_INDEX_EMPTY_ENTRY)
+        {
+            return false;
+        }
+        if (bejDictIndexGetEntry(index->dictionary, entryIndex)
+                ->sequenceNumber == sequenceNumber)
+        {
+            *propertyOffset = bejDictIndexGetEntryOffset(entryIndex);
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+/**
+ * @brief Find a property by name in a range table.
+ *
+ * @param[in] index - a valid index.
+ * @param[in] table - range table of the child range.
+ * @param[in] propertyName - name of the property.
+ * @param[out] propertyOffset - if found, offset of the property.
+ * @return true if the property is found.
+ */
+static bool bejDictIndexFindByName(const struct BejDictionaryIndex* index,
+                                   const uint16_t* table,
+                                   const char* propertyName,
+                                   uint16_t* propertyOffset)
+{
+    uint32_t mask = ((uint32_t)1 << table[0]) - 1;
+    const uint16_t* nameTable = table + 1 + mask + 1;
+    uint32_t slot = bejDictIndexHashName(propertyName) & mask;
+    for (uint32_t probe = 0; probe <= mask; ++probe)
+    {
+        uint16_t entryIndex = nameTable[slot];
+        if (entryIndex == BEJ_DICT_INDEX_EMPTY_ENTRY)
+        {
+            return false;
+        }
+        if (strcmp(bejDictIndexGetEntryName(index->dictionary, entryIndex),
+                   propertyName) == 0)
+        {
+            *propertyOffset = bejDictIndexGetEntryOffset(entryIndex);
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return false;
+}
+
+/**
+ * @brief Linear search for a sequence number in a validated dictionary.
+ *
+ * Same as bejDictGetProperty() without validating the property found.
+ *
+ * @param[in] index - a prepared dictionary.
+ * @param[in] startingPropertyOffset - offset of the starting property for
+ * the search.
+ * @param[in] sequenceNumber - sequence number of the property.
+ * @param[out] property - if the search is successful, this will point to the
+ * property.
+ * @return 0 if successful.
+ */
+static int bejDictIndexLinearSearch(
+    const struct BejDictionaryIndex* index, uint16_t startingPropertyOffset,
+    uint16_t sequenceNumber, const struct BejDictionaryProperty** property)
+{
+    if (startingPropertyOffset < bejDictGetPropertyHeadOffset() ||
+        (startingPropertyOffset - bejDictGetPropertyHeadOffset()) %
+            sizeof(struct BejDictionaryProperty))
+    {
+        fprintf(stderr, "Invalid property offset: %u\n",
+                startingPropertyOffset);
+        return bejErrorInvalidPropertyOffset;
+    }
+    uint16_t startIndex =
+        (startingPropertyOffset - bejDictGetPropertyHeadOffset()) /
+        sizeof(struct BejDictionaryProperty);
+    if (startIndex >= index->entryCount)
+    {
+        fprintf(stderr, "Invalid property offset: %u\n",
+                startingPropertyOffset);
+        return bejErrorInvalidPropertyOffset;
+    }
+    for (uint16_t entryIndex = startIndex; entryIndex < index->entryCount;
+         ++entryIndex)
+    {
+        const struct BejDictionaryProperty* p =
+            bejDictIndexGetEntry(index->dictionary, entryIndex);
+        if (p->sequenceNumber == sequenceNumber)
+        {
+            *property = p;
+            return 0;
+        }
+    }
+    return bejErrorUnknownProperty;
+}
+
+int bejDictIndexGetProperty(const uint8_t* dictionary,
+                            const struct BejDictionaryIndex* index,
+                            uint16_t startingPropertyOffset,
+                            uint16_t sequenceNumber,
+                            const struct BejDictionaryProperty** property)
+{
+    if (index == NULL || index->dictionary != dictionary)
+    {
+        return bejDictGetProperty(dictionary, startingPropertyOffset,
+                                  sequenceNumber, property);
+    }
+
+    uint16_t propertyOffset;
+    if (bejDictIndexFind(index, startingPropertyOffset, sequenceNumber,
+                         &propertyOffset))
+    {
+        // The search will stop at the first property. This will still
+        // validate the property found.
+        return bejDictGetProperty(dictionary, propertyOffset, sequenceNumber,
+                                  property);
+    }
+    // A property outside the child range might still be found by a linear
+    // search. So keep the same behavior as a linear search.
+    return bejDictGetProperty(dictionary, startingPropertyOffset,
+                              sequenceNumber, property);
+}
+
+int bejDictIndexGetPreparedProperty(
+    const uint8_t* dictionary, const struct BejDictionaryIndex* index,
+    uint16_t startingPropertyOffset, uint16_t sequenceNumber,
+    const struct BejDictionaryProperty** property)
+{
+    uint16_t propertyOffset;
+    if (bejDictIndexFind(index, startingPropertyOffset, sequenceNumber,
+                         &propertyOffset))
+    {
+        *property =
+            (const struct BejDictionaryProperty*)(dictionary + propertyOffset);
+        return 0;
+    }
+    return bejDictIndexLinearSearch(index, startingPropertyOffset,
+                                    sequenceNumber, property);
+}
+
+int bejDictIndexGetPropertyByName(
+    const uint8_t* dictionary, const struct BejDictionaryIndex* index,
+    uint16_t startingPropertyOffset, const char* propertyName,
+    const struct BejDictionaryProperty** property, uint16_t* propertyOffset)
+{
+    NULL_CHECK(property, "property in bejDictIndexGetPropertyByName");
+
+    const uint16_t* table = NULL;
+    if (index != NULL && index->dictionary == dictionary)
+    {
+        table = bejDictIndexGetRangeTable(index, startingPropertyOffset);
+    }
+    if (table != NULL)
+    {
+        uint16_t foundOffset;
+        if (!bejDictIndexFindByName(index, table, propertyName, &foundOffset))
+        {
+            // The table holds every name of the child range.
+            return bejErrorUnknownProperty;
+        }
+        // Names were validated while building the index.
+        *property =
+            (const struct BejDictionaryProperty*)(dictionary + foundOffset);
+        // propertyOffset is an optional output.
+        if (propertyOffset != NULL)
+        {
+            *propertyOffset = foundOffset;
+        }
+        return 0;
+    }
+    return bejDictGetPropertyByName(dictionary, startingPropertyOffset,
+                                    propertyName, property, propertyOffset);
+}
@@ -0,0 +1,149 @@
+#include "bej_dictionary_registry.hpp"
+
+#include <algorithm>
+
+namespace libbej
+{
+
+uint64_t dictionaryContentHash(std::span<const uint8_t> dictionary)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : dictionary)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::shared_ptr<const PreparedDictionary>
+    PreparedDictionary::create(std::span<const uint8_t> dictionary,
+                               uint64_t contentHash)
+{
+    if (dictionary.size() < sizeof(BejDictionaryHeader) ||
+        dictionary.size() > UINT32_MAX)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<PreparedDictionary> prepared(new PreparedDictionary());
+    prepared->dictionary.assign(dictionary.begin(), dictionary.end());
+    prepared->hash = contentHash;
+
+    const uint8_t* data = prepared->dictionary.data();
+    prepared->indexBuffer.resize(
+        bejDictIndexGetBufferSize(data, prepared->dictionary.size()) /
+            sizeof(uint32_t) +
+        1);
+    if (bejDictPrepare(data, prepared->dictionary.size(),
+                       prepared->indexBuffer.data(),
+                       prepared->indexBuffer.size() * sizeof(uint32_t),
+                       &prepared->dictionaryIndex) != 0)
+    {
+        return nullptr;
+    }
+    prepared->keyCache = JsonKeyCache(prepared->dictionary);
+    return prepared;
+}
+
+uint32_t PreparedDictionary::schemaVersion() const
+{
+    return reinterpret_cast<const BejDictionaryHeader*>(dictionary.data())
+        ->schemaVersion;
+}
+
+DictionaryRegistry::Key
+    DictionaryRegistry::makeKey(std::span<const uint8_t> dictionary)
+{
+    uint32_t schemaVersion = 0;
+    if (dictionary.size() >= sizeof(BejDictionaryHeader))
+    {
+        schemaVersion =
+            reinterpret_cast<const BejDictionaryHeader*>(dictionary.data())
+                ->schemaVersion;
+    }
+    return {dictionaryContentHash(dictionary), schemaVersion,
+            dictionary.size()};
+}
+
+std::shared_ptr<const PreparedDictionary>
+    DictionaryRegistry::findIn(const Entries& entries, const Key& key,
+                               std::span<const uint8_t> dictionary)
+{
+    auto [begin, end] = entries.equal_range(key);
+    for (auto it = begin; it != end; ++it)
+    {
+        std::shared_ptr<const PreparedDictionary> prepared = it->second.lock();
+        // A different dictionary might have the same hash.
+        if (prepared != nullptr &&
+            std::equal(dictionary.begin(), dictionary.end(),
+                       prepared->data().begin(), prepared->data().end()))
+        {
+            return prepared;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const PreparedDictionary>
+    DictionaryRegistry::find(std::span<const uint8_t> dictionary) const
+{
+    return findIn(*snapshot.load(), makeKey(dictionary), dictionary);
+}
+
+std::shared_ptr<const PreparedDictionary>
+    DictionaryRegistry::intern(std::span<const uint8_t> dictionary)
+{
+    Key key = makeKey(dictionary);
+    if (auto prepared = findIn(*snapshot.load(), key, dictionary))
+    {
+        return prepared;
+    }
+
+    // Validate and index outside of the lock. Another thread might add the
+    // same dictionary meanwhile. In that case this copy is dropped.
+    std::shared_ptr<const PreparedDictionary> prepared =
+        PreparedDictionary::create(dictionary, std::get<0>(key));
+    if (prepared == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    std::shared_ptr<const Entries> current = snapshot.load();
+    if (auto existing = findIn(*current, key, dictionary))
+    {
+        return existing;
+    }
+
+    // Copy the live entries only. Dictionaries nobody uses anymore are
+    // dropped here.
+    auto updated = std::make_shared<Entries>();
+    for (const auto& [entryKey, entry] : *current)
+    {
+        if (!entry.expired())
+        {
+            updated->emplace(entryKey, entry);
+        }
+    }
+    updated->emplace(key, prepared);
+    snapshot.store(std::move(updated));
+    return prepared;
+}
+
+size_t DictionaryRegistry::size() const
+{
+    std::shared_ptr<const Entries> current = snapshot.load();
+    return std::count_if(current->begin(), current->end(),
+                         [](const auto& entry) {
+                             return !entry.second.expired();
+                         });
+}
+
+DictionaryRegistry& DictionaryRegistry::instance()
+{
+    static DictionaryRegistry registry;
+    return registry;
+}
+
+} // namespace libbej
@@ -0,0 +1,168 @@
+#include "bej_dom.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Smallest tuple: sequence number, format and value length with zero length
+// nnints and an empty value.
+static const uint32_t bejDomMinTupleSize = 3;
+
+/**
+ * @brief Get the property type of a cursor event.
+ *
+ * @param[in] type - type of a set start, array start or leaf event.
+ * @return the principal data type of the property.
+ */
+static enum BejPrincipalDataType bejDomGetType(enum BejCursorEventType type)
+{
+    switch (type)
+    {
+        case bejCursorSetStart:
+            return bejSet;
+        case bejCursorArrayStart:
+            return bejArray;
+        case bejCursorInteger:
+            return bejInteger;
+        case bejCursorEnum:
+            return bejEnum;
+        case bejCursorString:
+            return bejString;
+        case bejCursorReal:
+            return bejReal;
+        case bejCursorBool:
+            return bejBoolean;
+        case bejCursorResourceLink:
+            return bejResourceLink;
+        case bejCursorNull:
+        default:
+            return bejNull;
+    }
+}
+
+/**
+ * @brief Check whether a node has the given name.
+ *
+ * @param[in] node - a DOM node.
+ * @param[in] name - a NULL terminated name. Includes the annotated property
+ * name for annotations.
+ * @return true if the names match.
+ */
+static bool bejDomNameEquals(const struct BejDomNode* node, const char* name)
+{
+    if (node->annotatedName != NULL)
+    {
+        const size_t length = strlen(node->annotatedName);
+        if (strncmp(name, node->annotatedName, length) != 0)
+        {
+            return false;
+        }
+        name += length;
+    }
+    return strcmp(name, node->name) == 0;
+}
+
+uint32_t bejDomGetMaxNodeCount(uint32_t blockLength)
+{
+    if (blockLength < sizeof(struct BejPldmBlockHeader))
+    {
+        return 0;
+    }
+    return (blockLength - sizeof(struct BejPldmBlockHeader)) /
+           bejDomMinTupleSize;
+}
+
+int bejDomBuild(const struct BejDictionaries* dictionaries,
+                const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                const struct BejDecoderOptions* options, struct BejDom* dom)
+{
+    NULL_CHECK(dom, "dom");
+    NULL_CHECK(dom->nodes, "dom nodes");
+    dom->size = 0;
+
+    struct BejCursor cursor;
+    RETURN_IF_IERROR(bejCursorInit(&cursor, dictionaries, encodedPldmBlock,
+                                   blockLength, options));
+
+    // Open sets and arrays and their last child so far.
+    uint32_t parents[BEJ_MAX_STACK_DEPTH];
+    uint32_t lastChildren[BEJ_MAX_STACK_DEPTH];
+    uint32_t depth = 0;
+    while (true)
+    {
+        const struct BejCursorEvent* event;
+        RETURN_IF_IERROR(bejCursorNext(&cursor, &event));
+        if (event == NULL)
+        {
+            return 0;
+        }
+        if (event->type == bejCursorSetEnd || event->type == bejCursorArrayEnd)
+        {
+            // The cursor reports balanced ends.
+            --depth;
+            continue;
+        }
+
+        if (dom->size >= dom->capacity)
+        {
+            fprintf(stderr, "DOM is full. Capacity: %u\n", dom->capacity);
+            return bejErrorInvalidSize;
+        }
+        const uint32_t index = dom->size++;
+        struct BejDomNode* node = &dom->nodes[index];
+        node->name = event->propertyName;
+        node->annotatedName = event->annotatedPropertyName;
+        node->firstChild = BEJ_DOM_NO_NODE;
+        node->nextSibling = BEJ_DOM_NO_NODE;
+        node->childCount = 0;
+        node->type = bejDomGetType(event->type);
+        node->value = event->value;
+
+        if (depth > 0)
+        {
+            struct BejDomNode* parent = &dom->nodes[parents[depth - 1]];
+            if (lastChildren[depth - 1] == BEJ_DOM_NO_NODE)
+            {
+                parent->firstChild = index;
+            }
+            else
+            {
+                dom->nodes[lastChildren[depth - 1]].nextSibling = index;
+            }
+            lastChildren[depth - 1] = index;
+            ++parent->childCount;
+        }
+
+        if (node->type == bejSet || node->type == bejArray)
+        {
+            // The cursor stack limits the depth to the same value.
+            if (depth >= BEJ_MAX_STACK_DEPTH)
+            {
+                fprintf(stderr, "DOM is too deep\n");
+                return bejErrorNotSupported;
+            }
+            parents[depth] = index;
+            lastChildren[depth] = BEJ_DOM_NO_NODE;
+            ++depth;
+        }
+    }
+}
+
+uint32_t bejDomFindChild(const struct BejDom* dom, uint32_t parent,
+                         const char* name)
+{
+    if (dom == NULL || name == NULL || parent >= dom->size)
+    {
+        return BEJ_DOM_NO_NODE;
+    }
+    uint32_t child = dom->nodes[parent].firstChild;
+    while (child != BEJ_DOM_NO_NODE)
+    {
+        if (bejDomNameEquals(&dom->nodes[child], name))
+        {
+            return child;
+        }
+        child = dom->nodes[child].nextSibling;
+    }
+    return BEJ_DOM_NO_NODE;
+}
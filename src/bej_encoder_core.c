@@ -225,19 +225,19 @@ static int bejEncodeNode(void* node, struct BejEncoderOutputHandler* output)
  * @brief A helper function to add a parent to the stack.
  */
 static int bejPushParentToStack(struct RedfishPropertyParent* parent,
-                                struct BejPointerStackCallback* stack)
+                                const struct BejPointerStack* stack)
 {
     // Before pushing the parent node, initialize its nextChild as the first
     // child.
     parent->metaData.nextChild = parent->firstChild;
-    return stack->stackPush(parent, stack->stackContext);
+    return bejPointerStackPush(stack, parent);
 }
 
 /**
  * @brief Process all the child nodes of a parent.
  */
 static int bejProcessChildNodes(struct RedfishPropertyParent* parent,
-                                struct BejPointerStackCallback* stack,
+                                const struct BejPointerStack* stack,
                                 struct BejEncoderOutputHandler* output)
 {
     // Get the next child of the parent.
@@ -270,7 +270,7 @@ static int bejProcessChildNodes(struct RedfishPropertyParent* parent,
  * The node metadata should be initialized before using this function.
  */
 static int bejEncodeTree(struct RedfishPropertyParent* root,
-                         struct BejPointerStackCallback* stack,
+                         const struct BejPointerStack* stack,
                          struct BejEncoderOutputHandler* output)
 {
     // We need to encode a parent node before its child nodes. So encoding the
@@ -282,10 +282,9 @@ static int bejEncodeTree(struct RedfishPropertyParent* root,
     // the stack.
     RETURN_IF_IERROR(bejPushParentToStack(root, stack));
 
-    while (!stack->stackEmpty(stack->stackContext))
+    while (!bejPointerStackEmpty(stack))
     {
-        struct RedfishPropertyParent* parent =
-            stack->stackPeek(stack->stackContext);
+        struct RedfishPropertyParent* parent = bejPointerStackPeek(stack);
 
         // Encode all the child nodes of the current parent node. If one of
         // these child nodes has its own child nodes, that child node will be
@@ -299,11 +298,11 @@ static int bejEncodeTree(struct RedfishPropertyParent* root,
         // bejProcessChildNodes(), we know that this parent's child nodes have
         // been processed. If a new node has been added, then next we need to
         // process the children of the newly added node.
-        if (parent != stack->stackPeek(stack->stackContext))
+        if (parent != bejPointerStackPeek(stack))
         {
             continue;
         }
-        stack->stackPop(stack->stackContext);
+        bejPointerStackPop(stack);
     }
     return 0;
 }
@@ -314,6 +313,18 @@ int bejEncode(const struct BejDictionaries* dictionaries,
               struct RedfishPropertyParent* root,
               struct BejEncoderOutputHandler* output,
               struct BejPointerStackCallback* stack)
+{
+    return bejEncodeWithOptions(dictionaries, majorSchemaStartingOffset,
+                                schemaClass, root, output, stack, NULL);
+}
+
+int bejEncodeWithOptions(const struct BejDictionaries* dictionaries,
+                         uint16_t majorSchemaStartingOffset,
+                         enum BejSchemaClass schemaClass,
+                         struct RedfishPropertyParent* root,
+                         struct BejEncoderOutputHandler* output,
+                         struct BejPointerStackCallback* stack,
+                         const struct BejEncoderOptions* options)
 {
     NULL_CHECK(dictionaries, "dictionaries");
     NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
@@ -322,7 +333,19 @@ int bejEncode(const struct BejDictionaries* dictionaries,
     NULL_CHECK(root, "root");
 
     NULL_CHECK(output, "output");
-    NULL_CHECK(stack, "stack");
+    struct BejPointerStack pointerStack = {
+        .callbacks = stack,
+        .storage = (options != NULL) ? options->stackStorage : NULL,
+    };
+    if (pointerStack.storage != NULL)
+    {
+        NULL_CHECK(pointerStack.storage->entries, "stack storage entries");
+        pointerStack.storage->size = 0;
+    }
+    else
+    {
+        NULL_CHECK(stack, "stack");
+    }
 
     // Assert root node.
     if (root->nodeAttr.format.principalDataType != bejSet)
@@ -344,8 +367,11 @@ int bejEncode(const struct BejDictionaries* dictionaries,
     // node, and produce the encoded bytes.
 
     // First calculate metadata for encoding each node.
-    RETURN_IF_IERROR(bejUpdateNodeMetadata(
-        dictionaries, majorSchemaStartingOffset, root, stack));
+    const struct BejDictionaryIndexes* dictionaryIndexes =
+        (options != NULL) ? options->dictionaryIndexes : NULL;
+    RETURN_IF_IERROR(bejUpdateNodeMetadataWithIndexes(
+        dictionaries, dictionaryIndexes, majorSchemaStartingOffset, root,
+        stack, pointerStack.storage));
 
     // Derive the header of the encoded output.
     // BEJ version
@@ -360,5 +386,44 @@ int bejEncode(const struct BejDictionaries* dictionaries,
 
     // Produce the encoded bytes for the nodes using the previously calculated
     // metadata.
-    return bejEncodeTree(root, stack, output);
+    return bejEncodeTree(root, &pointerStack, output);
+}
+
+int bejEncodePrepared(const struct BejDictionaryIndexes* preparedDictionaries,
+                      uint16_t majorSchemaStartingOffset,
+                      enum BejSchemaClass schemaClass,
+                      struct RedfishPropertyParent* root,
+                      struct BejEncoderOutputHandler* output,
+                      struct BejPointerStackCallback* stack,
+                      const struct BejEncoderOptions* options)
+{
+    NULL_CHECK(preparedDictionaries, "preparedDictionaries");
+    if (!bejDictIndexIsPrepared(preparedDictionaries->schemaIndex) ||
+        !bejDictIndexIsPrepared(preparedDictionaries->annotationIndex))
+    {
+        fprintf(stderr, "Dictionaries are not prepared\n");
+        return bejErrorNotSupported;
+    }
+
+    const uint8_t* schemaDictionary =
+        preparedDictionaries->schemaIndex->dictionary;
+    const uint8_t* annotationDictionary =
+        preparedDictionaries->annotationIndex->dictionary;
+    struct BejDictionaries dictionaries = {
+        .schemaDictionary = schemaDictionary,
+        .schemaDictionarySize =
+            preparedDictionaries->schemaIndex->validatedSize,
+        .annotationDictionary = annotationDictionary,
+        .annotationDictionarySize =
+            preparedDictionaries->annotationIndex->validatedSize,
+        .errorDictionary = NULL,
+        .errorDictionarySize = 0,
+    };
+    struct BejEncoderOptions preparedOptions = {
+        .dictionaryIndexes = preparedDictionaries,
+        .stackStorage = (options != NULL) ? options->stackStorage : NULL,
+    };
+    return bejEncodeWithOptions(&dictionaries, majorSchemaStartingOffset,
+                                schemaClass, root, output, stack,
+                                &preparedOptions);
 }
@@ -55,6 +55,22 @@ std::vector<uint8_t> BejEncoderJson::getOutput()
     return currentEncodedPayload;
 }
 
+BejPointerStackStorage*
+    BejEncoderJson::resetStack(BejPointerStackStorage& storage)
+{
+    stack.clear();
+    if (fixedStack.empty())
+    {
+        return nullptr;
+    }
+    storage = {
+        .entries = fixedStack.data(),
+        .capacity = static_cast<uint32_t>(fixedStack.size()),
+        .size = 0,
+    };
+    return &storage;
+}
+
 int BejEncoderJson::encode(const struct BejDictionaries* dictionaries,
                            enum BejSchemaClass schemaClass,
                            struct RedfishPropertyParent* root)
@@ -73,8 +89,44 @@ int BejEncoderJson::encode(const struct BejDictionaries* dictionaries,
         .deleteStack = nullptr,
     };
 
-    return bejEncode(dictionaries, BEJ_DICTIONARY_START_AT_HEAD, schemaClass,
-                     root, &output, &stackCallbacks);
+    struct BejPointerStackStorage stackStorage;
+    struct BejEncoderOptions options = {
+        .dictionaryIndexes = dictionaryIndexes,
+        .stackStorage = resetStack(stackStorage),
+    };
+
+    return bejEncodeWithOptions(dictionaries, BEJ_DICTIONARY_START_AT_HEAD,
+                                schemaClass, root, &output, &stackCallbacks,
+                                &options);
+}
+
+int BejEncoderJson::encodePrepared(
+    const BejDictionaryIndexes& preparedDictionaries,
+    enum BejSchemaClass schemaClass, struct RedfishPropertyParent* root)
+{
+    struct BejEncoderOutputHandler output = {
+        .handlerContext = &encodedPayload,
+        .recvOutput = &getBejEncodedBuffer,
+    };
+
+    struct BejPointerStackCallback stackCallbacks = {
+        .stackContext = &stack,
+        .stackEmpty = stackEmpty,
+        .stackPeek = stackPeek,
+        .stackPop = stackPop,
+        .stackPush = stackPush,
+        .deleteStack = nullptr,
+    };
+
+    struct BejPointerStackStorage stackStorage;
+    struct BejEncoderOptions options = {
+        .dictionaryIndexes = nullptr,
+        .stackStorage = resetStack(stackStorage),
+    };
+
+    return bejEncodePrepared(&preparedDictionaries,
+                             BEJ_DICTIONARY_START_AT_HEAD, schemaClass, root,
+                             &output, &stackCallbacks, &options);
 }
 
 } // namespace libbej
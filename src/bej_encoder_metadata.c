@@ -2,6 +2,7 @@
 
 #include "bej_common.h"
 #include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
 
 #include <math.h>
 #include <stdint.h>
@@ -34,6 +35,17 @@
  */
 #define BEJ_TUPLE_F_SIZE 1
 
+/**
+ * @brief Dictionaries and their optional indexes used for encoding.
+ */
+struct BejMetadataDictionaries
+{
+    const uint8_t* schemaDictionary;
+    const uint8_t* annotationDictionary;
+    const struct BejDictionaryIndex* schemaIndex;
+    const struct BejDictionaryIndex* annotationIndex;
+};
+
 /**
  * @brief Check the name is an annotation type name.
  *
@@ -59,8 +71,8 @@ static bool bejIsAnnotation(const char* name)
  * @return a pointer to the dictionary to be used.
  */
 static const uint8_t* bejGetRelatedDictionary(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    const char* nodeName)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, const char* nodeName)
 {
     // If the node name is NULL, we have to use parent dictionary.
     if (nodeName == NULL)
@@ -80,6 +92,48 @@ static const uint8_t* bejGetRelatedDictionary(
                                      : dictionaries->schemaDictionary;
 }
 
+/**
+ * @brief Get the index of a dictionary.
+ *
+ * @param[in] dictionaries - available dictionaries for encoding.
+ * @param[in] dictionary - schema or annotation dictionary.
+ * @return the index of the dictionary. NULL if there is no index.
+ */
+static const struct BejDictionaryIndex* bejGetDictionaryIndex(
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* dictionary)
+{
+    if (dictionary == dictionaries->annotationDictionary)
+    {
+        return dictionaries->annotationIndex;
+    }
+    return dictionaries->schemaIndex;
+}
+
+/**
+ * @brief Get the property at a dictionary offset.
+ *
+ * @param[in] dictionary - a dictionary.
+ * @param[in] propertyOffset - offset of the property.
+ * @return the property or NULL if the offset does not point to a property.
+ */
+static const struct BejDictionaryProperty*
+    bejGetPropertyAt(const uint8_t* dictionary, uint16_t propertyOffset)
+{
+    const struct BejDictionaryHeader* header =
+        (const struct BejDictionaryHeader*)dictionary;
+    if (propertyOffset < bejDictGetPropertyHeadOffset() ||
+        (propertyOffset - bejDictGetPropertyHeadOffset()) %
+            sizeof(struct BejDictionaryProperty) ||
+        (propertyOffset - bejDictGetPropertyHeadOffset()) /
+                sizeof(struct BejDictionaryProperty) >=
+            header->entryCount)
+    {
+        return NULL;
+    }
+    return (const struct BejDictionaryProperty*)(dictionary + propertyOffset);
+}
+
 /**
  * @brief Get dictionary data for the given node.
  *
@@ -100,9 +154,9 @@ static const uint8_t* bejGetRelatedDictionary(
  * @return 0 if successful.
  */
 static int bejFindSeqNumAndChildDictOffset(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyNode* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset, uint32_t* sequenceNumber,
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyNode* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset, uint32_t* sequenceNumber,
     const uint8_t** nodeDictionary, uint16_t* childEntryOffset)
 {
     // If the node doesn't have a name, we can't use a dictionary. So we can use
@@ -116,7 +170,15 @@ static int bejFindSeqNumAndChildDictOffset(
 
         if (childEntryOffset != NULL)
         {
-            *childEntryOffset = dictStartingOffset;
+            // dictStartingOffset points to the entry of the node itself. That
+            // is the element 0 entry for array elements and the entry of the
+            // encoded property for the root. Its children are searched in
+            // its child range.
+            const struct BejDictionaryProperty* property =
+                bejGetPropertyAt(parentDictionary, dictStartingOffset);
+            *childEntryOffset = (property != NULL && property->childCount > 0)
+                                    ? property->childPointerOffset
+                                    : dictStartingOffset;
         }
 
         // If the property doesn't have a name, it has to be an element of an
@@ -152,14 +214,17 @@ static int bejFindSeqNumAndChildDictOffset(
         dictStartingOffset = bejDictGetFirstAnnotatedPropertyOffset();
     }
 
+    const struct BejDictionaryIndex* dictIndex =
+        bejGetDictionaryIndex(dictionaries, dictionary);
     const struct BejDictionaryProperty* property;
-    int ret = bejDictGetPropertyByName(dictionary, dictStartingOffset,
-                                       node->name, &property, NULL);
+    int ret = bejDictIndexGetPropertyByName(
+        dictionary, dictIndex, dictStartingOffset, node->name, &property, NULL);
     if ((ret != 0) && isAnnotation && (dictionary == parentDictionary))
     {
         dictStartingOffset = bejDictGetFirstAnnotatedPropertyOffset();
-        ret = bejDictGetPropertyByName(dictionary, dictStartingOffset,
-                                       node->name, &property, NULL);
+        ret = bejDictIndexGetPropertyByName(dictionary, dictIndex,
+                                            dictStartingOffset, node->name,
+                                            &property, NULL);
         bejTreeUpdateNodeFlags(node, false, true, false);
     }
     if (ret != 0)
@@ -189,10 +254,10 @@ static int bejFindSeqNumAndChildDictOffset(
     return 0;
 }
 
-static int bejUpdateIntMetaData(const struct BejDictionaries* dictionaries,
-                                const uint8_t* parentDictionary,
-                                struct RedfishPropertyLeafInt* node,
-                                uint16_t nodeIndex, uint16_t dictStartingOffset)
+static int bejUpdateIntMetaData(
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafInt* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     uint32_t sequenceNumber;
     RETURN_IF_IERROR(bejFindSeqNumAndChildDictOffset(
@@ -213,9 +278,9 @@ static int bejUpdateIntMetaData(const struct BejDictionaries* dictionaries,
 }
 
 static int bejUpdateStringMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyLeafString* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafString* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     uint32_t sequenceNumber;
     RETURN_IF_IERROR(bejFindSeqNumAndChildDictOffset(
@@ -238,9 +303,9 @@ static int bejUpdateStringMetaData(
 }
 
 static int bejUpdateRealMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyLeafReal* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafReal* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     uint32_t sequenceNumber;
     RETURN_IF_IERROR(bejFindSeqNumAndChildDictOffset(
@@ -318,9 +383,9 @@ static int bejUpdateRealMetaData(
 }
 
 static int bejUpdateEnumMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyLeafEnum* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafEnum* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     const uint8_t* nodeDictionary;
     uint16_t childEntryOffset;
@@ -336,14 +401,13 @@ static int bejUpdateEnumMetaData(
     // Update the sequence number of the property.
     node->leaf.metaData.sequenceNumber = sequenceNumber;
 
-    // Get the sequence number for the Enum value.
-    if (node->leaf.nodeAttr.name != NULL && node->leaf.nodeAttr.name[0] != '\0')
-    {
-        dictStartingOffset = childEntryOffset;
-    }
+    // Get the sequence number for the Enum value. The enum values are the
+    // children of the enum property.
+    dictStartingOffset = childEntryOffset;
     const struct BejDictionaryProperty* enumValueProperty;
-    int ret = bejDictGetPropertyByName(nodeDictionary, dictStartingOffset,
-                                       node->value, &enumValueProperty, NULL);
+    int ret = bejDictIndexGetPropertyByName(
+        nodeDictionary, bejGetDictionaryIndex(dictionaries, nodeDictionary),
+        dictStartingOffset, node->value, &enumValueProperty, NULL);
     if (ret != 0)
     {
         fprintf(
@@ -370,9 +434,9 @@ static int bejUpdateEnumMetaData(
 }
 
 static int bejUpdateBoolMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyLeafBool* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafBool* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     uint32_t sequenceNumber;
     RETURN_IF_IERROR(bejFindSeqNumAndChildDictOffset(
@@ -393,9 +457,9 @@ static int bejUpdateBoolMetaData(
 }
 
 static int bejUpdateNullMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    struct RedfishPropertyLeafNull* node, uint16_t nodeIndex,
-    uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, struct RedfishPropertyLeafNull* node,
+    uint16_t nodeIndex, uint16_t dictStartingOffset)
 {
     uint32_t sequenceNumber;
     RETURN_IF_IERROR(bejFindSeqNumAndChildDictOffset(
@@ -428,8 +492,9 @@ static int bejUpdateNullMetaData(
  * @return 0 if successful.
  */
 static int bejUpdateLeafNodeMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    void* childPtr, uint16_t childIndex, uint16_t dictStartingOffset)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, void* childPtr, uint16_t childIndex,
+    uint16_t dictStartingOffset)
 {
     struct RedfishPropertyLeaf* chNode = childPtr;
 
@@ -485,9 +550,9 @@ static int bejUpdateLeafNodeMetaData(
  * @return 0 if successful.
  */
 static int bejUpdateParentMetaData(
-    const struct BejDictionaries* dictionaries, const uint8_t* parentDictionary,
-    uint16_t dictStartingOffset, struct RedfishPropertyParent* node,
-    uint16_t nodeIndex)
+    const struct BejMetadataDictionaries* dictionaries,
+    const uint8_t* parentDictionary, uint16_t dictStartingOffset,
+    struct RedfishPropertyParent* node, uint16_t nodeIndex)
 {
     const uint8_t* nodeDictionary;
     uint16_t childEntryOffset;
@@ -532,9 +597,9 @@ static int bejUpdateParentMetaData(
  * @param stack - stack holding parent nodes.
  * @return 0 if successful.
  */
-static int bejProcessChildNodes(const struct BejDictionaries* dictionaries,
-                                struct RedfishPropertyParent* parent,
-                                struct BejPointerStackCallback* stack)
+static int bejProcessChildNodes(
+    const struct BejMetadataDictionaries* dictionaries,
+    struct RedfishPropertyParent* parent, const struct BejPointerStack* stack)
 {
     // Get the next child of the parent.
     void* childPtr = parent->metaData.nextChild;
@@ -551,7 +616,7 @@ static int bejProcessChildNodes(const struct BejDictionaries* dictionaries,
                 parent->metaData.childrenDictPropOffset, childPtr,
                 parent->metaData.nextChildIndex));
 
-            RETURN_IF_IERROR(stack->stackPush(childPtr, stack->stackContext));
+            RETURN_IF_IERROR(bejPointerStackPush(stack, childPtr));
             bejParentGoToNextChild(parent, childPtr);
             return 0;
         }
@@ -577,6 +642,44 @@ int bejUpdateNodeMetadata(const struct BejDictionaries* dictionaries,
                           struct RedfishPropertyParent* root,
                           struct BejPointerStackCallback* stack)
 {
+    return bejUpdateNodeMetadataWithIndexes(
+        dictionaries, NULL, majorSchemaStartingOffset, root, stack, NULL);
+}
+
+int bejUpdateNodeMetadataWithIndexes(
+    const struct BejDictionaries* dictionaries,
+    const struct BejDictionaryIndexes* dictionaryIndexes,
+    uint16_t majorSchemaStartingOffset, struct RedfishPropertyParent* root,
+    struct BejPointerStackCallback* stack,
+    struct BejPointerStackStorage* stackStorage)
+{
+    if (stackStorage != NULL)
+    {
+        NULL_CHECK(stackStorage->entries, "stack storage entries");
+        stackStorage->size = 0;
+    }
+    else
+    {
+        NULL_CHECK(stack, "stack");
+    }
+    struct BejPointerStack pointerStack = {
+        .callbacks = stack,
+        .storage = stackStorage,
+    };
+
+    struct BejMetadataDictionaries metadataDictionaries = {
+        .schemaDictionary = dictionaries->schemaDictionary,
+        .annotationDictionary = dictionaries->annotationDictionary,
+        .schemaIndex = NULL,
+        .annotationIndex = NULL,
+    };
+    if (dictionaryIndexes != NULL)
+    {
+        metadataDictionaries.schemaIndex = dictionaryIndexes->schemaIndex;
+        metadataDictionaries.annotationIndex =
+            dictionaryIndexes->annotationIndex;
+    }
+
     // Decide the starting property offset of the dictionary.
     uint16_t dictOffset = bejDictGetPropertyHeadOffset();
     if (majorSchemaStartingOffset != BEJ_DICTIONARY_START_AT_HEAD)
@@ -585,32 +688,33 @@ int bejUpdateNodeMetadata(const struct BejDictionaries* dictionaries,
     }
 
     // Initialize root node metadata.
-    RETURN_IF_IERROR(
-        bejUpdateParentMetaData(dictionaries, dictionaries->schemaDictionary,
-                                dictOffset, root, /*childIndex=*/0));
+    RETURN_IF_IERROR(bejUpdateParentMetaData(
+        &metadataDictionaries, metadataDictionaries.schemaDictionary,
+        dictOffset, root, /*childIndex=*/0));
 
     // Push the root to the stack. Because we are not done with the parent node
     // yet. Need to figure out all bytes need to encode children of this parent,
     // and save it in the parent metadata.
-    RETURN_IF_IERROR(stack->stackPush(root, stack->stackContext));
+    RETURN_IF_IERROR(bejPointerStackPush(&pointerStack, root));
 
-    while (!stack->stackEmpty(stack->stackContext))
+    while (!bejPointerStackEmpty(&pointerStack))
     {
         // Get the parent at the top of the stack. Stack is only popped if the
         // parent stack entry has no pending children; That is
         // parent->metaData.nextChild == NULL.
         struct RedfishPropertyParent* parent =
-            stack->stackPeek(stack->stackContext);
+            bejPointerStackPeek(&pointerStack);
 
         // Calculate metadata of all the child nodes of the current parent node.
         // If one of these child nodes has its own child nodes, that child node
         // will be added to the stack and this function will return.
-        RETURN_IF_IERROR(bejProcessChildNodes(dictionaries, parent, stack));
+        RETURN_IF_IERROR(
+            bejProcessChildNodes(&metadataDictionaries, parent, &pointerStack));
 
         // If a new node hasn't been added to the stack, we know that this
         // parent's child nodes have been processed. If not, do not pop the
         // stack.
-        if (parent != stack->stackPeek(stack->stackContext))
+        if (parent != bejPointerStackPeek(&pointerStack))
         {
             continue;
         }
@@ -620,7 +724,7 @@ int bejUpdateNodeMetadata(const struct BejDictionaries* dictionaries,
         // All the children of "parent" has been processed.
 
         // Remove the "parent" from the stack.
-        parent = stack->stackPop(stack->stackContext);
+        parent = bejPointerStackPop(&pointerStack);
         // L: Add the length needed to store the number of bytes used for the
         // parent's value.
         parent->metaData.sflSize +=
@@ -632,7 +736,7 @@ int bejUpdateNodeMetadata(const struct BejDictionaries* dictionaries,
         // of the stack element is this nodes's parent. "parentsParent" can be
         // NULL if the node pointed by "parent" variable is the root.
         struct RedfishPropertyParent* parentsParent =
-            stack->stackPeek(stack->stackContext);
+            bejPointerStackPeek(&pointerStack);
         if (parentsParent != NULL)
         {
             // V: Include the total size to encode the current parent in its
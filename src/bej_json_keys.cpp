@@ -0,0 +1,112 @@
+#include "bej_json_keys.hpp"
+
+#include "bej_dictionary.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace libbej
+{
+
+/**
+ * @brief Append a JSON key with the escaped name.
+ *
+ * @param[in] name - property name.
+ * @param[inout] output - string to append the key to.
+ */
+static void appendKey(std::string_view name, std::string& output)
+{
+    output.push_back('\"');
+    for (char c : name)
+    {
+        if (c == '\"' || c == '\\')
+        {
+            output.push_back('\\');
+            output.push_back(c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x",
+                     static_cast<unsigned char>(c));
+            output.append(escaped);
+        }
+        else
+        {
+            output.push_back(c);
+        }
+    }
+    output.append("\":");
+}
+
+JsonKeyCache::JsonKeyCache(std::span<const uint8_t> dictionary)
+{
+    if (dictionary.size() < sizeof(BejDictionaryHeader))
+    {
+        return;
+    }
+    const BejDictionaryHeader* header =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary.data());
+    const size_t propertiesEnd =
+        bejDictGetPropertyHeadOffset() +
+        static_cast<size_t>(header->entryCount) * sizeof(BejDictionaryProperty);
+    if (propertiesEnd > dictionary.size())
+    {
+        return;
+    }
+    const BejDictionaryProperty* properties =
+        reinterpret_cast<const BejDictionaryProperty*>(
+            dictionary.data() + bejDictGetPropertyHeadOffset());
+
+    // Find the names inside the dictionary and where they start and end.
+    std::vector<std::string_view> names;
+    std::vector<size_t> nameOffsets;
+    size_t begin = dictionary.size();
+    size_t end = 0;
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        const BejDictionaryProperty& property = properties[i];
+        if (property.nameLength == 0 ||
+            static_cast<size_t>(property.nameOffset) + property.nameLength >
+                dictionary.size())
+        {
+            continue;
+        }
+        std::string_view name(
+            reinterpret_cast<const char*>(dictionary.data()) +
+                property.nameOffset,
+            property.nameLength);
+        // The name length includes the NULL terminator.
+        name = name.substr(0, name.find('\0'));
+        if (name.empty())
+        {
+            continue;
+        }
+        names.push_back(name);
+        nameOffsets.push_back(property.nameOffset);
+        begin = std::min<size_t>(begin, property.nameOffset);
+        end = std::max<size_t>(end, property.nameOffset + 1);
+    }
+    if (names.empty())
+    {
+        return;
+    }
+
+    namesBegin = dictionary.data() + begin;
+    slots.assign(end - begin, 0);
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        uint16_t& slot = slots[nameOffsets[i] - begin];
+        if (slot != 0)
+        {
+            // Properties sharing a name also share the key.
+            continue;
+        }
+        keyOffsets.push_back(static_cast<uint32_t>(fragments.size()));
+        appendKey(names[i], fragments);
+        slot = static_cast<uint16_t>(keyOffsets.size());
+    }
+    keyOffsets.push_back(static_cast<uint32_t>(fragments.size()));
+}
+
+} // namespace libbej
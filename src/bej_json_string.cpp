@@ -0,0 +1,321 @@
+#include "bej_json_string.hpp"
+
+#include "bej_common.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace libbej
+{
+
+/**
+ * @brief Check whether a byte cannot be copied to the output as is.
+ *
+ * Control characters and the NULL character need escaping or are invalid.
+ * Bytes from 0x80 start or continue a multi-byte UTF-8 sequence and need
+ * validation.
+ */
+static inline bool isSpecial(uint8_t c)
+{
+    return c < 0x20 || c == '\"' || c == '\\' || c >= 0x80;
+}
+
+/**
+ * @brief Find the first byte that cannot be copied to the output as is.
+ *
+ * @param[in] data - string bytes.
+ * @param[in] size - number of bytes.
+ * @return offset of the first special byte or size if there is none.
+ */
+static size_t findSpecial(const uint8_t* data, size_t size)
+{
+    size_t offset = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    // Signed comparison. Bytes from 0x80 are negative, so this finds both
+    // the control characters and the multi-byte sequences.
+    const __m128i space = _mm_set1_epi8(0x20);
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                         _mm_cmpeq_epi8(block, backslash)),
+            _mm_cmplt_epi8(block, space));
+        const int mask = _mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return offset + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    const uint8x16_t ascii = vdupq_n_u8(0x80);
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const uint8x16_t block = vld1q_u8(data + offset);
+        const uint8x16_t special = vorrq_u8(
+            vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)),
+            vorrq_u8(vcltq_u8(block, space), vcgeq_u8(block, ascii)));
+        if (vmaxvq_u8(special) != 0)
+        {
+            // The scalar loop below finds the byte within this block.
+            break;
+        }
+    }
+#endif
+    for (; offset < size; ++offset)
+    {
+        if (isSpecial(data[offset]))
+        {
+            return offset;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Get the length of a valid UTF-8 sequence.
+ *
+ * Overlong forms, surrogates and code points above U+10FFFF are rejected.
+ *
+ * @param[in] data - start of a sequence with a lead byte from 0x80.
+ * @param[in] size - number of bytes available.
+ * @param[out] truncated - true if the available bytes are a valid start of
+ * a longer sequence.
+ * @return length of the sequence or 0 if it is not valid or truncated.
+ */
+static size_t getUtf8SequenceLength(const uint8_t* data, size_t size,
+                                    bool* truncated)
+{
+    *truncated = false;
+    const uint8_t lead = data[0];
+    size_t length;
+    // Allowed range of the second byte. The other continuation bytes are
+    // always from 0x80 to 0xBF.
+    uint8_t low = 0x80;
+    uint8_t high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        if (lead == 0xE0)
+        {
+            low = 0xA0;
+        }
+        else if (lead == 0xED)
+        {
+            high = 0x9F;
+        }
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        if (lead == 0xF0)
+        {
+            low = 0x90;
+        }
+        else if (lead == 0xF4)
+        {
+            high = 0x8F;
+        }
+    }
+    else
+    {
+        return 0;
+    }
+    if (size > 1 && (data[1] < low || data[1] > high))
+    {
+        return 0;
+    }
+    for (size_t i = 2; i < length && i < size; ++i)
+    {
+        if (data[i] < 0x80 || data[i] > 0xBF)
+        {
+            return 0;
+        }
+    }
+    if (length > size)
+    {
+        *truncated = true;
+        return 0;
+    }
+    return length;
+}
+
+/**
+ * @brief Append the escaped form of an ASCII character.
+ *
+ * @param[inout] output - JSON output.
+ * @param[in] c - a quote, a backslash or a control character.
+ */
+static void appendEscaped(std::string& output, uint8_t c)
+{
+    output.push_back('\\');
+    switch (c)
+    {
+        case '\"':
+        case '\\':
+            output.push_back(static_cast<char>(c));
+            return;
+        case '\b':
+            output.push_back('b');
+            return;
+        case '\f':
+            output.push_back('f');
+            return;
+        case '\n':
+            output.push_back('n');
+            return;
+        case '\r':
+            output.push_back('r');
+            return;
+        case '\t':
+            output.push_back('t');
+            return;
+        default:
+        {
+            static constexpr char hexDigits[] = "0123456789abcdef";
+            output.append("u00");
+            output.push_back(hexDigits[c >> 4]);
+            output.push_back(hexDigits[c & 0xF]);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Append the escaped bytes of a string without the quotes.
+ *
+ * @param[inout] output - JSON output.
+ * @param[in] value - string bytes.
+ * @param[out] incomplete - number of bytes at the end of value that start a
+ * UTF-8 sequence cut by the end of value. These are not appended. NULL if
+ * such bytes are an error.
+ * @return 0 if successful.
+ */
+static int appendEscapedBytes(std::string& output, std::string_view value,
+                              size_t* incomplete)
+{
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(value.data());
+    const size_t size = value.size();
+    if (incomplete != nullptr)
+    {
+        *incomplete = 0;
+    }
+
+    size_t offset = 0;
+    while (true)
+    {
+        const size_t plain = findSpecial(data + offset, size - offset);
+        output.append(value.data() + offset, plain);
+        offset += plain;
+        if (offset == size)
+        {
+            return 0;
+        }
+
+        const uint8_t c = data[offset];
+        if (c == '\0')
+        {
+            fprintf(stderr, "String contains a NULL character at: %zu\n",
+                    offset);
+            return bejErrorInvalidSize;
+        }
+        if (c < 0x80)
+        {
+            appendEscaped(output, c);
+            ++offset;
+            continue;
+        }
+        bool truncated;
+        const size_t length =
+            getUtf8SequenceLength(data + offset, size - offset, &truncated);
+        if (truncated && incomplete != nullptr)
+        {
+            *incomplete = size - offset;
+            return 0;
+        }
+        if (length == 0)
+        {
+            fprintf(stderr, "String is not valid UTF-8 at: %zu\n", offset);
+            return bejErrorInvalidString;
+        }
+        output.append(value.data() + offset, length);
+        offset += length;
+    }
+}
+
+int appendJsonString(std::string& output, std::string_view value)
+{
+    output.reserve(output.size() + value.size() + 2);
+    output.push_back('\"');
+    RETURN_IF_IERROR(appendEscapedBytes(output, value, nullptr));
+    output.push_back('\"');
+    return 0;
+}
+
+void JsonStringWriter::begin(std::string& output)
+{
+    pendingSize = 0;
+    output.push_back('\"');
+}
+
+int JsonStringWriter::append(std::string& output, std::string_view part)
+{
+    if (pendingSize > 0)
+    {
+        // Complete the sequence cut by the last part one byte at a time.
+        // Sequences are at most 4 bytes long.
+        while (pendingSize < pending.size() && !part.empty())
+        {
+            pending[pendingSize++] = part.front();
+            part.remove_prefix(1);
+            size_t incomplete;
+            RETURN_IF_IERROR(appendEscapedBytes(
+                output, std::string_view(pending.data(), pendingSize),
+                &incomplete));
+            if (incomplete == 0)
+            {
+                pendingSize = 0;
+                break;
+            }
+        }
+        if (pendingSize > 0)
+        {
+            return 0;
+        }
+    }
+    size_t incomplete;
+    RETURN_IF_IERROR(appendEscapedBytes(output, part, &incomplete));
+    part.copy(pending.data(), incomplete, part.size() - incomplete);
+    pendingSize = incomplete;
+    return 0;
+}
+
+int JsonStringWriter::end(std::string& output)
+{
+    if (pendingSize > 0)
+    {
+        fprintf(stderr, "String ends within a UTF-8 sequence\n");
+        pendingSize = 0;
+        return bejErrorInvalidString;
+    }
+    output.push_back('\"');
+    return 0;
+}
+
+} // namespace libbej
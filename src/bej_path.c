@@ -0,0 +1,150 @@
+#include "bej_path.h"
+
+#include "bej_dictionary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Find a child property using its name.
+ *
+ * @param[in] dictionary - dictionary containing the parent.
+ * @param[in] parent - a bejSet property.
+ * @param[in] name - name of the child.
+ * @param[out] property - the child property.
+ * @return 0 if successful.
+ */
+static int bejPathFindChild(const uint8_t* dictionary,
+                            const struct BejDictionaryProperty* parent,
+                            const char* name,
+                            const struct BejDictionaryProperty** property)
+{
+    uint16_t offset;
+    RETURN_IF_IERROR(bejDictGetPropertyByName(
+        dictionary, parent->childPointerOffset, name, property, &offset));
+    // The search is not limited to the children of the parent.
+    if ((offset - parent->childPointerOffset) /
+            sizeof(struct BejDictionaryProperty) >=
+        parent->childCount)
+    {
+        return bejErrorUnknownProperty;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse an array index.
+ *
+ * @param[in] segment - a NULL terminated path segment.
+ * @param[out] index - the array index.
+ * @return true if the segment is a valid array index.
+ */
+static bool bejPathParseIndex(const char* segment, uint16_t* index)
+{
+    if (segment[0] < '0' || segment[0] > '9')
+    {
+        return false;
+    }
+    char* end;
+    unsigned long value = strtoul(segment, &end, 10);
+    if (*end != '\0' || value > UINT16_MAX)
+    {
+        return false;
+    }
+    *index = (uint16_t)value;
+    return true;
+}
+
+int bejPathResolve(const struct BejDictionaries* dictionaries,
+                   const char* path, struct BejPath* resolvedPath)
+{
+    NULL_CHECK(dictionaries, "dictionaries");
+    NULL_CHECK(dictionaries->schemaDictionary, "schemaDictionary");
+    NULL_CHECK(dictionaries->annotationDictionary, "annotationDictionary");
+    NULL_CHECK(path, "path");
+    NULL_CHECK(resolvedPath, "resolvedPath");
+    resolvedPath->depth = 0;
+
+    // Walk the dictionaries starting at the root set.
+    const uint8_t* dictionary = dictionaries->schemaDictionary;
+    uint8_t schema = bejPrimary;
+    const struct BejDictionaryProperty* parent;
+    RETURN_IF_IERROR(bejDictGetProperty(
+        dictionary, bejDictGetPropertyHeadOffset(), 0, &parent));
+
+    // Dictionary names are at most UINT8_MAX bytes long.
+    char segment[UINT8_MAX + 1];
+    const char* cursor = (*path == '/') ? path + 1 : path;
+    while (*cursor != '\0')
+    {
+        size_t length = strcspn(cursor, "/");
+        if (length == 0 || length >= sizeof(segment))
+        {
+            fprintf(stderr, "Invalid path segment in: %s\n", path);
+            return bejErrorUnknownProperty;
+        }
+        if (resolvedPath->depth >= BEJ_MAX_PATH_DEPTH)
+        {
+            fprintf(stderr, "Path is too deep: %s\n", path);
+            return bejErrorNotSupported;
+        }
+        memcpy(segment, cursor, length);
+        segment[length] = '\0';
+        cursor += length;
+        if (*cursor == '/')
+        {
+            ++cursor;
+        }
+
+        struct BejPathStep* step = &resolvedPath->steps[resolvedPath->depth];
+        const struct BejDictionaryProperty* property;
+        if (parent->format.principalDataType == bejArray)
+        {
+            uint16_t index = 0;
+            const bool anyElement = (strcmp(segment, "*") == 0);
+            if ((!anyElement && !bejPathParseIndex(segment, &index)) ||
+                parent->childCount == 0)
+            {
+                fprintf(stderr, "Invalid array index: %s\n", segment);
+                return bejErrorUnknownProperty;
+            }
+            // Dictionary only contains an entry for element 0.
+            RETURN_IF_IERROR(bejDictGetProperty(
+                dictionary, parent->childPointerOffset, 0, &property));
+            step->dictPropOffset = parent->childPointerOffset;
+            step->sequenceNumber = index;
+            step->arrayElement = true;
+            step->anyElement = anyElement;
+        }
+        else if (parent->format.principalDataType == bejSet)
+        {
+            if (segment[0] == '@' && schema == bejPrimary)
+            {
+                // Annotations are children of the annotation dictionary root.
+                dictionary = dictionaries->annotationDictionary;
+                schema = bejAnnotation;
+                RETURN_IF_IERROR(bejDictGetProperty(
+                    dictionary, bejDictGetPropertyHeadOffset(), 0, &parent));
+            }
+            if (bejPathFindChild(dictionary, parent, segment, &property) != 0)
+            {
+                fprintf(stderr, "Unknown property: %s\n", segment);
+                return bejErrorUnknownProperty;
+            }
+            step->dictPropOffset = parent->childPointerOffset;
+            step->sequenceNumber = property->sequenceNumber;
+            step->arrayElement = false;
+            step->anyElement = false;
+        }
+        else
+        {
+            fprintf(stderr, "Property has no children: %s\n", segment);
+            return bejErrorUnknownProperty;
+        }
+        step->schema = schema;
+        ++resolvedPath->depth;
+        parent = property;
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "bej_tape.h"
+
+#include "bej_dictionary.h"
+#include "bej_encoder_core.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Smallest tuple: sequence number, format and value length with zero length
+// nnints and an empty value.
+static const uint32_t bejTapeMinTupleSize = 3;
+
+// Value of BejTapeEntry.next while the entry is the root of the open
+// containers.
+static const uint32_t bejTapeNoParent = UINT32_MAX;
+
+/**
+ * @brief Get the offset soon after the value of an entry.
+ */
+static inline uint32_t bejTapeValueEnd(const struct BejTapeEntry* entry)
+{
+    return entry->valueOffset + entry->valueLength;
+}
+
+/**
+ * @brief Read the SFLV header of a tuple.
+ *
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] offset - offset to the start of the tuple.
+ * @param[in] end - offset soon after the enclosing value. The whole tuple
+ * including its value has to fit before this.
+ * @param[out] entry - filled with the tuple information except next.
+ * @return true if the tuple is within bounds.
+ */
+static bool bejTapeReadTuple(const uint8_t* encodedPldmBlock, uint32_t offset,
+                             uint32_t end, struct BejTapeEntry* entry)
+{
+    const uint8_t* tuple = encodedPldmBlock + offset;
+    const uint32_t remaining = end - offset;
+
+    // Sequence number is an nnint. bejGetNnint supports up to 8 bytes.
+    const uint8_t seqSize = tuple[0];
+    const uint32_t formatOffset = sizeof(uint8_t) + seqSize;
+    const uint32_t valueLenNnintOffset = formatOffset + sizeof(uint8_t);
+    if (seqSize > sizeof(uint64_t) || valueLenNnintOffset >= remaining)
+    {
+        return false;
+    }
+    const uint8_t valueLengthSize = tuple[valueLenNnintOffset];
+    const uint32_t valueOffset =
+        valueLenNnintOffset + sizeof(uint8_t) + valueLengthSize;
+    if (valueLengthSize > sizeof(uint64_t) || valueOffset > remaining)
+    {
+        return false;
+    }
+    const uint64_t valueLength = bejGetNnint(tuple + valueLenNnintOffset);
+    if (valueLength > remaining - valueOffset)
+    {
+        return false;
+    }
+
+    const uint64_t tupleS = bejGetNnint(tuple);
+    entry->tupleOffset = offset;
+    entry->valueOffset = offset + valueOffset;
+    entry->valueLength = (uint32_t)valueLength;
+    entry->sequenceNumber =
+        (uint16_t)((tupleS & (~DICTIONARY_TYPE_MASK)) >>
+                   DICTIONARY_SEQ_NUM_SHIFT);
+    entry->schema = (uint8_t)(tupleS & DICTIONARY_TYPE_MASK);
+    entry->format = *(const struct BejTupleF*)(tuple + formatOffset);
+    return true;
+}
+
+/**
+ * @brief Get the offset to the first child tuple of an entry.
+ *
+ * @param[in] encodedPldmBlock - encoded PLDM block.
+ * @param[in] entry - a tape entry.
+ * @param[out] childOffset - offset to the first child tuple. This is the end
+ * of the value if the entry has no child tuples.
+ * @return 0 if successful.
+ */
+static int bejTapeGetFirstChild(const uint8_t* encodedPldmBlock,
+                                const struct BejTapeEntry* entry,
+                                uint32_t* childOffset)
+{
+    *childOffset = bejTapeValueEnd(entry);
+    if (entry->valueLength == 0)
+    {
+        return 0;
+    }
+    switch (entry->format.principalDataType)
+    {
+        case bejSet:
+        case bejArray:
+        {
+            // Skip the nnint holding the number of elements.
+            const uint32_t countSize =
+                (uint32_t)encodedPldmBlock[entry->valueOffset] +
+                sizeof(uint8_t);
+            if (countSize > entry->valueLength)
+            {
+                fprintf(stderr, "Invalid element count at offset: %u\n",
+                        entry->valueOffset);
+                return bejErrorInvalidSize;
+            }
+            *childOffset = entry->valueOffset + countSize;
+            return 0;
+        }
+        case bejPropertyAnnotation:
+            // The value is the annotation tuple itself.
+            *childOffset = entry->valueOffset;
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+uint32_t bejTapeGetMaxEntryCount(uint32_t blockLength)
+{
+    if (blockLength < sizeof(struct BejPldmBlockHeader))
+    {
+        return 0;
+    }
+    return (blockLength - sizeof(struct BejPldmBlockHeader)) /
+           bejTapeMinTupleSize;
+}
+
+int bejTapeBuild(const uint8_t* encodedPldmBlock, uint32_t blockLength,
+                 struct BejTape* tape)
+{
+    NULL_CHECK(encodedPldmBlock, "encodedPldmBlock");
+    NULL_CHECK(tape, "tape");
+    NULL_CHECK(tape->entries, "tape entries");
+    tape->size = 0;
+
+    if (blockLength <= sizeof(struct BejPldmBlockHeader))
+    {
+        fprintf(stderr, "Invalid pldm block size: %u\n", blockLength);
+        return bejErrorInvalidSize;
+    }
+    const struct BejPldmBlockHeader* pldmHeader =
+        (const struct BejPldmBlockHeader*)encodedPldmBlock;
+    if (pldmHeader->bejVersion != BEJ_VERSION)
+    {
+        fprintf(stderr, "Tape doesn't support the bej version: %u\n",
+                pldmHeader->bejVersion);
+        return bejErrorNotSupported;
+    }
+
+    struct BejTapeEntry* entries = tape->entries;
+    uint32_t offset = sizeof(struct BejPldmBlockHeader);
+    // Innermost container whose children are being scanned. While a container
+    // is open, its next field links to the enclosing open container. This
+    // avoids a separate stack.
+    uint32_t open = bejTapeNoParent;
+    while (true)
+    {
+        // Close every container that ends at this offset.
+        while (open != bejTapeNoParent &&
+               offset == bejTapeValueEnd(&entries[open]))
+        {
+            uint32_t parent = entries[open].next;
+            entries[open].next = tape->size;
+            open = parent;
+        }
+        // Done once the root tuple is closed. Anything after it is not part of
+        // the payload.
+        if (open == bejTapeNoParent && tape->size > 0)
+        {
+            return 0;
+        }
+
+        if (tape->size >= tape->capacity)
+        {
+            fprintf(stderr, "Tape is full. Capacity: %u\n", tape->capacity);
+            return bejErrorInvalidSize;
+        }
+        const uint32_t end = (open == bejTapeNoParent)
+                                 ? blockLength
+                                 : bejTapeValueEnd(&entries[open]);
+        struct BejTapeEntry* entry = &entries[tape->size];
+        if (!bejTapeReadTuple(encodedPldmBlock, offset, end, entry))
+        {
+            fprintf(stderr, "Invalid tuple at offset: %u\n", offset);
+            return bejErrorInvalidSize;
+        }
+        const uint32_t index = tape->size++;
+
+        uint32_t childOffset;
+        RETURN_IF_IERROR(
+            bejTapeGetFirstChild(encodedPldmBlock, entry, &childOffset));
+        if (childOffset < bejTapeValueEnd(entry))
+        {
+            entry->next = open;
+            open = index;
+        }
+        else
+        {
+            entry->next = tape->size;
+        }
+        offset = childOffset;
+    }
+}
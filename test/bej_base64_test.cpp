@@ -0,0 +1,115 @@
+#include "bej_base64.hpp"
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_tape.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+/**
+ * @brief Get the base64 text of a string.
+ */
+std::string toBase64(std::string_view value)
+{
+    std::string output;
+    appendBase64(output, std::span(
+                             reinterpret_cast<const uint8_t*>(value.data()),
+                             value.size()));
+    return output;
+}
+
+TEST(BejBase64Test, Rfc4648Vectors)
+{
+    EXPECT_EQ(toBase64(""), "");
+    EXPECT_EQ(toBase64("f"), "Zg==");
+    EXPECT_EQ(toBase64("fo"), "Zm8=");
+    EXPECT_EQ(toBase64("foo"), "Zm9v");
+    EXPECT_EQ(toBase64("foob"), "Zm9vYg==");
+    EXPECT_EQ(toBase64("fooba"), "Zm9vYmE=");
+    EXPECT_EQ(toBase64("foobar"), "Zm9vYmFy");
+}
+
+TEST(BejBase64Test, AllByteValues)
+{
+    std::vector<uint8_t> bytes(256);
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<uint8_t>(i);
+    }
+    std::string output = "prefix";
+    appendBase64(output, bytes);
+    ASSERT_EQ(output.size(), 6 + 344);
+    EXPECT_EQ(output.substr(0, 14), "prefixAAECAwQF");
+    EXPECT_EQ(output.substr(output.size() - 8), "/P3+/w==");
+}
+
+TEST(BejBytestringDecodeTest, DecodedAsBase64)
+{
+    auto inputsOrErr = loadInputs({
+        .jsonFile = "../test/json/dummysimple.json",
+        .schemaDictionaryFile = "../test/dictionaries/dummy_simple_dict.bin",
+        .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+        .errorDictionaryFile = "",
+        .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
+    });
+    ASSERT_TRUE(inputsOrErr);
+
+    // Turn the "Id" string into a bytestring holding the same bytes.
+    std::vector<uint8_t> block(inputsOrErr->encodedStream.begin(),
+                               inputsOrErr->encodedStream.end());
+    std::vector<BejTapeEntry> entries(bejTapeGetMaxEntryCount(block.size()));
+    BejTape tape = {
+        .entries = entries.data(),
+        .capacity = static_cast<uint32_t>(entries.size()),
+        .size = 0,
+    };
+    ASSERT_EQ(bejTapeBuild(block.data(), block.size(), &tape), 0);
+    const std::string_view id = "Dummy ID";
+    bool patched = false;
+    for (uint32_t i = 0; i < tape.size && !patched; ++i)
+    {
+        const BejTapeEntry& entry = entries[i];
+        if (entry.format.principalDataType != bejString ||
+            std::string_view(
+                reinterpret_cast<const char*>(&block[entry.valueOffset])) !=
+                id)
+        {
+            continue;
+        }
+        // The format byte follows the sequence number nnint.
+        const uint32_t formatOffset =
+            entry.tupleOffset + 1 + block[entry.tupleOffset];
+        BejTupleF format = entry.format;
+        format.principalDataType = bejBytestring;
+        memcpy(&block[formatOffset], &format, sizeof(format));
+        patched = true;
+    }
+    ASSERT_TRUE(patched);
+
+    BejDictionaries dictionaries = {
+        .schemaDictionary = inputsOrErr->schemaDictionary,
+        .schemaDictionarySize = inputsOrErr->schemaDictionarySize,
+        .annotationDictionary = inputsOrErr->annotationDictionary,
+        .annotationDictionarySize = inputsOrErr->annotationDictionarySize,
+        .errorDictionary = inputsOrErr->errorDictionary,
+        .errorDictionarySize = inputsOrErr->errorDictionarySize,
+    };
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+
+    // The value includes the NULL terminator of the original string.
+    nlohmann::json expected = inputsOrErr->expectedJson;
+    expected["Id"] = toBase64(std::string_view(id.data(), id.size() + 1));
+    EXPECT_EQ(jsonDecoded, expected);
+}
+
+} // namespace libbej
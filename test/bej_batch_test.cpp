@@ -0,0 +1,335 @@
+#include "bej_common_test.hpp"
+#include "bej_cursor.hpp"
+#include "bej_decoder_core.h"
+#include "bej_encoder_json.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejBatchTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+    // Number of events in a batch.
+    const uint32_t capacity;
+};
+
+void PrintTo(const BejBatchTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejBatchTest = testing::TestWithParam<BejBatchTestParams>;
+
+const BejTestInputFiles driveOemTestFiles = {
+    .jsonFile = "../test/json/drive_oem.json",
+    .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+};
+
+const BejTestInputFiles circuitTestFiles = {
+    .jsonFile = "../test/json/circuit.json",
+    .schemaDictionaryFile = "../test/dictionaries/circuit_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/circuit_enc.bin",
+};
+
+const BejTestInputFiles storageTestFiles = {
+    .jsonFile = "../test/json/storage.json",
+    .schemaDictionaryFile = "../test/dictionaries/storage_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/storage_enc.bin",
+};
+
+const BejTestInputFiles dummySimpleTestFiles = {
+    .jsonFile = "../test/json/dummysimple.json",
+    .schemaDictionaryFile = "../test/dictionaries/dummy_simple_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
+};
+
+/**
+ * @brief Events and reals of every batch and the number of batches.
+ */
+struct CollectedBatches
+{
+    // realIndex of a real event selects a value in reals.
+    std::vector<BejBatchEvent> events;
+    std::vector<BejReal> reals;
+    uint32_t batches = 0;
+    // Largest number of reals in a batch.
+    uint32_t maxBatchReals = 0;
+};
+
+/**
+ * @brief Collect the events and the reals of every batch.
+ */
+int collectBatch(const BejBatchEvent* events, uint32_t count,
+                 const BejReal* reals, void* dataPtr)
+{
+    auto* collected = static_cast<CollectedBatches*>(dataPtr);
+    uint32_t batchReals = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        BejBatchEvent event = events[i];
+        if (event.type == bejCursorReal)
+        {
+            collected->reals.push_back(reals[event.value.realIndex]);
+            event.value.realIndex =
+                static_cast<uint32_t>(collected->reals.size() - 1);
+            ++batchReals;
+        }
+        collected->events.push_back(event);
+    }
+    collected->maxBatchReals = std::max(collected->maxBatchReals, batchReals);
+    ++collected->batches;
+    return 0;
+}
+
+/**
+ * @brief Check a collected real against the value from a cursor.
+ */
+void expectReal(const CollectedBatches& collected,
+                const BejBatchEvent& batchEvent, const BejReal& expected)
+{
+    ASSERT_LT(batchEvent.value.realIndex, collected.reals.size());
+    const BejReal& real = collected.reals[batchEvent.value.realIndex];
+    EXPECT_EQ(real.whole, expected.whole);
+    EXPECT_EQ(real.zeroCount, expected.zeroCount);
+    EXPECT_EQ(real.fract, expected.fract);
+    EXPECT_EQ(real.expLen, expected.expLen);
+    // exp is only set with an exponent.
+    if (expected.expLen != 0)
+    {
+        EXPECT_EQ(real.exp, expected.exp);
+    }
+}
+
+// Reals are kept out of the events to keep them small.
+static_assert(sizeof(BejBatchEvent) <= 40);
+
+TEST_P(BejBatchTest, MatchesCursor)
+{
+    const BejBatchTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    std::vector<BejBatchEvent> batch(test_case.capacity);
+    CollectedBatches collected;
+    ASSERT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), batch.data(),
+                                        batch.size(), collectBatch,
+                                        &collected, nullptr),
+              0);
+    // Every batch but the last one is full. None of these blocks has enough
+    // reals to pass a batch early.
+    size_t total = collected.events.size();
+    ASSERT_LE(collected.reals.size(), BEJ_BATCH_MAX_REALS);
+    EXPECT_EQ(collected.batches,
+              (total + test_case.capacity - 1) / test_case.capacity);
+
+    BejEventRange events(dictionaries, block);
+    size_t i = 0;
+    uint16_t depth = 0;
+    for (const BejCursorEvent& event : events)
+    {
+        ASSERT_LT(i, total);
+        const BejBatchEvent& batchEvent = collected.events[i++];
+        EXPECT_EQ(batchEvent.type, event.type);
+        EXPECT_EQ(batchEvent.propertyName, event.propertyName);
+        EXPECT_EQ(batchEvent.annotatedPropertyName,
+                  event.annotatedPropertyName);
+        EXPECT_EQ(batchEvent.id.dictPropOffset, event.id.dictPropOffset);
+        EXPECT_EQ(batchEvent.id.sequenceNumber, event.id.sequenceNumber);
+        if (event.propertyName != nullptr)
+        {
+            EXPECT_EQ(batchEvent.propertyNameLength,
+                      std::string(event.propertyName).size());
+        }
+        if (event.type == bejCursorSetEnd || event.type == bejCursorArrayEnd)
+        {
+            --depth;
+        }
+        EXPECT_EQ(batchEvent.depth, depth);
+        if (event.type == bejCursorSetStart ||
+            event.type == bejCursorArrayStart)
+        {
+            EXPECT_EQ(batchEvent.value.elementCount, event.value.elementCount);
+            ++depth;
+        }
+        else if (event.type == bejCursorInteger)
+        {
+            EXPECT_EQ(batchEvent.value.integer, event.value.integer);
+        }
+        else if (event.type == bejCursorString)
+        {
+            EXPECT_EQ(batchEvent.value.string, event.value.string.value);
+            EXPECT_EQ(batchEvent.valueLength, event.value.string.length);
+        }
+        else if (event.type == bejCursorReal)
+        {
+            expectReal(collected, batchEvent, event.value.real);
+        }
+    }
+    EXPECT_EQ(events.error(), 0);
+    EXPECT_EQ(i, total);
+    EXPECT_EQ(depth, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejBatchTest,
+    testing::ValuesIn<BejBatchTestParams>({
+        // A small batch makes sure that events are delivered across batches.
+        {"DriveOEM", driveOemTestFiles, 5},
+        {"Circuit", circuitTestFiles, 5},
+        {"Storage", storageTestFiles, 5},
+        {"DummySimple", dummySimpleTestFiles, 5},
+        {"SingleEvent", dummySimpleTestFiles, 1},
+        {"DefaultBatch", storageTestFiles, BEJ_BATCH_DEFAULT_EVENTS},
+    }),
+    [](const testing::TestParamInfo<BejBatchTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejBatchApiTest, FullLastBatch)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    size_t total = 0;
+    BejEventRange events(dictionaries, block);
+    for ([[maybe_unused]] const BejCursorEvent& event : events)
+    {
+        ++total;
+    }
+    ASSERT_EQ(events.error(), 0);
+
+    // The last batch is delivered once, without an empty batch after it.
+    std::vector<BejBatchEvent> batch(total);
+    CollectedBatches collected;
+    ASSERT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), batch.data(),
+                                        batch.size(), collectBatch,
+                                        &collected, nullptr),
+              0);
+    EXPECT_EQ(collected.batches, 1);
+    EXPECT_EQ(collected.events.size(), total);
+}
+
+/**
+ * @brief Stop the decoding at the first batch.
+ */
+int stopBatch(const BejBatchEvent* /*events*/, uint32_t count,
+              const BejReal* /*reals*/, void* dataPtr)
+{
+    *static_cast<uint32_t*>(dataPtr) += count;
+    return bejErrorNotSupported;
+}
+
+TEST(BejBatchApiTest, CallbackError)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejBatchEvent batch[2];
+    uint32_t delivered = 0;
+    EXPECT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), batch, 2, stopBatch,
+                                        &delivered, nullptr),
+              bejErrorNotSupported);
+    EXPECT_EQ(delivered, 2);
+    EXPECT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), batch, 0, stopBatch,
+                                        &delivered, nullptr),
+              bejErrorInvalidSize);
+    EXPECT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), nullptr, 2, stopBatch,
+                                        &delivered, nullptr),
+              bejErrorNullParameter);
+}
+
+TEST(BejBatchApiTest, ManyReals)
+{
+    auto inputsOrErr = loadInputs(circuitTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    // Four reals for each line, more than a batch holds.
+    constexpr std::array<const char*, 6> lines = {
+        "Line1ToNeutral", "Line2ToNeutral", "Line3ToNeutral",
+        "Line1ToLine2",   "Line2ToLine3",   "Line3ToLine1",
+    };
+    constexpr std::array<const char*, 4> readings = {
+        "Reading", "ApparentVA", "ReactiveVAR", "PowerFactor"};
+    RedfishPropertyParent root;
+    bejTreeInitSet(&root, "Circuit");
+    RedfishPropertyParent powerWatts;
+    bejTreeInitSet(&powerWatts, "PolyPhasePowerWatts");
+    bejTreeLinkChildToParent(&root, &powerWatts);
+    std::array<RedfishPropertyParent, lines.size()> lineSets;
+    std::array<RedfishPropertyLeafReal, lines.size() * readings.size()> reals;
+    for (size_t line = 0; line < lines.size(); ++line)
+    {
+        bejTreeInitSet(&lineSets[line], lines[line]);
+        bejTreeLinkChildToParent(&powerWatts, &lineSets[line]);
+        for (size_t reading = 0; reading < readings.size(); ++reading)
+        {
+            size_t index = line * readings.size() + reading;
+            bejTreeAddReal(&lineSets[line], &reals[index], readings[reading],
+                           static_cast<double>(index) + 0.5);
+        }
+    }
+    BejEncoderJson encoder;
+    ASSERT_EQ(encoder.encode(&dictionaries, bejMajorSchemaClass, &root), 0);
+    std::vector<uint8_t> block = encoder.getOutput();
+
+    std::vector<BejBatchEvent> batch(BEJ_BATCH_DEFAULT_EVENTS);
+    CollectedBatches collected;
+    ASSERT_EQ(bejDecodePldmBlockBatched(&dictionaries, block.data(),
+                                        block.size(), batch.data(),
+                                        batch.size(), collectBatch,
+                                        &collected, nullptr),
+              0);
+    // The events fit into one batch, but the reals don't.
+    ASSERT_EQ(collected.reals.size(), reals.size());
+    EXPECT_LT(collected.events.size(), batch.size());
+    EXPECT_EQ(collected.batches, 2);
+    EXPECT_EQ(collected.maxBatchReals, BEJ_BATCH_MAX_REALS);
+
+    size_t i = 0;
+    BejEventRange events(dictionaries, block);
+    for (const BejCursorEvent& event : events)
+    {
+        ASSERT_LT(i, collected.events.size());
+        const BejBatchEvent& batchEvent = collected.events[i++];
+        EXPECT_EQ(batchEvent.type, event.type);
+        if (event.type == bejCursorReal)
+        {
+            expectReal(collected, batchEvent, event.value.real);
+        }
+    }
+    EXPECT_EQ(events.error(), 0);
+    EXPECT_EQ(i, collected.events.size());
+}
+
+} // namespace libbej
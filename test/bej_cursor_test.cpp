@@ -0,0 +1,360 @@
+#include "bej_common_test.hpp"
+#include "bej_cursor.hpp"
+#include "bej_decoder_json.hpp"
+
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+static_assert(std::ranges::input_range<BejEventRange>);
+
+struct BejCursorTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+};
+
+void PrintTo(const BejCursorTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejCursorTest = testing::TestWithParam<BejCursorTestParams>;
+
+/**
+ * @brief Build a JSON object from the cursor events.
+ */
+nlohmann::json eventsToJson(BejEventRange& events)
+{
+    nlohmann::json root;
+    std::vector<nlohmann::json*> stack;
+    for (const BejCursorEvent& event : events)
+    {
+        if (event.type == bejCursorSetEnd || event.type == bejCursorArrayEnd)
+        {
+            EXPECT_EQ(event.propertyName, nullptr);
+            stack.pop_back();
+            continue;
+        }
+
+        nlohmann::json* value = &root;
+        if (!stack.empty())
+        {
+            if (stack.back()->is_array())
+            {
+                EXPECT_STREQ(event.propertyName, "");
+                value = &stack.back()->emplace_back();
+            }
+            else
+            {
+                std::string name = event.propertyName;
+                if (event.annotatedPropertyName != nullptr)
+                {
+                    name = event.annotatedPropertyName + name;
+                }
+                value = &(*stack.back())[name];
+            }
+        }
+
+        switch (event.type)
+        {
+            case bejCursorSetStart:
+                *value = nlohmann::json::object();
+                stack.push_back(value);
+                break;
+            case bejCursorArrayStart:
+                *value = nlohmann::json::array();
+                stack.push_back(value);
+                break;
+            case bejCursorNull:
+                *value = nullptr;
+                break;
+            case bejCursorInteger:
+                *value = event.value.integer;
+                break;
+            case bejCursorEnum:
+                *value = event.value.enumValue;
+                break;
+            case bejCursorString:
+                *value = std::string(event.value.string.value,
+                                     event.value.string.length);
+                break;
+            case bejCursorReal:
+            {
+                const BejReal& real = event.value.real;
+                std::string text = std::to_string(real.whole) + "." +
+                                   std::string(real.zeroCount, '0') +
+                                   std::to_string(real.fract);
+                if (real.expLen != 0)
+                {
+                    text += "e" + std::to_string(real.exp);
+                }
+                *value = nlohmann::json::parse(text);
+                break;
+            }
+            case bejCursorBool:
+                *value = event.value.boolean;
+                break;
+            case bejCursorResourceLink:
+                *value = "/redfish/v1/" + std::to_string(event.value.linkId);
+                break;
+            default:
+                ADD_FAILURE() << "Unexpected event: " << event.type;
+                break;
+        }
+    }
+    EXPECT_TRUE(stack.empty());
+    return root;
+}
+
+TEST_P(BejCursorTest, Events)
+{
+    const BejCursorTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+
+    BejEventRange events(dictionaries, inputsOrErr->encodedStream);
+    nlohmann::json jsonDecoded = eventsToJson(events);
+    EXPECT_EQ(events.error(), 0);
+    EXPECT_EQ(jsonDecoded, nlohmann::json::parse(decoder.getOutput()));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejCursorTest,
+    testing::ValuesIn<BejCursorTestParams>({
+        {"DriveOEM",
+         {"../test/json/drive_oem.json",
+          "../test/dictionaries/drive_oem_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/drive_oem_enc.bin"}},
+        {"Circuit",
+         {"../test/json/circuit.json", "../test/dictionaries/circuit_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/circuit_enc.bin"}},
+        {"Storage",
+         {"../test/json/storage.json", "../test/dictionaries/storage_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/storage_enc.bin"}},
+        {"DummySimple",
+         {"../test/json/dummysimple.json",
+          "../test/dictionaries/dummy_simple_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/dummy_simple_enc.bin"}},
+    }),
+    [](const testing::TestParamInfo<BejCursorTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST_P(BejCursorTest, PropertyIds)
+{
+    const BejCursorTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejEventRange events(dictionaries, inputsOrErr->encodedStream);
+    for (const BejCursorEvent& event : events)
+    {
+        if (event.propertyName == nullptr)
+        {
+            EXPECT_EQ(event.id.dictPropOffset, 0);
+            continue;
+        }
+        // The identity finds the same name in the dictionary.
+        const uint8_t* dictionary = (event.id.schema == bejAnnotation)
+                                        ? dictionaries.annotationDictionary
+                                        : dictionaries.schemaDictionary;
+        ASSERT_GT(event.id.dictPropOffset, 0);
+        const BejDictionaryProperty* property =
+            reinterpret_cast<const BejDictionaryProperty*>(
+                dictionary + event.id.dictPropOffset);
+        const char* name = bejDictGetPropertyName(
+            dictionary, property->nameOffset, property->nameLength);
+        EXPECT_EQ(event.id.nameLength, std::string(name).size());
+        if (event.propertyName[0] != '\0')
+        {
+            EXPECT_STREQ(name, event.propertyName);
+            EXPECT_EQ(event.id.sequenceNumber, property->sequenceNumber);
+        }
+    }
+    EXPECT_EQ(events.error(), 0);
+}
+
+const BejTestInputFiles dummySimpleTestFiles = {
+    .jsonFile = "../test/json/dummysimple.json",
+    .schemaDictionaryFile = "../test/dictionaries/dummy_simple_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
+};
+
+TEST(BejCursorApiTest, EndOfBlock)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejCursor cursor;
+    ASSERT_EQ(bejCursorInit(&cursor, &dictionaries, block.data(),
+                            block.size(), nullptr),
+              0);
+    const BejCursorEvent* event;
+    ASSERT_EQ(bejCursorNext(&cursor, &event), 0);
+    ASSERT_NE(event, nullptr);
+    EXPECT_EQ(event->type, bejCursorSetStart);
+    EXPECT_STREQ(event->propertyName, "");
+    EXPECT_EQ(event->annotatedPropertyName, nullptr);
+
+    uint32_t events = 1;
+    while (event != nullptr)
+    {
+        ASSERT_EQ(bejCursorNext(&cursor, &event), 0);
+        ++events;
+    }
+    EXPECT_GT(events, 2);
+    // The cursor stays at the end.
+    ASSERT_EQ(bejCursorNext(&cursor, &event), 0);
+    EXPECT_EQ(event, nullptr);
+}
+
+TEST(BejCursorApiTest, Projection)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejPath path;
+    ASSERT_EQ(bejPathResolve(&dictionaries, "ChildArrayProperty/*/LinkStatus",
+                             &path),
+              0);
+    BejProjection projection = {
+        .paths = &path,
+        .count = 1,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingIgnore,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = nullptr,
+        .projection = &projection,
+        .callbackExtensions = nullptr,
+    };
+    BejEventRange events(dictionaries, inputsOrErr->encodedStream, &options);
+    nlohmann::json jsonDecoded = eventsToJson(events);
+    EXPECT_EQ(events.error(), 0);
+    EXPECT_EQ(jsonDecoded, nlohmann::json::parse(R"({"ChildArrayProperty": [
+                {"LinkStatus": "NoLink"}, {"LinkStatus": "LinkDown"}]})"));
+}
+
+TEST(BejCursorApiTest, TruncatedBlock)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::vector<uint8_t> block(inputsOrErr->encodedStream.begin(),
+                               inputsOrErr->encodedStream.end());
+    // The root value length now runs past the end of the block.
+    block.pop_back();
+
+    BejEventRange events(dictionaries, block);
+    EXPECT_EQ(events.begin(), events.end());
+    EXPECT_EQ(events.error(), bejErrorInvalidSize);
+}
+
+/**
+ * @brief Count the names and the identities passed by the decoder.
+ */
+struct PropertyIdCounts
+{
+    uint32_t names = 0;
+    uint32_t ids = 0;
+    uint32_t lastSequenceNumber = 0;
+};
+
+int countId(const BejPropertyId* id, void* dataPtr)
+{
+    auto* counts = static_cast<PropertyIdCounts*>(dataPtr);
+    ++counts->ids;
+    counts->lastSequenceNumber = id->sequenceNumber;
+    return 0;
+}
+
+int countName(const char* /*propertyName*/, void* dataPtr)
+{
+    ++static_cast<PropertyIdCounts*>(dataPtr)->names;
+    return 0;
+}
+
+int countEnumName(const char* /*propertyName*/, const char* /*value*/,
+                  void* dataPtr)
+{
+    ++static_cast<PropertyIdCounts*>(dataPtr)->names;
+    return 0;
+}
+
+TEST(BejCursorApiTest, PropertyIdCallback)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecodedCallback decodedCallback{};
+    decodedCallback.callbackSetStart = countName;
+    decodedCallback.callbackArrayStart = countName;
+    decodedCallback.callbackNull = countName;
+    decodedCallback.callbackAnnotation = countName;
+    decodedCallback.callbackEnum = countEnumName;
+    BejDecodedCallbackExtensions callbackExtensions{};
+    callbackExtensions.callbackPropertyId = countId;
+    std::vector<BejStackProperty> stackEntries(BEJ_MAX_STACK_DEPTH);
+    BejStackStorage stackStorage = {
+        .entries = stackEntries.data(),
+        .capacity = static_cast<uint32_t>(stackEntries.size()),
+        .size = 0,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingIgnore,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+        .projection = nullptr,
+        .callbackExtensions = &callbackExtensions,
+    };
+    PropertyIdCounts counts;
+    ASSERT_EQ(bejDecodePldmBlockWithOptions(&dictionaries, block.data(),
+                                            block.size(), nullptr,
+                                            &decodedCallback, &counts, nullptr,
+                                            &options),
+              0);
+
+    // Every property has an identity, whether its callback is set or not.
+    uint32_t properties = 0;
+    BejEventRange events(dictionaries, block);
+    for (const BejCursorEvent& event : events)
+    {
+        if (event.propertyName != nullptr)
+        {
+            ++properties;
+        }
+    }
+    EXPECT_GT(counts.names, 0);
+    EXPECT_LT(counts.names, counts.ids);
+    EXPECT_GE(counts.ids, properties);
+    // The last property is LinkStatus, which follows AnotherBoolean in the
+    // dictionary.
+    EXPECT_EQ(counts.lastSequenceNumber, 1);
+}
+
+} // namespace libbej
@@ -0,0 +1,140 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_decoder_nlohmann.hpp"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejDecoderNlohmannTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+};
+
+void PrintTo(const BejDecoderNlohmannTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejDecoderNlohmannTest =
+    testing::TestWithParam<BejDecoderNlohmannTestParams>;
+
+const BejTestInputFiles dummySimpleTestFiles = {
+    .jsonFile = "../test/json/dummysimple.json",
+    .schemaDictionaryFile = "../test/dictionaries/dummy_simple_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
+};
+
+TEST_P(BejDecoderNlohmannTest, Decode)
+{
+    const BejDecoderNlohmannTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson jsonDecoder;
+    ASSERT_EQ(jsonDecoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+
+    BejDecoderNlohmann decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    EXPECT_EQ(decoder.getOutput(),
+              nlohmann::json::parse(jsonDecoder.getOutput()));
+
+    // The decoder can be reused.
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    EXPECT_EQ(decoder.getOutput(),
+              nlohmann::json::parse(jsonDecoder.getOutput()));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejDecoderNlohmannTest,
+    testing::ValuesIn<BejDecoderNlohmannTestParams>({
+        {"DriveOEM",
+         {"../test/json/drive_oem.json",
+          "../test/dictionaries/drive_oem_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/drive_oem_enc.bin"}},
+        {"Circuit",
+         {"../test/json/circuit.json", "../test/dictionaries/circuit_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/circuit_enc.bin"}},
+        {"Storage",
+         {"../test/json/storage.json", "../test/dictionaries/storage_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/storage_enc.bin"}},
+        {"DummySimple",
+         {"../test/json/dummysimple.json",
+          "../test/dictionaries/dummy_simple_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/dummy_simple_enc.bin"}},
+    }),
+    [](const testing::TestParamInfo<BejDecoderNlohmannTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejDecoderNlohmannErrorTest, TruncatedBlock)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderNlohmann decoder;
+    EXPECT_EQ(decoder.decode(dictionaries, block.first(block.size() - 1)),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDecoderNlohmannErrorTest, HugeElementCount)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    // ChildArrayProperty claiming 2^64 - 1 elements without any.
+    std::vector<uint8_t> encodedStream = {
+        0x00, 0xF0, 0xF0, 0xF1, 0x00, 0x00, 0x00, // PLDM header
+        0x01, 0x00, 0x00, 0x01, 0x10,             // Root set, 16 bytes
+        0x01, 0x01,                               // 1 element
+        0x01, 0x00, 0x10, 0x01, 0x09,             // ChildArrayProperty
+        0x08, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+
+    // The element count is not trusted for reserving memory.
+    BejDecoderNlohmann decoder;
+    EXPECT_NO_THROW(decoder.decode(dictionaries, std::span(encodedStream)));
+}
+
+TEST(BejDecoderNlohmannValueTest, ResourceLink)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    // Root set holding Id as a resource link to PDR 42.
+    std::vector<uint8_t> encodedStream = {
+        0x00, 0xF0, 0xF0, 0xF1, 0x00, 0x00, 0x00, // PLDM header
+        0x01, 0x00, 0x00, 0x01, 0x09,             // Root set, 9 bytes
+        0x01, 0x01,                               // 1 element
+        0x01, 0x02, 0xE0, 0x01, 0x02, 0x01, 0x2A, // Id, %L42
+    };
+
+    BejDecoderJson jsonDecoder;
+    ASSERT_EQ(jsonDecoder.decode(dictionaries, std::span(encodedStream)), 0);
+
+    BejDecoderNlohmann decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, std::span(encodedStream)), 0);
+    EXPECT_EQ(decoder.getOutput()["Id"], "%L42");
+    EXPECT_EQ(decoder.getOutput(),
+              nlohmann::json::parse(jsonDecoder.getOutput()));
+}
+
+} // namespace libbej
@@ -1,9 +1,16 @@
 #include "bej_common_test.hpp"
 #include "bej_decoder_json.hpp"
+#include "bej_dictionary_index.h"
 #include "bej_encoder_json.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <array>
+#include <chrono>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock-matchers.h>
@@ -58,19 +65,6 @@ const BejTestInputFiles dummySimpleTestFiles = {
     .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
 };
 
-// Build a BejDictionaries view over already-loaded test inputs.
-BejDictionaries makeDictionaries(const BejTestInputs& inputs)
-{
-    return BejDictionaries{
-        .schemaDictionary = inputs.schemaDictionary,
-        .schemaDictionarySize = inputs.schemaDictionarySize,
-        .annotationDictionary = inputs.annotationDictionary,
-        .annotationDictionarySize = inputs.annotationDictionarySize,
-        .errorDictionary = inputs.errorDictionary,
-        .errorDictionarySize = inputs.errorDictionarySize,
-    };
-}
-
 TEST_P(BejDecoderTest, Decode)
 {
     const BejDecoderTestParams& test_case = GetParam();
@@ -98,6 +92,554 @@ TEST_P(BejDecoderTest, Decode)
     EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
 }
 
+TEST_P(BejDecoderTest, DecodeWithIndexes)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    std::vector<uint32_t> schemaBuffer(
+        bejDictIndexGetBufferSize(dictionaries.schemaDictionary,
+                                  dictionaries.schemaDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    std::vector<uint32_t> annotationBuffer(
+        bejDictIndexGetBufferSize(dictionaries.annotationDictionary,
+                                  dictionaries.annotationDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex schemaIndex;
+    BejDictionaryIndex annotationIndex;
+    ASSERT_EQ(bejDictBuildIndex(dictionaries.schemaDictionary,
+                                dictionaries.schemaDictionarySize,
+                                schemaBuffer.data(),
+                                schemaBuffer.size() * sizeof(uint32_t),
+                                &schemaIndex),
+              0);
+    ASSERT_EQ(bejDictBuildIndex(dictionaries.annotationDictionary,
+                                dictionaries.annotationDictionarySize,
+                                annotationBuffer.data(),
+                                annotationBuffer.size() * sizeof(uint32_t),
+                                &annotationIndex),
+              0);
+    BejDictionaryIndexes indexes = {
+        .schemaIndex = &schemaIndex,
+        .annotationIndex = &annotationIndex,
+    };
+
+    BejDecoderJson decoder;
+    decoder.setDictionaryIndexes(&indexes);
+    EXPECT_THAT(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+TEST_P(BejDecoderTest, DecodePrepared)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    std::vector<uint32_t> schemaBuffer(
+        bejDictIndexGetBufferSize(inputsOrErr->schemaDictionary,
+                                  inputsOrErr->schemaDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    std::vector<uint32_t> annotationBuffer(
+        bejDictIndexGetBufferSize(inputsOrErr->annotationDictionary,
+                                  inputsOrErr->annotationDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex schemaIndex;
+    BejDictionaryIndex annotationIndex;
+    ASSERT_EQ(bejDictPrepare(inputsOrErr->schemaDictionary,
+                             inputsOrErr->schemaDictionarySize,
+                             schemaBuffer.data(),
+                             schemaBuffer.size() * sizeof(uint32_t),
+                             &schemaIndex),
+              0);
+    ASSERT_EQ(bejDictPrepare(inputsOrErr->annotationDictionary,
+                             inputsOrErr->annotationDictionarySize,
+                             annotationBuffer.data(),
+                             annotationBuffer.size() * sizeof(uint32_t),
+                             &annotationIndex),
+              0);
+    BejDictionaryIndexes preparedDictionaries = {
+        .schemaIndex = &schemaIndex,
+        .annotationIndex = &annotationIndex,
+    };
+
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decodePrepared(preparedDictionaries,
+                                       inputsOrErr->encodedStream),
+                0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+// Stack callbacks over a std::vector, used to compare with the stack storage.
+bool vectorStackEmpty(void* dataPtr)
+{
+    return static_cast<std::vector<BejStackProperty>*>(dataPtr)->empty();
+}
+
+const BejStackProperty* vectorStackPeek(void* dataPtr)
+{
+    auto stack = static_cast<std::vector<BejStackProperty>*>(dataPtr);
+    return stack->empty() ? nullptr : &stack->back();
+}
+
+void vectorStackPop(void* dataPtr)
+{
+    auto stack = static_cast<std::vector<BejStackProperty>*>(dataPtr);
+    if (!stack->empty())
+    {
+        stack->pop_back();
+    }
+}
+
+int vectorStackPush(const BejStackProperty* const property, void* dataPtr)
+{
+    static_cast<std::vector<BejStackProperty>*>(dataPtr)->push_back(*property);
+    return 0;
+}
+
+int countSetStart(const char* /*propertyName*/, void* dataPtr)
+{
+    ++*static_cast<int*>(dataPtr);
+    return 0;
+}
+
+TEST_P(BejDecoderTest, DecodeWithStackStorage)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecodedCallback decodedCallback{};
+    decodedCallback.callbackSetStart = countSetStart;
+
+    std::vector<BejStackProperty> vectorStack;
+    BejStackCallback stackCallback = {
+        .stackEmpty = vectorStackEmpty,
+        .stackPeek = vectorStackPeek,
+        .stackPop = vectorStackPop,
+        .stackPush = vectorStackPush,
+    };
+    int callbackSets = 0;
+    ASSERT_EQ(bejDecodePldmBlock(
+                  &dictionaries, inputsOrErr->encodedStream.data(),
+                  inputsOrErr->encodedStream.size_bytes(), &stackCallback,
+                  &decodedCallback, &callbackSets, &vectorStack),
+              0);
+
+    std::array<BejStackProperty, BEJ_MAX_STACK_DEPTH> entries;
+    BejStackStorage stackStorage = {
+        .entries = entries.data(),
+        .capacity = entries.size(),
+        .size = 0,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingIgnore,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+        .projection = nullptr,
+        .callbackExtensions = nullptr,
+    };
+    int storageSets = 0;
+    ASSERT_EQ(bejDecodePldmBlockWithOptions(
+                  &dictionaries, inputsOrErr->encodedStream.data(),
+                  inputsOrErr->encodedStream.size_bytes(), nullptr,
+                  &decodedCallback, &storageSets, nullptr, &options),
+              0);
+    EXPECT_GT(storageSets, 0);
+    EXPECT_EQ(storageSets, callbackSets);
+    EXPECT_EQ(stackStorage.size, 0);
+}
+
+TEST_P(BejDecoderTest, DecodeInChunks)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+
+    // Every chunk size splits the header and the tuples at different places.
+    for (size_t chunkSize = 1; chunkSize <= block.size(); ++chunkSize)
+    {
+        ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+        for (size_t offset = 0; offset < block.size(); offset += chunkSize)
+        {
+            ASSERT_EQ(decoder.decodeChunk(block.subspan(
+                          offset, std::min(chunkSize, block.size() - offset))),
+                      0);
+        }
+        ASSERT_EQ(decoder.decodeEnd(), 0);
+        EXPECT_EQ(decoder.getOutput(), expected) << "chunkSize: " << chunkSize;
+    }
+}
+
+TEST_P(BejDecoderTest, DecodeWithBudget)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+
+    const auto never = std::chrono::steady_clock::time_point::max();
+    const auto past = std::chrono::steady_clock::time_point::min();
+    for (const auto& [maxTuples, deadline] :
+         {std::pair{1u, never}, std::pair{3u, never}, std::pair{0u, past}})
+    {
+        for (size_t chunkSize : {block.size(), size_t{5}})
+        {
+            ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+            uint32_t yields = 0;
+            for (size_t offset = 0; offset < block.size(); offset += chunkSize)
+            {
+                std::span<const uint8_t> chunk = block.subspan(
+                    offset, std::min(chunkSize, block.size() - offset));
+                size_t consumed = 0;
+                int ret;
+                while ((ret = decoder.decodeChunk(chunk, maxTuples, deadline,
+                                                  consumed)) ==
+                       bejErrorWouldBlock)
+                {
+                    ASSERT_LT(consumed, chunk.size());
+                    chunk = chunk.subspan(consumed);
+                    ++yields;
+                }
+                ASSERT_EQ(ret, 0);
+                EXPECT_EQ(consumed, chunk.size());
+            }
+            ASSERT_EQ(decoder.decodeEnd(), 0);
+            EXPECT_EQ(decoder.getOutput(), expected)
+                << "maxTuples: " << maxTuples << " chunkSize: " << chunkSize;
+            if (chunkSize == block.size())
+            {
+                EXPECT_GT(yields, 0);
+            }
+        }
+    }
+}
+
+TEST_P(BejDecoderTest, DecodeSegments)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+
+    // Split the block into segments of growing sizes with an empty segment
+    // in between.
+    std::vector<std::span<const uint8_t>> segments;
+    size_t offset = 0;
+    for (size_t size = 1; offset < block.size(); ++size)
+    {
+        size = std::min(size, block.size() - offset);
+        segments.push_back(block.subspan(offset, size));
+        segments.push_back(block.subspan(offset + size, 0));
+        offset += size;
+    }
+    ASSERT_EQ(decoder.decodeSegments(dictionaries, segments), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+}
+
+TEST_P(BejDecoderTest, DecodeToSink)
+{
+    const BejDecoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+
+    std::vector<std::string> pieces;
+    decoder.setOutputSink(
+        [&pieces](std::string_view data) {
+            pieces.emplace_back(data);
+            return 0;
+        },
+        16);
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    EXPECT_TRUE(decoder.getOutput().empty());
+    EXPECT_GT(pieces.size(), 1);
+    std::string joined;
+    for (const std::string& piece : pieces)
+    {
+        EXPECT_FALSE(piece.empty());
+        joined += piece;
+    }
+    EXPECT_EQ(joined, expected);
+
+    // Same for a block received in chunks.
+    pieces.clear();
+    ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+    for (size_t offset = 0; offset < block.size(); offset += 7)
+    {
+        ASSERT_EQ(decoder.decodeChunk(block.subspan(
+                      offset, std::min<size_t>(7, block.size() - offset))),
+                  0);
+    }
+    ASSERT_EQ(decoder.decodeEnd(), 0);
+    joined.clear();
+    for (const std::string& piece : pieces)
+    {
+        joined += piece;
+    }
+    EXPECT_EQ(joined, expected);
+
+    // Back to keeping the output in memory.
+    decoder.setOutputSink(nullptr);
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+}
+
+TEST(BejDecoderSinkTest, SinkError)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson decoder;
+    uint32_t calls = 0;
+    decoder.setOutputSink(
+        [&calls](std::string_view /*data*/) {
+            ++calls;
+            return -1;
+        },
+        1);
+    EXPECT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), -1);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(BejDecoderSinkTest, FdSink)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    const std::string expected = decoder.getOutput();
+
+    std::unique_ptr<FILE, decltype(&fclose)> file(tmpfile(), fclose);
+    ASSERT_NE(file, nullptr);
+    decoder.setOutputSink(makeFdOutputSink(fileno(file.get())), 64);
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+
+    std::string written(expected.size() + 1, '\0');
+    rewind(file.get());
+    ASSERT_EQ(fread(written.data(), 1, written.size(), file.get()),
+              expected.size());
+    written.resize(expected.size());
+    EXPECT_EQ(written, expected);
+}
+
+TEST(BejDecoderVectoredTest, RingBufferWraparound)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    // The block starts near the end of the ring and wraps to its start.
+    std::vector<uint8_t> ring(block.size() + 16);
+    const size_t start = ring.size() - 100;
+    std::copy_n(block.begin(), 100, ring.begin() + start);
+    std::copy(block.begin() + 100, block.end(), ring.begin());
+    std::array<BejIoVec, 2> segments = {{
+        {.base = ring.data() + start, .length = 100},
+        {.base = ring.data(),
+         .length = static_cast<uint32_t>(block.size() - 100)},
+    }};
+
+    BejDecodedCallback decodedCallback{};
+    std::array<BejStackProperty, BEJ_MAX_STACK_DEPTH> entries;
+    BejStackStorage stackStorage = {
+        .entries = entries.data(),
+        .capacity = entries.size(),
+        .size = 0,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingError,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+        .projection = nullptr,
+        .callbackExtensions = nullptr,
+    };
+    std::array<uint8_t, 128> bounceBuffer;
+    EXPECT_EQ(bejDecodePldmBlockVectored(&dictionaries, segments.data(),
+                                         segments.size(), nullptr,
+                                         &decodedCallback, nullptr, nullptr,
+                                         bounceBuffer.data(),
+                                         bounceBuffer.size(), &options),
+              0);
+    EXPECT_EQ(stackStorage.size, 0);
+
+    // Without the second segment the block is incomplete.
+    EXPECT_EQ(bejDecodePldmBlockVectored(&dictionaries, segments.data(), 1,
+                                         nullptr, &decodedCallback, nullptr,
+                                         nullptr, bounceBuffer.data(),
+                                         bounceBuffer.size(), &options),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDecoderIncrementalTest, SplitTupleTooLarge)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    // Tuple headers do not fit in 4 bytes once they are split. Strings are
+    // passed in fragments, so they don't have to fit.
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decodeBegin(dictionaries, 4), 0);
+    int ret = 0;
+    for (size_t offset = 0; offset < block.size() && ret == 0; ++offset)
+    {
+        ret = decoder.decodeChunk(block.subspan(offset, 1));
+    }
+    EXPECT_EQ(ret, bejErrorInvalidSize);
+}
+
+TEST(BejDecoderIncrementalTest, IncompleteBlock)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+    ASSERT_EQ(decoder.decodeChunk(block.first(block.size() - 1)), 0);
+    EXPECT_EQ(decoder.decodeEnd(), bejErrorInvalidSize);
+}
+
+TEST(BejDecoderIncrementalTest, TrailingBytes)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+    const std::array<uint8_t, 4> padding = {0, 0, 0, 0};
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+    ASSERT_EQ(decoder.decodeChunk(block), 0);
+    ASSERT_EQ(decoder.decodeChunk(padding), 0);
+    EXPECT_EQ(decoder.decodeEnd(), 0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_EQ(jsonDecoded.dump(), inputsOrErr->expectedJson.dump());
+
+    decoder.setTrailingDataPolicy(bejTrailingError);
+    ASSERT_EQ(decoder.decodeBegin(dictionaries), 0);
+    ASSERT_EQ(decoder.decodeChunk(block), 0);
+    ASSERT_EQ(decoder.decodeChunk(padding), 0);
+    EXPECT_EQ(decoder.decodeEnd(), bejErrorInvalidSize);
+}
+
+TEST(BejDecoderStackStorageTest, StorageTooSmall)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecodedCallback decodedCallback{};
+    std::array<BejStackProperty, 1> entries;
+    BejStackStorage stackStorage = {
+        .entries = entries.data(),
+        .capacity = entries.size(),
+        .size = 0,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingIgnore,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+        .projection = nullptr,
+        .callbackExtensions = nullptr,
+    };
+    EXPECT_EQ(bejDecodePldmBlockWithOptions(
+                  &dictionaries, inputsOrErr->encodedStream.data(),
+                  inputsOrErr->encodedStream.size_bytes(), nullptr,
+                  &decodedCallback, nullptr, nullptr, &options),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDecoderStackStorageTest, JsonDecoderStorage)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    // The JSON decoder uses a std::vector unless storage is provided.
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    std::string expected = decoder.getOutput();
+
+    std::array<BejStackProperty, BEJ_MAX_STACK_DEPTH> entries;
+    decoder.setStackStorage(entries);
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+
+    std::array<BejStackProperty, 1> smallEntries;
+    decoder.setStackStorage(smallEntries);
+    EXPECT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream),
+              bejErrorInvalidSize);
+
+    decoder.setStackStorage({});
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+}
+
+TEST(BejDecoderPreparedTest, RequiresPreparedDictionaries)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    std::vector<uint32_t> schemaBuffer(
+        bejDictIndexGetBufferSize(inputsOrErr->schemaDictionary,
+                                  inputsOrErr->schemaDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex schemaIndex;
+    ASSERT_EQ(bejDictBuildIndex(inputsOrErr->schemaDictionary,
+                                inputsOrErr->schemaDictionarySize,
+                                schemaBuffer.data(),
+                                schemaBuffer.size() * sizeof(uint32_t),
+                                &schemaIndex),
+              0);
+    BejDictionaryIndexes indexes = {
+        .schemaIndex = &schemaIndex,
+        .annotationIndex = nullptr,
+    };
+
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decodePrepared(indexes, inputsOrErr->encodedStream),
+                bejErrorNotSupported);
+}
+
 /**
  * TODO: Add more test cases.
  * - Test Enums inside array elements
@@ -276,6 +818,113 @@ TEST(BejDecoderSecurityTest, StringTooLong)
                 bejErrorInvalidSize);
 }
 
+/**
+ * @brief Encode a DummySimple resource holding only an Id.
+ */
+std::vector<uint8_t> encodeId(const BejDictionaries& dictionaries,
+                              const std::string& id)
+{
+    auto root = std::make_unique<RedfishPropertyParent>();
+    bejTreeInitSet(root.get(), "DummySimple");
+    auto stringProp = std::make_unique<RedfishPropertyLeafString>();
+    bejTreeAddString(root.get(), stringProp.get(), "Id", id.c_str());
+
+    libbej::BejEncoderJson encoder;
+    EXPECT_EQ(encoder.encode(&dictionaries, bejMajorSchemaClass, root.get()),
+              0);
+    return encoder.getOutput();
+}
+
+/**
+ * @brief Decode a block in chunks of the same size.
+ *
+ * @return the first error or the result of decodeEnd().
+ */
+int decodeInChunks(BejDecoderJson& decoder,
+                   const BejDictionaries& dictionaries,
+                   std::span<const uint8_t> block, size_t chunkSize,
+                   uint32_t maxSplitTupleSize)
+{
+    int ret = decoder.decodeBegin(dictionaries, maxSplitTupleSize);
+    for (size_t offset = 0; offset < block.size() && ret == 0;
+         offset += chunkSize)
+    {
+        ret = decoder.decodeChunk(
+            block.subspan(offset, std::min(chunkSize, block.size() - offset)));
+    }
+    return (ret == 0) ? decoder.decodeEnd() : ret;
+}
+
+TEST(BejDecoderStringTest, LongStringInChunks)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    // Escaped characters and UTF-8 sequences end up split between chunks.
+    std::string id;
+    while (id.size() < 200000)
+    {
+        id += "log \"entry\"\n caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 ";
+    }
+    std::vector<uint8_t> block = encodeId(dictionaries, id);
+
+    BejDecoderJson decoder;
+    decoder.setMaxStringLength(id.size() + 1);
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+    EXPECT_EQ(nlohmann::json::parse(expected)["Id"], id);
+
+    constexpr size_t flushSize = 1024;
+    std::vector<std::string> pieces;
+    decoder.setOutputSink(
+        [&pieces](std::string_view data) {
+            pieces.emplace_back(data);
+            return 0;
+        },
+        flushSize);
+    for (size_t chunkSize : {1, 7, 4096})
+    {
+        // The split tuple buffer is much smaller than the string.
+        pieces.clear();
+        ASSERT_EQ(decodeInChunks(decoder, dictionaries, block, chunkSize, 64),
+                  0);
+        std::string joined;
+        size_t largest = 0;
+        for (const std::string& piece : pieces)
+        {
+            joined += piece;
+            largest = std::max(largest, piece.size());
+        }
+        EXPECT_EQ(joined, expected) << "chunkSize: " << chunkSize;
+        // The string is passed to the sink as it arrives. A byte is escaped
+        // to at most 6 characters.
+        EXPECT_LT(largest, flushSize + 6 * chunkSize)
+            << "chunkSize: " << chunkSize;
+    }
+}
+
+TEST(BejDecoderStringTest, MaxStringLength)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::vector<uint8_t> block = encodeId(dictionaries, std::string(100, 'a'));
+
+    // The limit includes the NULL terminator.
+    BejDecoderJson decoder;
+    decoder.setMaxStringLength(100);
+    EXPECT_EQ(decoder.decode(dictionaries, block), bejErrorInvalidSize);
+    EXPECT_EQ(decodeInChunks(decoder, dictionaries, block, 5, 64),
+              bejErrorInvalidSize);
+
+    decoder.setMaxStringLength(101);
+    EXPECT_EQ(decoder.decode(dictionaries, block), 0);
+    const std::string expected = decoder.getOutput();
+    EXPECT_EQ(decodeInChunks(decoder, dictionaries, block, 5, 64), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+}
+
 TEST(BejDecoderSecurityTest, ValueBeyondStreamLength)
 {
     auto inputsOrErr = loadInputs(dummySimpleTestFiles);
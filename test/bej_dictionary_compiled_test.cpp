@@ -0,0 +1,97 @@
+#include "annotation_dict.h"
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "drive_oem_dict.h"
+#include "dummy_simple_dict.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+// Compiled dictionaries are prepared at build time.
+static_assert(dummySimpleIndex.validatedSize == sizeof(dummySimpleDictionary));
+static_assert(dummySimpleIndex.entryCount == 12);
+static_assert(driveOemIndex.dictionary == driveOemDictionary);
+
+TEST(BejDictionaryCompiledTest, MatchesRuntimeIndex)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize size =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_EQ(static_cast<size_t>(size), sizeof(dummySimpleDictionary));
+    EXPECT_TRUE(std::equal(std::begin(dummySimpleDictionary),
+                           std::end(dummySimpleDictionary),
+                           dictionary.begin()));
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), size) / sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    ASSERT_EQ(bejDictPrepare(dictionary.data(), size, buffer.data(),
+                             buffer.size() * sizeof(uint32_t), &index),
+              0);
+    ASSERT_EQ(dummySimpleIndex.tablesLength, index.tablesLength);
+    EXPECT_TRUE(bejDictIndexIsPrepared(&dummySimpleIndex));
+    EXPECT_EQ(dummySimpleIndex.preparedSeal, index.preparedSeal);
+    EXPECT_TRUE(std::equal(index.rangeSlots,
+                           index.rangeSlots + index.entryCount,
+                           dummySimpleIndex.rangeSlots));
+    EXPECT_TRUE(std::equal(index.tables, index.tables + index.tablesLength,
+                           dummySimpleIndex.tables));
+}
+
+TEST(BejDictionaryCompiledTest, LookupUsingCompiledIndex)
+{
+    const BejDictionaryProperty* property = nullptr;
+    uint16_t offset = 0;
+    ASSERT_EQ(bejDictIndexGetPropertyByName(
+                  dummySimpleDictionary, &dummySimpleIndex,
+                  bejDictGetPropertyHeadOffset() +
+                      sizeof(BejDictionaryProperty),
+                  "SampleIntegerProperty", &property, &offset),
+              0);
+    EXPECT_EQ(property->sequenceNumber, 3);
+
+    const BejDictionaryProperty* bySequence = nullptr;
+    ASSERT_EQ(bejDictIndexGetProperty(dummySimpleDictionary, &dummySimpleIndex,
+                                      bejDictGetPropertyHeadOffset() +
+                                          sizeof(BejDictionaryProperty),
+                                      3, &bySequence),
+              0);
+    EXPECT_EQ(bySequence, property);
+}
+
+TEST(BejDictionaryCompiledTest, DecodeUsingCompiledDictionaries)
+{
+    const BejTestInputFiles driveOemTestFiles = {
+        .jsonFile = "../test/json/drive_oem.json",
+        .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+        .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+        .errorDictionaryFile = "",
+        .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+    };
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    BejDictionaryIndexes compiledDictionaries = {
+        .schemaIndex = &driveOemIndex,
+        .annotationIndex = &annotationIndex,
+    };
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decodePrepared(compiledDictionaries,
+                                       inputsOrErr->encodedStream),
+                0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+} // namespace libbej
@@ -0,0 +1,199 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_dictionary_file.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+constexpr const char* dummySimpleDictFile =
+    "../test/dictionaries/dummy_simple_dict.bin";
+constexpr const char* annotationDictFile =
+    "../test/dictionaries/annotation_dict.bin";
+
+/**
+ * @brief Get a sidecar path in the test temporary directory.
+ */
+std::string sidecarPath(const std::string& name)
+{
+    std::string path = testing::TempDir() + "bej_" + name + "_" +
+                       std::to_string(getpid()) + ".idx";
+    unlink(path.c_str());
+    return path;
+}
+
+TEST(BejDictionaryFileTest, OpenWithoutSidecar)
+{
+    auto mapped = MappedDictionary::open(dummySimpleDictFile);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_FALSE(mapped->indexFromSidecar());
+    EXPECT_TRUE(bejDictIndexIsPrepared(mapped->index()));
+
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize size =
+        readBinaryFile(dummySimpleDictFile, std::span(dictionary));
+    ASSERT_EQ(mapped->data().size(), static_cast<size_t>(size));
+    EXPECT_TRUE(std::equal(mapped->data().begin(), mapped->data().end(),
+                           dictionary.begin()));
+}
+
+TEST(BejDictionaryFileTest, MissingFile)
+{
+    EXPECT_EQ(MappedDictionary::open("../test/dictionaries/missing.bin"),
+              nullptr);
+}
+
+TEST(BejDictionaryFileTest, SidecarIsWrittenAndReused)
+{
+    std::string indexPath = sidecarPath("reused");
+    auto first = MappedDictionary::open(annotationDictFile, indexPath);
+    ASSERT_NE(first, nullptr);
+    EXPECT_FALSE(first->indexFromSidecar());
+
+    auto second = MappedDictionary::open(annotationDictFile, indexPath);
+    ASSERT_NE(second, nullptr);
+    EXPECT_TRUE(second->indexFromSidecar());
+    EXPECT_TRUE(bejDictIndexIsPrepared(second->index()));
+    EXPECT_EQ(second->index()->tablesLength, first->index()->tablesLength);
+
+    // Both indexes should give the same answers.
+    const BejDictionaryHeader* header =
+        reinterpret_cast<const BejDictionaryHeader*>(first->data().data());
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t offset =
+            bejDictGetPropertyHeadOffset() + i * sizeof(BejDictionaryProperty);
+        for (uint16_t seq = 0; seq < 32; ++seq)
+        {
+            const BejDictionaryProperty* expected = nullptr;
+            const BejDictionaryProperty* actual = nullptr;
+            int expectedRet =
+                bejDictIndexGetProperty(first->data().data(), first->index(),
+                                        offset, seq, &expected);
+            EXPECT_EQ(bejDictIndexGetProperty(second->data().data(),
+                                              second->index(), offset, seq,
+                                              &actual),
+                      expectedRet);
+            if (expectedRet == 0)
+            {
+                EXPECT_EQ(reinterpret_cast<const uint8_t*>(actual) -
+                              second->data().data(),
+                          reinterpret_cast<const uint8_t*>(expected) -
+                              first->data().data());
+            }
+        }
+    }
+    unlink(indexPath.c_str());
+}
+
+TEST(BejDictionaryFileTest, StaleSidecarIsRebuilt)
+{
+    std::string indexPath = sidecarPath("stale");
+    // Sidecar of a different dictionary.
+    ASSERT_NE(MappedDictionary::open(annotationDictFile, indexPath), nullptr);
+
+    auto mapped = MappedDictionary::open(dummySimpleDictFile, indexPath);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_FALSE(mapped->indexFromSidecar());
+
+    // The sidecar now belongs to the new dictionary.
+    mapped = MappedDictionary::open(dummySimpleDictFile, indexPath);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_TRUE(mapped->indexFromSidecar());
+    unlink(indexPath.c_str());
+}
+
+TEST(BejDictionaryFileTest, RewrittenDictionaryIsValidatedAgain)
+{
+    std::string indexPath = sidecarPath("rewritten");
+    std::string dictionaryPath = indexPath + ".bin";
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize size =
+        readBinaryFile(dummySimpleDictFile, std::span(dictionary));
+    ASSERT_GT(size, 0);
+    auto writeDictionary = [&](std::streamsize length) {
+        std::ofstream out(dictionaryPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(dictionary.data()), length);
+    };
+
+    writeDictionary(size);
+    ASSERT_NE(MappedDictionary::open(dictionaryPath, indexPath), nullptr);
+    auto reused = MappedDictionary::open(dictionaryPath, indexPath);
+    ASSERT_NE(reused, nullptr);
+    EXPECT_TRUE(reused->indexFromSidecar());
+    reused.reset();
+
+    // Rewriting the file in place keeps the inode but not the size and the
+    // status times. The sidecar no longer matches, so the dictionary is
+    // validated again and rejected.
+    writeDictionary(size - 1);
+    EXPECT_EQ(MappedDictionary::open(dictionaryPath, indexPath), nullptr);
+    unlink(dictionaryPath.c_str());
+    unlink(indexPath.c_str());
+}
+
+TEST(BejDictionaryFileTest, CorruptedSidecarIsIgnored)
+{
+    std::string indexPath = sidecarPath("corrupted");
+    ASSERT_NE(MappedDictionary::open(dummySimpleDictFile, indexPath), nullptr);
+
+    // Point a table entry outside of the dictionary properties.
+    std::fstream sidecar(indexPath,
+                         std::ios::binary | std::ios::in | std::ios::out);
+    ASSERT_TRUE(sidecar.is_open());
+    BejDictionaryIndexFileHeader header;
+    sidecar.read(reinterpret_cast<char*>(&header), sizeof(header));
+    sidecar.seekp(sizeof(header) + header.entryCount * sizeof(uint32_t) +
+                  sizeof(uint16_t));
+    uint16_t badEntry = header.entryCount;
+    sidecar.write(reinterpret_cast<const char*>(&badEntry), sizeof(badEntry));
+    sidecar.close();
+
+    auto mapped = MappedDictionary::open(dummySimpleDictFile, indexPath);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_FALSE(mapped->indexFromSidecar());
+    unlink(indexPath.c_str());
+}
+
+TEST(BejDictionaryFileTest, DecodeUsingMappedDictionaries)
+{
+    const BejTestInputFiles driveOemTestFiles = {
+        .jsonFile = "../test/json/drive_oem.json",
+        .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+        .annotationDictionaryFile = annotationDictFile,
+        .errorDictionaryFile = "",
+        .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+    };
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    auto mapped = MappedDictionaries::open(
+        driveOemTestFiles.schemaDictionaryFile,
+        driveOemTestFiles.annotationDictionaryFile, "", "");
+    ASSERT_NE(mapped, nullptr);
+
+    BejDecoderJson decoder;
+    EXPECT_THAT(
+        decoder.decode(mapped->dictionaries(), inputsOrErr->encodedStream), 0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+
+    EXPECT_THAT(
+        decoder.decodePrepared(mapped->indexes(), inputsOrErr->encodedStream),
+        0);
+    jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+} // namespace libbej
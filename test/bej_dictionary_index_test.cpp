@@ -0,0 +1,357 @@
+#include "bej_common_test.hpp"
+#include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
+
+#include <array>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejDictionaryIndexTestParams
+{
+    const std::string testName;
+    const char* dictionaryFile;
+};
+
+void PrintTo(const BejDictionaryIndexTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejDictionaryIndexTest =
+    testing::TestWithParam<BejDictionaryIndexTestParams>;
+
+TEST_P(BejDictionaryIndexTest, MatchesLinearSearch)
+{
+    const BejDictionaryIndexTestParams& test_case = GetParam();
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile(test_case.dictionaryFile, std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    ASSERT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              0);
+
+    // Every property offset is used as a starting point. Some of them are
+    // indexed child ranges and the rest will use the linear search fallback.
+    // Both must give the same answer as bejDictGetProperty.
+    const auto* header =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary.data());
+    uint16_t maxSeq = 0;
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        const auto* p = reinterpret_cast<const BejDictionaryProperty*>(
+            dictionary.data() + bejDictGetPropertyHeadOffset() +
+            i * sizeof(BejDictionaryProperty));
+        maxSeq = std::max<uint16_t>(maxSeq, p->sequenceNumber);
+    }
+
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t offset =
+            bejDictGetPropertyHeadOffset() + i * sizeof(BejDictionaryProperty);
+        for (uint16_t seq = 0; seq <= maxSeq + 1; ++seq)
+        {
+            const BejDictionaryProperty* expected = nullptr;
+            const BejDictionaryProperty* actual = nullptr;
+            int expectedRet =
+                bejDictGetProperty(dictionary.data(), offset, seq, &expected);
+            EXPECT_EQ(bejDictIndexGetProperty(dictionary.data(), &index,
+                                              offset, seq, &actual),
+                      expectedRet)
+                << "offset=" << offset << " seq=" << seq;
+            EXPECT_EQ(actual, expected)
+                << "offset=" << offset << " seq=" << seq;
+        }
+    }
+}
+
+TEST_P(BejDictionaryIndexTest, NameLookupMatchesLinearSearch)
+{
+    const BejDictionaryIndexTestParams& test_case = GetParam();
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile(test_case.dictionaryFile, std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    ASSERT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              0);
+
+    const auto* header =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary.data());
+    std::vector<const char*> names = {"NotAPropertyName"};
+    // Largest child range starting at each property. The root is a range
+    // with a single child.
+    std::vector<uint16_t> rangeEnds(header->entryCount, 0);
+    rangeEnds[0] = 1;
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        const auto* p = reinterpret_cast<const BejDictionaryProperty*>(
+            dictionary.data() + bejDictGetPropertyHeadOffset() +
+            i * sizeof(BejDictionaryProperty));
+        names.push_back(bejDictGetPropertyName(dictionary.data(),
+                                               p->nameOffset, p->nameLength));
+        if (p->childCount == 0)
+        {
+            continue;
+        }
+        uint16_t start = (p->childPointerOffset -
+                          bejDictGetPropertyHeadOffset()) /
+                         sizeof(BejDictionaryProperty);
+        rangeEnds[start] = std::max<uint16_t>(rangeEnds[start],
+                                              start + p->childCount);
+    }
+
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t offset =
+            bejDictGetPropertyHeadOffset() + i * sizeof(BejDictionaryProperty);
+        for (const char* name : names)
+        {
+            const BejDictionaryProperty* expected = nullptr;
+            const BejDictionaryProperty* actual = nullptr;
+            uint16_t expectedOffset = 0;
+            uint16_t actualOffset = 0;
+            int expectedRet = bejDictGetPropertyByName(
+                dictionary.data(), offset, name, &expected, &expectedOffset);
+            // An indexed range only finds its own properties.
+            uint16_t rangeEndOffset = bejDictGetPropertyHeadOffset() +
+                                      rangeEnds[i] *
+                                          sizeof(BejDictionaryProperty);
+            if (rangeEnds[i] != 0 && expectedRet == 0 &&
+                expectedOffset >= rangeEndOffset)
+            {
+                expectedRet = bejErrorUnknownProperty;
+                expected = nullptr;
+                expectedOffset = 0;
+            }
+            EXPECT_EQ(bejDictIndexGetPropertyByName(dictionary.data(), &index,
+                                                    offset, name, &actual,
+                                                    &actualOffset),
+                      expectedRet)
+                << "offset=" << offset << " name=" << name;
+            EXPECT_EQ(actual, expected)
+                << "offset=" << offset << " name=" << name;
+            EXPECT_EQ(actualOffset, expectedOffset)
+                << "offset=" << offset << " name=" << name;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejDictionaryIndexTest,
+    testing::ValuesIn<BejDictionaryIndexTestParams>({
+        {"Annotation", "../test/dictionaries/annotation_dict.bin"},
+        {"Chassis", "../test/dictionaries/chassis_dict.bin"},
+        {"Circuit", "../test/dictionaries/circuit_dict.bin"},
+        {"DriveOEM", "../test/dictionaries/drive_oem_dict.bin"},
+        {"DummySimple", "../test/dictionaries/dummy_simple_dict.bin"},
+        {"Storage", "../test/dictionaries/storage_dict.bin"},
+    }),
+    [](const testing::TestParamInfo<BejDictionaryIndexTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST_P(BejDictionaryIndexTest, PreparedMatchesLinearSearch)
+{
+    const BejDictionaryIndexTestParams& test_case = GetParam();
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile(test_case.dictionaryFile, std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    ASSERT_EQ(bejDictPrepare(dictionary.data(), dictionarySize, buffer.data(),
+                             buffer.size() * sizeof(uint32_t), &index),
+              0);
+    EXPECT_TRUE(bejDictIndexIsPrepared(&index));
+
+    const auto* header =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary.data());
+    for (uint16_t i = 0; i < header->entryCount; ++i)
+    {
+        uint16_t offset =
+            bejDictGetPropertyHeadOffset() + i * sizeof(BejDictionaryProperty);
+        for (uint16_t seq = 0; seq <= 64; ++seq)
+        {
+            const BejDictionaryProperty* expected = nullptr;
+            const BejDictionaryProperty* actual = nullptr;
+            int expectedRet =
+                bejDictGetProperty(dictionary.data(), offset, seq, &expected);
+            EXPECT_EQ(bejDictIndexGetProperty(dictionary.data(), &index,
+                                              offset, seq, &actual),
+                      expectedRet)
+                << "offset=" << offset << " seq=" << seq;
+            EXPECT_EQ(actual, expected)
+                << "offset=" << offset << " seq=" << seq;
+
+            const BejDictionaryProperty* prepared = nullptr;
+            EXPECT_EQ(bejDictIndexGetPreparedProperty(
+                          dictionary.data(), &index, offset, seq, &prepared),
+                      expectedRet)
+                << "offset=" << offset << " seq=" << seq;
+            EXPECT_EQ(prepared, expected)
+                << "offset=" << offset << " seq=" << seq;
+        }
+    }
+}
+
+TEST(BejDictionaryIndexBuildTest, PrepareInvalidDictionary)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    EXPECT_EQ(bejDictPrepare(dictionary.data(), dictionarySize - 1,
+                             buffer.data(), buffer.size() * sizeof(uint32_t),
+                             &index),
+              bejErrorInvalidSize);
+
+    // A plain index is not a prepared dictionary.
+    ASSERT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              0);
+    EXPECT_FALSE(bejDictIndexIsPrepared(&index));
+    EXPECT_FALSE(bejDictIndexIsPrepared(nullptr));
+
+    // Setting the validated size by hand doesn't prepare it either.
+    index.validatedSize = dictionarySize;
+    EXPECT_FALSE(bejDictIndexIsPrepared(&index));
+
+    // Changing a prepared index turns it back into a plain index.
+    ASSERT_EQ(bejDictPrepare(dictionary.data(), dictionarySize, buffer.data(),
+                             buffer.size() * sizeof(uint32_t), &index),
+              0);
+    EXPECT_TRUE(bejDictIndexIsPrepared(&index));
+    EXPECT_EQ(index.validatedSize, static_cast<uint32_t>(dictionarySize));
+    index.validatedSize = UINT32_MAX;
+    EXPECT_FALSE(bejDictIndexIsPrepared(&index));
+}
+
+TEST(BejDictionaryIndexBuildTest, BufferTooSmall)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(1);
+    BejDictionaryIndex index;
+    EXPECT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDictionaryIndexBuildTest, InvalidName)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    // The name of the second property now runs past the end of the buffer.
+    auto* property = reinterpret_cast<BejDictionaryProperty*>(
+        dictionary.data() + bejDictGetPropertyHeadOffset() +
+        sizeof(BejDictionaryProperty));
+    ASSERT_GT(property->nameLength, 0);
+    property->nameOffset = dictionarySize - 1;
+    EXPECT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDictionaryIndexBuildTest, TruncatedDictionary)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    // The property table does not fit in the buffer.
+    const uint32_t truncatedSize =
+        bejDictGetPropertyHeadOffset() + sizeof(BejDictionaryProperty);
+    EXPECT_EQ(bejDictIndexGetBufferSize(dictionary.data(), truncatedSize), 0);
+    EXPECT_EQ(bejDictBuildIndex(dictionary.data(), truncatedSize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              bejErrorInvalidSize);
+    EXPECT_EQ(bejDictBuildIndex(dictionary.data(), 4, buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              bejErrorInvalidSize);
+
+    // Same for a header claiming more properties than the buffer holds.
+    auto* header = reinterpret_cast<BejDictionaryHeader*>(dictionary.data());
+    header->entryCount = UINT16_MAX;
+    EXPECT_EQ(bejDictBuildIndex(dictionary.data(), dictionarySize,
+                                buffer.data(),
+                                buffer.size() * sizeof(uint32_t), &index),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDictionaryIndexBuildTest, NullIndexUsesLinearSearch)
+{
+    std::array<uint8_t, maxBufferSize> dictionary;
+    std::streamsize dictionarySize =
+        readBinaryFile("../test/dictionaries/dummy_simple_dict.bin",
+                       std::span(dictionary));
+    ASSERT_GT(dictionarySize, 0);
+
+    const BejDictionaryProperty* expected = nullptr;
+    const BejDictionaryProperty* actual = nullptr;
+    ASSERT_EQ(bejDictGetProperty(dictionary.data(),
+                                 bejDictGetPropertyHeadOffset(), 0, &expected),
+              0);
+    EXPECT_EQ(bejDictIndexGetProperty(dictionary.data(), nullptr,
+                                      bejDictGetPropertyHeadOffset(), 0,
+                                      &actual),
+              0);
+    EXPECT_EQ(actual, expected);
+}
+
+} // namespace libbej
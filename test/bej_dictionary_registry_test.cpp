@@ -0,0 +1,151 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_dictionary_registry.hpp"
+
+#include <array>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+const BejTestInputFiles driveOemTestFiles = {
+    .jsonFile = "../test/json/drive_oem.json",
+    .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+};
+
+/**
+ * @brief Read a dictionary file into a vector.
+ */
+std::vector<uint8_t> readDictionary(const char* fileName)
+{
+    std::array<uint8_t, maxBufferSize> buffer;
+    std::streamsize size = readBinaryFile(fileName, std::span(buffer));
+    return {buffer.begin(), buffer.begin() + size};
+}
+
+TEST(BejDictionaryRegistryTest, IdenticalDictionariesAreShared)
+{
+    DictionaryRegistry registry;
+    // Two devices providing their own copies of the same dictionary.
+    std::vector<uint8_t> first =
+        readDictionary("../test/dictionaries/annotation_dict.bin");
+    std::vector<uint8_t> second = first;
+    ASSERT_FALSE(first.empty());
+
+    auto firstPrepared = registry.intern(first);
+    auto secondPrepared = registry.intern(second);
+    ASSERT_NE(firstPrepared, nullptr);
+    EXPECT_EQ(firstPrepared, secondPrepared);
+    EXPECT_EQ(registry.size(), 1);
+    EXPECT_NE(firstPrepared->data().data(), first.data());
+    EXPECT_TRUE(bejDictIndexIsPrepared(firstPrepared->index()));
+    EXPECT_EQ(firstPrepared->schemaVersion(),
+              reinterpret_cast<const BejDictionaryHeader*>(first.data())
+                  ->schemaVersion);
+}
+
+TEST(BejDictionaryRegistryTest, DifferentDictionariesAreNotShared)
+{
+    DictionaryRegistry registry;
+    auto annotation = registry.intern(
+        readDictionary("../test/dictionaries/annotation_dict.bin"));
+    auto chassis = registry.intern(
+        readDictionary("../test/dictionaries/chassis_dict.bin"));
+    ASSERT_NE(annotation, nullptr);
+    ASSERT_NE(chassis, nullptr);
+    EXPECT_NE(annotation, chassis);
+    EXPECT_EQ(registry.size(), 2);
+}
+
+TEST(BejDictionaryRegistryTest, ReleasedWhenUnused)
+{
+    DictionaryRegistry registry;
+    std::vector<uint8_t> dictionary =
+        readDictionary("../test/dictionaries/dummy_simple_dict.bin");
+    auto prepared = registry.intern(dictionary);
+    ASSERT_NE(prepared, nullptr);
+    EXPECT_EQ(registry.find(dictionary), prepared);
+
+    prepared.reset();
+    EXPECT_EQ(registry.size(), 0);
+    EXPECT_EQ(registry.find(dictionary), nullptr);
+}
+
+TEST(BejDictionaryRegistryTest, InvalidDictionary)
+{
+    DictionaryRegistry registry;
+    std::vector<uint8_t> dictionary =
+        readDictionary("../test/dictionaries/dummy_simple_dict.bin");
+    // Size doesn't match the dictionary header.
+    dictionary.pop_back();
+    EXPECT_EQ(registry.intern(dictionary), nullptr);
+    EXPECT_EQ(registry.intern(std::span<const uint8_t>()), nullptr);
+    EXPECT_EQ(registry.size(), 0);
+}
+
+TEST(BejDictionaryRegistryTest, ConcurrentIntern)
+{
+    DictionaryRegistry registry;
+    std::vector<uint8_t> dictionary =
+        readDictionary("../test/dictionaries/storage_dict.bin");
+    ASSERT_FALSE(dictionary.empty());
+
+    constexpr size_t threadCount = 8;
+    std::vector<std::shared_ptr<const PreparedDictionary>> results(
+        threadCount);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            std::vector<uint8_t> copy = dictionary;
+            results[i] = registry.intern(copy);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_NE(results[0], nullptr);
+    for (const auto& result : results)
+    {
+        EXPECT_EQ(result, results[0]);
+    }
+    EXPECT_EQ(registry.size(), 1);
+}
+
+TEST(BejDictionaryRegistryTest, DecodeUsingSharedDictionaries)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    DictionaryRegistry registry;
+    auto schema = registry.intern(std::span<const uint8_t>(
+        inputsOrErr->schemaDictionary, inputsOrErr->schemaDictionarySize));
+    auto annotation = registry.intern(
+        std::span<const uint8_t>(inputsOrErr->annotationDictionary,
+                                 inputsOrErr->annotationDictionarySize));
+    ASSERT_NE(schema, nullptr);
+    ASSERT_NE(annotation, nullptr);
+
+    BejDictionaryIndexes preparedDictionaries = {
+        .schemaIndex = schema->index(),
+        .annotationIndex = annotation->index(),
+    };
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decodePrepared(preparedDictionaries,
+                                       inputsOrErr->encodedStream),
+                0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+} // namespace libbej
@@ -131,4 +131,52 @@ TEST(BejDictionaryTest, InvalidPropertyNameLength)
               bejErrorInvalidSize);
 }
 
+TEST(BejDictionaryTest, ValidateDictionary)
+{
+    EXPECT_EQ(bejDictValidate(dummySimpleDict.data(), dummySimpleDict.size()),
+              0);
+    // Size should match the one in the dictionary header.
+    EXPECT_EQ(
+        bejDictValidate(dummySimpleDict.data(), dummySimpleDict.size() - 1),
+        bejErrorInvalidSize);
+}
+
+TEST(BejDictionaryTest, ValidateInvalidPropertyNameLength)
+{
+    std::vector<uint8_t> modifiedDictionary = {dummySimpleDict.begin(),
+                                               dummySimpleDict.end()};
+
+    // Modify the name length of the last property.
+    struct BejDictionaryHeader* header =
+        (struct BejDictionaryHeader*)modifiedDictionary.data();
+    struct BejDictionaryProperty* property =
+        (struct BejDictionaryProperty*)(modifiedDictionary.data() +
+                                        sizeof(BejDictionaryHeader) +
+                                        (header->entryCount - 1) *
+                                            sizeof(BejDictionaryProperty));
+    property->nameLength += 1;
+
+    EXPECT_EQ(bejDictValidate(modifiedDictionary.data(),
+                              modifiedDictionary.size()),
+              bejErrorInvalidSize);
+}
+
+TEST(BejDictionaryTest, ValidateInvalidChildRange)
+{
+    std::vector<uint8_t> modifiedDictionary = {dummySimpleDict.begin(),
+                                               dummySimpleDict.end()};
+
+    // Make the child range of the root property go beyond the properties.
+    struct BejDictionaryHeader* header =
+        (struct BejDictionaryHeader*)modifiedDictionary.data();
+    struct BejDictionaryProperty* property =
+        (struct BejDictionaryProperty*)(modifiedDictionary.data() +
+                                        sizeof(BejDictionaryHeader));
+    property->childCount = header->entryCount;
+
+    EXPECT_EQ(bejDictValidate(modifiedDictionary.data(),
+                              modifiedDictionary.size()),
+              bejErrorInvalidPropertyOffset);
+}
+
 } // namespace libbej
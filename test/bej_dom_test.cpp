@@ -0,0 +1,215 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_dom.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejDomTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+};
+
+void PrintTo(const BejDomTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejDomTest = testing::TestWithParam<BejDomTestParams>;
+
+/**
+ * @brief Convert a DOM node and its children to JSON.
+ */
+nlohmann::json nodeToJson(const BejDom& dom, uint32_t index)
+{
+    const BejDomNode& node = dom.nodes[index];
+    switch (node.type)
+    {
+        case bejSet:
+        case bejArray:
+        {
+            nlohmann::json json = (node.type == bejSet)
+                                      ? nlohmann::json::object()
+                                      : nlohmann::json::array();
+            uint32_t count = 0;
+            for (uint32_t child = node.firstChild; child != BEJ_DOM_NO_NODE;
+                 child = dom.nodes[child].nextSibling)
+            {
+                EXPECT_GT(child, index);
+                const BejDomNode& childNode = dom.nodes[child];
+                if (node.type == bejArray)
+                {
+                    json.push_back(nodeToJson(dom, child));
+                }
+                else
+                {
+                    std::string name = childNode.name;
+                    if (childNode.annotatedName != nullptr)
+                    {
+                        name = childNode.annotatedName + name;
+                    }
+                    json[name] = nodeToJson(dom, child);
+                }
+                ++count;
+            }
+            EXPECT_EQ(count, node.childCount);
+            EXPECT_EQ(node.value.elementCount, node.childCount);
+            if (node.childCount > 0)
+            {
+                // The first child follows its parent.
+                EXPECT_EQ(node.firstChild, index + 1);
+            }
+            return json;
+        }
+        case bejInteger:
+            return node.value.integer;
+        case bejEnum:
+            return node.value.enumValue;
+        case bejString:
+            return std::string(node.value.string.value,
+                               node.value.string.length);
+        case bejReal:
+        {
+            const BejReal& real = node.value.real;
+            std::string text = std::to_string(real.whole) + "." +
+                               std::string(real.zeroCount, '0') +
+                               std::to_string(real.fract);
+            if (real.expLen != 0)
+            {
+                text += "e" + std::to_string(real.exp);
+            }
+            return nlohmann::json::parse(text);
+        }
+        case bejBoolean:
+            return node.value.boolean;
+        case bejResourceLink:
+            return node.value.linkId;
+        default:
+            return nullptr;
+    }
+}
+
+TEST_P(BejDomTest, Build)
+{
+    const BejDomTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    std::vector<BejDomNode> nodes(bejDomGetMaxNodeCount(block.size()));
+    BejDom dom = {
+        .nodes = nodes.data(),
+        .capacity = static_cast<uint32_t>(nodes.size()),
+        .size = 0,
+    };
+    ASSERT_EQ(
+        bejDomBuild(&dictionaries, block.data(), block.size(), nullptr, &dom),
+        0);
+    ASSERT_GT(dom.size, 0);
+    EXPECT_EQ(nodes[0].type, bejSet);
+    EXPECT_EQ(nodes[0].nextSibling, BEJ_DOM_NO_NODE);
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, block), 0);
+    EXPECT_EQ(nodeToJson(dom, 0), nlohmann::json::parse(decoder.getOutput()));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejDomTest,
+    testing::ValuesIn<BejDomTestParams>({
+        {"DriveOEM",
+         {"../test/json/drive_oem.json",
+          "../test/dictionaries/drive_oem_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/drive_oem_enc.bin"}},
+        {"Circuit",
+         {"../test/json/circuit.json", "../test/dictionaries/circuit_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/circuit_enc.bin"}},
+        {"Storage",
+         {"../test/json/storage.json", "../test/dictionaries/storage_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/storage_enc.bin"}},
+        {"DummySimple",
+         {"../test/json/dummysimple.json",
+          "../test/dictionaries/dummy_simple_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/dummy_simple_enc.bin"}},
+    }),
+    [](const testing::TestParamInfo<BejDomTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+const BejTestInputFiles driveOemTestFiles = {
+    .jsonFile = "../test/json/drive_oem.json",
+    .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+};
+
+TEST(BejDomFindTest, FindChild)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    std::vector<BejDomNode> nodes(bejDomGetMaxNodeCount(block.size()));
+    BejDom dom = {
+        .nodes = nodes.data(),
+        .capacity = static_cast<uint32_t>(nodes.size()),
+        .size = 0,
+    };
+    ASSERT_EQ(
+        bejDomBuild(&dictionaries, block.data(), block.size(), nullptr, &dom),
+        0);
+
+    uint32_t status = bejDomFindChild(&dom, 0, "Status");
+    ASSERT_NE(status, BEJ_DOM_NO_NODE);
+    EXPECT_EQ(nodes[status].type, bejSet);
+    uint32_t health = bejDomFindChild(&dom, status, "Health");
+    ASSERT_NE(health, BEJ_DOM_NO_NODE);
+    ASSERT_EQ(nodes[health].type, bejEnum);
+    EXPECT_STREQ(nodes[health].value.enumValue, "Warning");
+
+    uint32_t messages =
+        bejDomFindChild(&dom, 0, "Status@Message.ExtendedInfo");
+    ASSERT_NE(messages, BEJ_DOM_NO_NODE);
+    EXPECT_EQ(nodes[messages].type, bejArray);
+    EXPECT_EQ(nodes[messages].childCount, 2);
+
+    EXPECT_EQ(bejDomFindChild(&dom, 0, "Health"), BEJ_DOM_NO_NODE);
+    EXPECT_EQ(bejDomFindChild(&dom, 0, "@Message.ExtendedInfo"),
+              BEJ_DOM_NO_NODE);
+    EXPECT_EQ(bejDomFindChild(&dom, dom.size, "Status"), BEJ_DOM_NO_NODE);
+}
+
+TEST(BejDomFindTest, DomTooSmall)
+{
+    auto inputsOrErr = loadInputs(driveOemTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    BejDomNode nodes[2];
+    BejDom dom = {
+        .nodes = nodes,
+        .capacity = 2,
+        .size = 0,
+    };
+    EXPECT_EQ(
+        bejDomBuild(&dictionaries, block.data(), block.size(), nullptr, &dom),
+        bejErrorInvalidSize);
+}
+
+} // namespace libbej
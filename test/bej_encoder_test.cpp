@@ -1,4 +1,5 @@
 #include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
 #include "bej_encoder_core.h"
 #include "bej_tree.h"
 
@@ -6,6 +7,7 @@
 #include "bej_decoder_json.hpp"
 #include "bej_encoder_json.hpp"
 
+#include <array>
 #include <vector>
 
 #include <gmock/gmock-matchers.h>
@@ -443,6 +445,217 @@ TEST_P(BejEncoderTest, EncodeWrapper)
     EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
 }
 
+TEST_P(BejEncoderTest, EncodeWithIndexes)
+{
+    const BejEncoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    BejDictionaries dictionaries = {
+        .schemaDictionary = inputsOrErr->schemaDictionary,
+        .schemaDictionarySize = inputsOrErr->schemaDictionarySize,
+        .annotationDictionary = inputsOrErr->annotationDictionary,
+        .annotationDictionarySize = inputsOrErr->annotationDictionarySize,
+        .errorDictionary = inputsOrErr->errorDictionary,
+        .errorDictionarySize = inputsOrErr->errorDictionarySize,
+    };
+
+    std::vector<uint32_t> schemaBuffer(
+        bejDictIndexGetBufferSize(dictionaries.schemaDictionary,
+                                  dictionaries.schemaDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    std::vector<uint32_t> annotationBuffer(
+        bejDictIndexGetBufferSize(dictionaries.annotationDictionary,
+                                  dictionaries.annotationDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex schemaIndex;
+    BejDictionaryIndex annotationIndex;
+    ASSERT_EQ(bejDictBuildIndex(dictionaries.schemaDictionary,
+                                dictionaries.schemaDictionarySize,
+                                schemaBuffer.data(),
+                                schemaBuffer.size() * sizeof(uint32_t),
+                                &schemaIndex),
+              0);
+    ASSERT_EQ(bejDictBuildIndex(dictionaries.annotationDictionary,
+                                dictionaries.annotationDictionarySize,
+                                annotationBuffer.data(),
+                                annotationBuffer.size() * sizeof(uint32_t),
+                                &annotationIndex),
+              0);
+    BejDictionaryIndexes indexes = {
+        .schemaIndex = &schemaIndex,
+        .annotationIndex = &annotationIndex,
+    };
+
+    // The indexed encoder must produce exactly the same bytes.
+    libbej::BejEncoderJson encoder;
+    EXPECT_THAT(encoder.encode(&dictionaries, bejMajorSchemaClass,
+                               test_case.createResource()),
+                0);
+    std::vector<uint8_t> expectedBuffer = encoder.getOutput();
+
+    encoder.setDictionaryIndexes(&indexes);
+    EXPECT_THAT(encoder.encode(&dictionaries, bejMajorSchemaClass,
+                               test_case.createResource()),
+                0);
+    std::vector<uint8_t> outputBuffer = encoder.getOutput();
+    EXPECT_EQ(outputBuffer, expectedBuffer);
+
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decode(dictionaries, std::span(outputBuffer)), 0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+
+    if (!test_case.expectedJson.empty())
+    {
+        inputsOrErr->expectedJson =
+            nlohmann::json::parse(test_case.expectedJson);
+    }
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
+TEST_P(BejEncoderTest, EncodeWithStackStorage)
+{
+    const BejEncoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    BejDictionaries dictionaries = {
+        .schemaDictionary = inputsOrErr->schemaDictionary,
+        .schemaDictionarySize = inputsOrErr->schemaDictionarySize,
+        .annotationDictionary = inputsOrErr->annotationDictionary,
+        .annotationDictionarySize = inputsOrErr->annotationDictionarySize,
+        .errorDictionary = inputsOrErr->errorDictionary,
+        .errorDictionarySize = inputsOrErr->errorDictionarySize,
+    };
+
+    std::vector<uint8_t> expectedBuffer;
+    struct BejEncoderOutputHandler expectedOutput = {
+        .handlerContext = &expectedBuffer,
+        .recvOutput = &getBejEncodedBuffer,
+    };
+    std::vector<void*> pointerStack;
+    struct BejPointerStackCallback stackCallbacks = {
+        .stackContext = &pointerStack,
+        .stackEmpty = stackEmpty,
+        .stackPeek = stackPeek,
+        .stackPop = stackPop,
+        .stackPush = stackPush,
+        .deleteStack = nullptr,
+    };
+    ASSERT_EQ(bejEncode(&dictionaries, BEJ_DICTIONARY_START_AT_HEAD,
+                        bejMajorSchemaClass, test_case.createResource(),
+                        &expectedOutput, &stackCallbacks),
+              0);
+
+    // The same bytes are expected when the stack is kept in an array.
+    std::vector<uint8_t> outputBuffer;
+    struct BejEncoderOutputHandler output = {
+        .handlerContext = &outputBuffer,
+        .recvOutput = &getBejEncodedBuffer,
+    };
+    std::array<void*, BEJ_MAX_STACK_DEPTH> entries;
+    struct BejPointerStackStorage stackStorage = {
+        .entries = entries.data(),
+        .capacity = entries.size(),
+        .size = 0,
+    };
+    struct BejEncoderOptions options = {
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+    };
+    ASSERT_EQ(bejEncodeWithOptions(&dictionaries, BEJ_DICTIONARY_START_AT_HEAD,
+                                   bejMajorSchemaClass,
+                                   test_case.createResource(), &output,
+                                   nullptr, &options),
+              0);
+    EXPECT_EQ(outputBuffer, expectedBuffer);
+    EXPECT_EQ(stackStorage.size, 0);
+
+    // A storage that cannot hold the tree depth is rejected.
+    std::array<void*, 1> smallEntries;
+    struct BejPointerStackStorage smallStorage = {
+        .entries = smallEntries.data(),
+        .capacity = smallEntries.size(),
+        .size = 0,
+    };
+    options.stackStorage = &smallStorage;
+    EXPECT_EQ(bejEncodeWithOptions(&dictionaries, BEJ_DICTIONARY_START_AT_HEAD,
+                                   bejMajorSchemaClass,
+                                   test_case.createResource(), &output,
+                                   nullptr, &options),
+              bejErrorInvalidSize);
+
+    // Same through the JSON encoder, which uses a std::vector by default.
+    BejEncoderJson encoder;
+    encoder.setStackStorage(entries);
+    ASSERT_EQ(encoder.encode(&dictionaries, bejMajorSchemaClass,
+                             test_case.createResource()),
+              0);
+    EXPECT_EQ(encoder.getOutput(), expectedBuffer);
+    encoder.setStackStorage(smallEntries);
+    EXPECT_EQ(encoder.encode(&dictionaries, bejMajorSchemaClass,
+                             test_case.createResource()),
+              bejErrorInvalidSize);
+}
+
+TEST_P(BejEncoderTest, EncodePrepared)
+{
+    const BejEncoderTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+
+    std::vector<uint32_t> schemaBuffer(
+        bejDictIndexGetBufferSize(inputsOrErr->schemaDictionary,
+                                  inputsOrErr->schemaDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    std::vector<uint32_t> annotationBuffer(
+        bejDictIndexGetBufferSize(inputsOrErr->annotationDictionary,
+                                  inputsOrErr->annotationDictionarySize) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex schemaIndex;
+    BejDictionaryIndex annotationIndex;
+    ASSERT_EQ(bejDictPrepare(inputsOrErr->schemaDictionary,
+                             inputsOrErr->schemaDictionarySize,
+                             schemaBuffer.data(),
+                             schemaBuffer.size() * sizeof(uint32_t),
+                             &schemaIndex),
+              0);
+    ASSERT_EQ(bejDictPrepare(inputsOrErr->annotationDictionary,
+                             inputsOrErr->annotationDictionarySize,
+                             annotationBuffer.data(),
+                             annotationBuffer.size() * sizeof(uint32_t),
+                             &annotationIndex),
+              0);
+    BejDictionaryIndexes preparedDictionaries = {
+        .schemaIndex = &schemaIndex,
+        .annotationIndex = &annotationIndex,
+    };
+
+    libbej::BejEncoderJson encoder;
+    EXPECT_THAT(encoder.encodePrepared(preparedDictionaries,
+                                       bejMajorSchemaClass,
+                                       test_case.createResource()),
+                0);
+    std::vector<uint8_t> outputBuffer = encoder.getOutput();
+
+    BejDecoderJson decoder;
+    EXPECT_THAT(decoder.decodePrepared(preparedDictionaries,
+                                       std::span(outputBuffer)),
+                0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+
+    if (!test_case.expectedJson.empty())
+    {
+        inputsOrErr->expectedJson =
+            nlohmann::json::parse(test_case.expectedJson);
+    }
+    EXPECT_TRUE(jsonDecoded.dump() == inputsOrErr->expectedJson.dump());
+}
+
 /**
  * TODO: Add more test cases.
  */
@@ -0,0 +1,186 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_dictionary.h"
+#include "bej_dictionary_registry.hpp"
+#include "bej_json_keys.hpp"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejJsonKeysTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+};
+
+void PrintTo(const BejJsonKeysTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejJsonKeysTest = testing::TestWithParam<BejJsonKeysTestParams>;
+
+/**
+ * @brief Get the properties of a dictionary.
+ */
+std::span<const BejDictionaryProperty>
+    getProperties(std::span<const uint8_t> dictionary)
+{
+    const BejDictionaryHeader* header =
+        reinterpret_cast<const BejDictionaryHeader*>(dictionary.data());
+    return {reinterpret_cast<const BejDictionaryProperty*>(
+                dictionary.data() + bejDictGetPropertyHeadOffset()),
+            header->entryCount};
+}
+
+TEST_P(BejJsonKeysTest, KeysForEveryName)
+{
+    const BejJsonKeysTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    std::span<const uint8_t> dictionary(inputsOrErr->schemaDictionary,
+                                        inputsOrErr->schemaDictionarySize);
+
+    JsonKeyCache keys(dictionary);
+    for (const BejDictionaryProperty& property : getProperties(dictionary))
+    {
+        const char* name = bejDictGetPropertyName(
+            dictionary.data(), property.nameOffset, property.nameLength);
+        if (name[0] == '\0')
+        {
+            EXPECT_TRUE(keys.find(name).empty());
+            continue;
+        }
+        EXPECT_EQ(keys.find(name), "\"" + std::string(name) + "\":");
+        // Only the start of a name has a key.
+        EXPECT_TRUE(keys.find(name + 1).empty());
+    }
+    EXPECT_TRUE(keys.find("Status").empty());
+    EXPECT_TRUE(
+        keys.find(reinterpret_cast<const char*>(dictionary.data())).empty());
+}
+
+TEST_P(BejJsonKeysTest, DecodeUsingKeys)
+{
+    const BejJsonKeysTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = {
+        .schemaDictionary = inputsOrErr->schemaDictionary,
+        .schemaDictionarySize = inputsOrErr->schemaDictionarySize,
+        .annotationDictionary = inputsOrErr->annotationDictionary,
+        .annotationDictionarySize = inputsOrErr->annotationDictionarySize,
+        .errorDictionary = inputsOrErr->errorDictionary,
+        .errorDictionarySize = inputsOrErr->errorDictionarySize,
+    };
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    std::string expected = decoder.getOutput();
+
+    JsonKeyCache schemaKeys(std::span<const uint8_t>(
+        inputsOrErr->schemaDictionary, inputsOrErr->schemaDictionarySize));
+    JsonKeyCache annotationKeys(
+        std::span<const uint8_t>(inputsOrErr->annotationDictionary,
+                                 inputsOrErr->annotationDictionarySize));
+    decoder.setKeyCaches(&schemaKeys, &annotationKeys);
+    ASSERT_EQ(decoder.decode(dictionaries, inputsOrErr->encodedStream), 0);
+    EXPECT_EQ(decoder.getOutput(), expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejJsonKeysTest,
+    testing::ValuesIn<BejJsonKeysTestParams>({
+        {"DriveOEM",
+         {"../test/json/drive_oem.json",
+          "../test/dictionaries/drive_oem_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/drive_oem_enc.bin"}},
+        {"Circuit",
+         {"../test/json/circuit.json", "../test/dictionaries/circuit_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/circuit_enc.bin"}},
+        {"Storage",
+         {"../test/json/storage.json", "../test/dictionaries/storage_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/storage_enc.bin"}},
+        {"DummySimple",
+         {"../test/json/dummysimple.json",
+          "../test/dictionaries/dummy_simple_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/dummy_simple_enc.bin"}},
+    }),
+    [](const testing::TestParamInfo<BejJsonKeysTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejJsonKeysEscapeTest, EscapesNames)
+{
+    std::vector<uint8_t> dictionary(maxBufferSize);
+    std::streamsize size = readBinaryFile(
+        "../test/dictionaries/dummy_simple_dict.bin", std::span(dictionary));
+    ASSERT_GT(size, 0);
+    dictionary.resize(size);
+
+    // Put a quote and a control character in the name of a property.
+    const BejDictionaryProperty& property = getProperties(dictionary)[1];
+    ASSERT_GE(property.nameLength, 3);
+    char* name = reinterpret_cast<char*>(dictionary.data()) +
+                 property.nameOffset;
+    std::string rest(name + 2);
+    name[0] = '\"';
+    name[1] = '\n';
+
+    JsonKeyCache keys(dictionary);
+    EXPECT_EQ(keys.find(name), "\"\\\"\\u000a" + rest + "\":");
+}
+
+TEST(BejJsonKeysEscapeTest, InvalidDictionary)
+{
+    std::vector<uint8_t> dictionary(4);
+    JsonKeyCache keys(dictionary);
+    EXPECT_TRUE(
+        keys.find(reinterpret_cast<const char*>(dictionary.data())).empty());
+}
+
+TEST(BejJsonKeysRegistryTest, PreparedDictionaryKeys)
+{
+    auto inputsOrErr = loadInputs({
+        .jsonFile = "../test/json/drive_oem.json",
+        .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+        .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+        .errorDictionaryFile = "",
+        .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+    });
+    ASSERT_TRUE(inputsOrErr);
+
+    DictionaryRegistry registry;
+    auto schema = registry.intern(std::span<const uint8_t>(
+        inputsOrErr->schemaDictionary, inputsOrErr->schemaDictionarySize));
+    auto annotation = registry.intern(
+        std::span<const uint8_t>(inputsOrErr->annotationDictionary,
+                                 inputsOrErr->annotationDictionarySize));
+    ASSERT_NE(schema, nullptr);
+    ASSERT_NE(annotation, nullptr);
+
+    BejDictionaryIndexes preparedDictionaries = {
+        .schemaIndex = schema->index(),
+        .annotationIndex = annotation->index(),
+    };
+    BejDecoderJson decoder;
+    decoder.setKeyCaches(&schema->jsonKeys(), &annotation->jsonKeys());
+    ASSERT_EQ(decoder.decodePrepared(preparedDictionaries,
+                                     inputsOrErr->encodedStream),
+              0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    EXPECT_EQ(jsonDecoded, inputsOrErr->expectedJson);
+}
+
+} // namespace libbej
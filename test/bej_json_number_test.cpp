@@ -0,0 +1,64 @@
+#include "bej_json_number.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+TEST(BejJsonNumberTest, Integers)
+{
+    std::string output = "x";
+    appendJsonInteger(output, int64_t{0});
+    EXPECT_EQ(output, "x0");
+
+    output.clear();
+    appendJsonInteger(output, std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(output, "-9223372036854775808");
+
+    output.clear();
+    appendJsonInteger(output, std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(output, "9223372036854775807");
+
+    output.clear();
+    appendJsonInteger(output, std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(output, "18446744073709551615");
+
+    output.clear();
+    appendJsonInteger(output, std::numeric_limits<int8_t>::min());
+    EXPECT_EQ(output, "-128");
+}
+
+TEST(BejJsonNumberTest, Reals)
+{
+    std::string output;
+    appendJsonReal(output, BejReal{.expLen = 0,
+                                   .whole = 12,
+                                   .zeroCount = 2,
+                                   .fract = 34,
+                                   .exp = 0});
+    EXPECT_EQ(output, "12.0034");
+
+    output.clear();
+    appendJsonReal(output, BejReal{.expLen = 1,
+                                   .whole = -1,
+                                   .zeroCount = 0,
+                                   .fract = 5,
+                                   .exp = -7});
+    EXPECT_EQ(output, "-1.5e-7");
+
+    output.clear();
+    appendJsonReal(output, BejReal{.expLen = 0,
+                                   .whole = 0,
+                                   .zeroCount = 0,
+                                   .fract = 0,
+                                   .exp = 3});
+    EXPECT_EQ(output, "0.0");
+}
+
+} // namespace libbej
@@ -0,0 +1,146 @@
+#include "bej_common.h"
+#include "bej_json_string.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <string_view>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+using namespace std::string_view_literals;
+
+/**
+ * @brief Get the JSON string of a value.
+ */
+std::string toJson(std::string_view value)
+{
+    std::string output;
+    EXPECT_EQ(appendJsonString(output, value), 0);
+    return output;
+}
+
+TEST(BejJsonStringTest, NothingToEscape)
+{
+    EXPECT_EQ(toJson(""), "\"\"");
+    EXPECT_EQ(toJson("Dummy ID"), "\"Dummy ID\"");
+    // Longer than a block, so most of it is copied in bulk.
+    std::string value(100, 'a');
+    EXPECT_EQ(toJson(value), "\"" + value + "\"");
+}
+
+TEST(BejJsonStringTest, Escapes)
+{
+    EXPECT_EQ(toJson("a\"b\\c"), R"("a\"b\\c")");
+    EXPECT_EQ(toJson("\b\f\n\r\t"), R"("\b\f\n\r\t")");
+    EXPECT_EQ(toJson("\x01\x1f"), R"("\u0001\u001f")");
+    EXPECT_EQ(toJson("/"), "\"/\"");
+}
+
+TEST(BejJsonStringTest, EscapesAtEveryPosition)
+{
+    // Covers the special character at each position of a block and in the
+    // tail after the last full block.
+    for (size_t i = 0; i < 40; ++i)
+    {
+        std::string value(40, 'x');
+        value[i] = '\"';
+        std::string expected = value;
+        expected.insert(i, "\\");
+        EXPECT_EQ(toJson(value), "\"" + expected + "\"") << i;
+        nlohmann::json parsed = nlohmann::json::parse(toJson(value));
+        EXPECT_EQ(parsed.get<std::string>(), value) << i;
+    }
+}
+
+TEST(BejJsonStringTest, ValidUtf8)
+{
+    // 2, 3 and 4 byte sequences, including the edges of the valid ranges.
+    for (std::string_view value :
+         {"caf\xc3\xa9"sv, "\xe2\x82\xac 10"sv, "\xf0\x9f\x98\x80"sv,
+          "\xc2\x80"sv, "\xe0\xa0\x80"sv, "\xed\x9f\xbf"sv, "\xef\xbf\xbf"sv,
+          "\xf0\x90\x80\x80"sv, "\xf4\x8f\xbf\xbf"sv})
+    {
+        EXPECT_EQ(toJson(value), "\"" + std::string(value) + "\"");
+    }
+}
+
+TEST(BejJsonStringTest, InvalidUtf8)
+{
+    for (std::string_view value : {
+             "\x80"sv,                 // Lone continuation byte.
+             "\xc3"sv,                 // Truncated sequence.
+             "abc\xe2\x82"sv,          // Truncated at the end.
+             "\xc0\xaf"sv,             // Overlong.
+             "\xe0\x80\xaf"sv,         // Overlong.
+             "\xf0\x80\x80\xaf"sv,     // Overlong.
+             "\xed\xa0\x80"sv,         // Surrogate.
+             "\xf4\x90\x80\x80"sv,     // Above U+10FFFF.
+             "\xf5\x80\x80\x80"sv,     // Invalid lead byte.
+             "\xe2\x28\xa1"sv,         // Bad continuation byte.
+             "0123456789abcdef\xff"sv, // After a full block.
+         })
+    {
+        std::string output;
+        EXPECT_EQ(appendJsonString(output, value), bejErrorInvalidString);
+    }
+}
+
+TEST(BejJsonStringTest, NullCharacter)
+{
+    std::string output;
+    EXPECT_EQ(appendJsonString(output, "ab\0cd"sv), bejErrorInvalidSize);
+}
+
+TEST(BejJsonStringWriterTest, SplitAnywhere)
+{
+    const std::string_view value = "a\"\xc3\xa9\n\xe2\x82\xac\xf0\x9f\x98\x80z";
+    const std::string expected = toJson(value);
+    for (size_t first = 0; first <= value.size(); ++first)
+    {
+        for (size_t second = first; second <= value.size(); ++second)
+        {
+            std::string output;
+            JsonStringWriter writer;
+            writer.begin(output);
+            ASSERT_EQ(writer.append(output, value.substr(0, first)), 0);
+            ASSERT_EQ(
+                writer.append(output, value.substr(first, second - first)),
+                0);
+            ASSERT_EQ(writer.append(output, value.substr(second)), 0);
+            ASSERT_EQ(writer.end(output), 0);
+            EXPECT_EQ(output, expected) << first << " " << second;
+        }
+    }
+}
+
+TEST(BejJsonStringWriterTest, InvalidUtf8)
+{
+    std::string output;
+    JsonStringWriter writer;
+
+    // Ends within a sequence.
+    writer.begin(output);
+    ASSERT_EQ(writer.append(output, "ab\xe2\x82"), 0);
+    EXPECT_EQ(writer.end(output), bejErrorInvalidString);
+
+    // The next part does not continue the sequence.
+    writer.begin(output);
+    ASSERT_EQ(writer.append(output, "\xe2"), 0);
+    EXPECT_EQ(writer.append(output, "a"), bejErrorInvalidString);
+
+    // The writer can be used again.
+    output.clear();
+    writer.begin(output);
+    ASSERT_EQ(writer.append(output, "\xc3"), 0);
+    ASSERT_EQ(writer.append(output, "\xa9"), 0);
+    ASSERT_EQ(writer.end(output), 0);
+    EXPECT_EQ(output, "\"\xc3\xa9\"");
+}
+
+} // namespace libbej
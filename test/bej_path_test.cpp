@@ -0,0 +1,278 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_json.hpp"
+#include "bej_path.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejPathTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+    const std::string path;
+    // JSON pointer of the expected value within the decoded JSON.
+    const std::string jsonPointer;
+};
+
+void PrintTo(const BejPathTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejPathTest = testing::TestWithParam<BejPathTestParams>;
+
+const BejTestInputFiles driveOemTestFiles = {
+    .jsonFile = "../test/json/drive_oem.json",
+    .schemaDictionaryFile = "../test/dictionaries/drive_oem_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/drive_oem_enc.bin",
+};
+
+const BejTestInputFiles storageTestFiles = {
+    .jsonFile = "../test/json/storage.json",
+    .schemaDictionaryFile = "../test/dictionaries/storage_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/storage_enc.bin",
+};
+
+const BejTestInputFiles dummySimpleTestFiles = {
+    .jsonFile = "../test/json/dummysimple.json",
+    .schemaDictionaryFile = "../test/dictionaries/dummy_simple_dict.bin",
+    .annotationDictionaryFile = "../test/dictionaries/annotation_dict.bin",
+    .errorDictionaryFile = "",
+    .encodedStreamFile = "../test/encoded/dummy_simple_enc.bin",
+};
+
+TEST_P(BejPathTest, DecodePath)
+{
+    const BejPathTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(decoder.decodePath(dictionaries, test_case.path,
+                                 inputsOrErr->encodedStream),
+              0);
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    nlohmann::json expected = inputsOrErr->expectedJson.at(
+        nlohmann::json::json_pointer(test_case.jsonPointer));
+    EXPECT_EQ(jsonDecoded.dump(), expected.dump());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejPathTest,
+    testing::ValuesIn<BejPathTestParams>({
+        {"Root", driveOemTestFiles, "", ""},
+        {"Leaf", driveOemTestFiles, "/Status/Health", "/Status/Health"},
+        {"Set", driveOemTestFiles, "Status", "/Status"},
+        {"ArrayElementLeaf", driveOemTestFiles, "Identifiers/0/DurableName",
+         "/Identifiers/0/DurableName"},
+        {"Annotation", driveOemTestFiles, "@odata.id", "/@odata.id"},
+        {"NestedArrayElement", storageTestFiles,
+         "StorageControllers/0/Status", "/StorageControllers/0/Status"},
+        {"ArrayElementSet", dummySimpleTestFiles, "ChildArrayProperty/1",
+         "/ChildArrayProperty/1"},
+        {"Array", dummySimpleTestFiles, "ChildArrayProperty",
+         "/ChildArrayProperty"},
+        {"Integer", dummySimpleTestFiles, "SampleIntegerProperty",
+         "/SampleIntegerProperty"},
+    }),
+    [](const testing::TestParamInfo<BejPathTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejPathResolveTest, ResolvesSequenceNumbers)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejPath path;
+    ASSERT_EQ(bejPathResolve(&dictionaries, "ChildArrayProperty/7/LinkStatus",
+                             &path),
+              0);
+    ASSERT_EQ(path.depth, 3);
+    EXPECT_FALSE(path.steps[0].arrayElement);
+    EXPECT_TRUE(path.steps[1].arrayElement);
+    EXPECT_FALSE(path.steps[1].anyElement);
+    EXPECT_EQ(path.steps[1].sequenceNumber, 7);
+    EXPECT_FALSE(path.steps[2].arrayElement);
+    for (uint32_t i = 0; i < path.depth; ++i)
+    {
+        EXPECT_EQ(path.steps[i].schema, bejPrimary);
+    }
+}
+
+TEST(BejPathResolveTest, UnknownProperties)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejPath path;
+    EXPECT_EQ(bejPathResolve(&dictionaries, "NoSuchProperty", &path),
+              bejErrorUnknownProperty);
+    // Array elements need an index.
+    EXPECT_EQ(bejPathResolve(&dictionaries, "ChildArrayProperty/LinkStatus",
+                             &path),
+              bejErrorUnknownProperty);
+    // Leaf properties have no children.
+    EXPECT_EQ(bejPathResolve(&dictionaries, "Id/Name", &path),
+              bejErrorUnknownProperty);
+    // Children of another property are not looked up.
+    EXPECT_EQ(bejPathResolve(&dictionaries, "LinkStatus", &path),
+              bejErrorUnknownProperty);
+    EXPECT_EQ(bejPathResolve(&dictionaries, "Id//", &path),
+              bejErrorUnknownProperty);
+}
+
+TEST(BejPathDecodeTest, MissingFromStream)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejDecoderJson decoder;
+    // Only two array elements are encoded.
+    EXPECT_EQ(decoder.decodePath(dictionaries, "ChildArrayProperty/2",
+                                 inputsOrErr->encodedStream),
+              bejErrorUnknownProperty);
+    // The second element has no AnotherBoolean.
+    EXPECT_EQ(decoder.decodePath(dictionaries,
+                                 "ChildArrayProperty/1/AnotherBoolean",
+                                 inputsOrErr->encodedStream),
+              bejErrorUnknownProperty);
+}
+
+struct BejProjectionTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+    const std::vector<std::string> paths;
+    // Expected output. Empty if the whole JSON file is expected.
+    const std::string expectedJson;
+};
+
+void PrintTo(const BejProjectionTestParams& params, std::ostream* os)
+{
+    *os << params.testName;
+}
+
+using BejProjectionTest = testing::TestWithParam<BejProjectionTestParams>;
+
+TEST_P(BejProjectionTest, Decode)
+{
+    const BejProjectionTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    std::vector<BejPath> paths(test_case.paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        ASSERT_EQ(bejPathResolve(&dictionaries, test_case.paths[i].c_str(),
+                                 &paths[i]),
+                  0);
+    }
+    BejProjection projection = {
+        .paths = paths.data(),
+        .count = static_cast<uint32_t>(paths.size()),
+    };
+
+    BejDecoderJson decoder;
+    ASSERT_EQ(
+        decoder.decode(dictionaries, inputsOrErr->encodedStream, projection),
+        0);
+    // Parsing fails if a skipped property left a separator behind.
+    nlohmann::json jsonDecoded = nlohmann::json::parse(decoder.getOutput());
+    nlohmann::json expected = test_case.expectedJson.empty()
+                                  ? inputsOrErr->expectedJson
+                                  : nlohmann::json::parse(
+                                        test_case.expectedJson);
+    EXPECT_EQ(jsonDecoded, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejProjectionTest,
+    testing::ValuesIn<BejProjectionTestParams>({
+        {"Root", driveOemTestFiles, {""}, ""},
+        {"Leaves",
+         dummySimpleTestFiles,
+         {"Id", "SampleIntegerProperty"},
+         R"({"Id": "Dummy ID", "SampleIntegerProperty": -5})"},
+        {"LastProperty",
+         dummySimpleTestFiles,
+         {"ChildArrayProperty"},
+         R"({"ChildArrayProperty": [
+                {"AnotherBoolean": true, "LinkStatus": "NoLink"},
+                {"LinkStatus": "LinkDown"}]})"},
+        {"AnyElement",
+         dummySimpleTestFiles,
+         {"ChildArrayProperty/*/LinkStatus"},
+         R"({"ChildArrayProperty": [
+                {"LinkStatus": "NoLink"}, {"LinkStatus": "LinkDown"}]})"},
+        {"ArrayElement",
+         dummySimpleTestFiles,
+         {"ChildArrayProperty/1", "@Redfish.Settings"},
+         R"({"@Redfish.Settings": {
+                "@odata.type": "#Settings.v1_0_0.Settings"},
+             "ChildArrayProperty": [{"LinkStatus": "LinkDown"}]})"},
+        {"NestedLeaves",
+         driveOemTestFiles,
+         {"Status/Health", "Identifiers/0/DurableName", "@odata.id"},
+         R"({"@odata.id": "/redfish/v1/drives/1",
+             "Status": {"Health": "Warning"},
+             "Identifiers": [{"DurableName": "5000C5004183A941"}]})"},
+        {"PropertyAnnotation",
+         driveOemTestFiles,
+         {"Status"},
+         R"({"Status": {"State": "Enabled", "Health": "Warning"},
+             "Status@Message.ExtendedInfo": [
+                {"MessageId": "PredictiveFailure", "Severity": "Warning",
+                 "RelatedProperties": ["FailurePredicted", "MediaType"]},
+                {"MessageId": "LinkFailure", "Severity": "Warning",
+                 "MessageArgs": ["Port", "1"]}]})"},
+        {"MixedDepths",
+         dummySimpleTestFiles,
+         {"ChildArrayProperty/0/LinkStatus", "ChildArrayProperty/1", "Id"},
+         R"({"Id": "Dummy ID",
+             "ChildArrayProperty": [
+                {"LinkStatus": "NoLink"}, {"LinkStatus": "LinkDown"}]})"},
+        {"NotInStream",
+         dummySimpleTestFiles,
+         {"ChildArrayProperty/1/AnotherBoolean"},
+         R"({"ChildArrayProperty": [{}]})"},
+    }),
+    [](const testing::TestParamInfo<BejProjectionTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejProjectionErrorTest, PathNotSupported)
+{
+    auto inputsOrErr = loadInputs(dummySimpleTestFiles);
+    ASSERT_TRUE(inputsOrErr);
+    BejDictionaries dictionaries = makeDictionaries(*inputsOrErr);
+
+    BejPath path;
+    ASSERT_EQ(
+        bejPathResolve(&dictionaries, "ChildArrayProperty/*/LinkStatus", &path),
+        0);
+    EXPECT_TRUE(path.steps[1].anyElement);
+
+    // A path cannot select more than one property.
+    BejDecoderJson decoder;
+    EXPECT_EQ(decoder.decodePath(dictionaries, path, inputsOrErr->encodedStream),
+              bejErrorNotSupported);
+}
+
+} // namespace libbej
@@ -0,0 +1,193 @@
+#include "bej_common_test.hpp"
+#include "bej_decoder_core.h"
+#include "bej_tape.h"
+
+#include <vector>
+
+#include <gmock/gmock-matchers.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace libbej
+{
+
+struct BejTapeTestParams
+{
+    const std::string testName;
+    const BejTestInputFiles inputFiles;
+};
+
+using BejTapeTest = testing::TestWithParam<BejTapeTestParams>;
+
+/**
+ * @brief Count every tuple the decoder reports as a set.
+ */
+int countSetStart(const char* /*propertyName*/, void* dataPtr)
+{
+    ++*static_cast<uint32_t*>(dataPtr);
+    return 0;
+}
+
+TEST_P(BejTapeTest, Build)
+{
+    const BejTapeTestParams& test_case = GetParam();
+    auto inputsOrErr = loadInputs(test_case.inputFiles);
+    ASSERT_TRUE(inputsOrErr);
+    std::span<const uint8_t> block = inputsOrErr->encodedStream;
+
+    std::vector<BejTapeEntry> entries(bejTapeGetMaxEntryCount(block.size()));
+    BejTape tape = {
+        .entries = entries.data(),
+        .capacity = static_cast<uint32_t>(entries.size()),
+        .size = 0,
+    };
+    ASSERT_EQ(bejTapeBuild(block.data(), block.size(), &tape), 0);
+    ASSERT_GT(tape.size, 0);
+
+    // The root spans the whole payload and all the other tuples are under it.
+    EXPECT_EQ(entries[0].format.principalDataType, bejSet);
+    EXPECT_EQ(entries[0].tupleOffset, sizeof(BejPldmBlockHeader));
+    EXPECT_EQ(entries[0].valueOffset + entries[0].valueLength, block.size());
+    EXPECT_EQ(entries[0].next, tape.size);
+
+    uint32_t sets = 0;
+    for (uint32_t i = 0; i < tape.size; ++i)
+    {
+        const BejTapeEntry& entry = entries[i];
+        ASSERT_GT(entry.next, i);
+        ASSERT_LE(entry.next, tape.size);
+        if (entry.format.principalDataType == bejSet)
+        {
+            ++sets;
+        }
+        if (entry.next == i + 1)
+        {
+            continue;
+        }
+        // Children are next to each other and fill the value of the parent.
+        uint32_t child = i + 1;
+        uint32_t expectedOffset = entries[child].tupleOffset;
+        while (child < entry.next)
+        {
+            EXPECT_EQ(entries[child].tupleOffset, expectedOffset);
+            expectedOffset =
+                entries[child].valueOffset + entries[child].valueLength;
+            child = entries[child].next;
+        }
+        EXPECT_EQ(child, entry.next);
+        EXPECT_EQ(expectedOffset, entry.valueOffset + entry.valueLength);
+    }
+
+    // The decoder should see the same number of sets.
+    BejDictionaries dictionaries = {
+        .schemaDictionary = inputsOrErr->schemaDictionary,
+        .schemaDictionarySize = inputsOrErr->schemaDictionarySize,
+        .annotationDictionary = inputsOrErr->annotationDictionary,
+        .annotationDictionarySize = inputsOrErr->annotationDictionarySize,
+        .errorDictionary = inputsOrErr->errorDictionary,
+        .errorDictionarySize = inputsOrErr->errorDictionarySize,
+    };
+    BejDecodedCallback decodedCallback{};
+    decodedCallback.callbackSetStart = countSetStart;
+    std::vector<BejStackProperty> stackEntries(BEJ_MAX_STACK_DEPTH);
+    BejStackStorage stackStorage = {
+        .entries = stackEntries.data(),
+        .capacity = static_cast<uint32_t>(stackEntries.size()),
+        .size = 0,
+    };
+    BejDecoderOptions options = {
+        .trailingPolicy = bejTrailingIgnore,
+        .dictionaryIndexes = nullptr,
+        .stackStorage = &stackStorage,
+        .projection = nullptr,
+        .callbackExtensions = nullptr,
+    };
+    uint32_t decodedSets = 0;
+    ASSERT_EQ(bejDecodePldmBlockWithOptions(&dictionaries, block.data(),
+                                            block.size(), nullptr,
+                                            &decodedCallback, &decodedSets,
+                                            nullptr, &options),
+              0);
+    EXPECT_EQ(sets, decodedSets);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    , BejTapeTest,
+    testing::ValuesIn<BejTapeTestParams>({
+        {"DriveOEM",
+         {"../test/json/drive_oem.json",
+          "../test/dictionaries/drive_oem_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/drive_oem_enc.bin"}},
+        {"Circuit",
+         {"../test/json/circuit.json", "../test/dictionaries/circuit_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/circuit_enc.bin"}},
+        {"Storage",
+         {"../test/json/storage.json", "../test/dictionaries/storage_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/storage_enc.bin"}},
+        {"DummySimple",
+         {"../test/json/dummysimple.json",
+          "../test/dictionaries/dummy_simple_dict.bin",
+          "../test/dictionaries/annotation_dict.bin", "",
+          "../test/encoded/dummy_simple_enc.bin"}},
+    }),
+    [](const testing::TestParamInfo<BejTapeTest::ParamType>& info) {
+        return info.param.testName;
+    });
+
+TEST(BejTapeErrorTest, TapeTooSmall)
+{
+    std::vector<uint8_t> block(maxBufferSize);
+    std::streamsize size = readBinaryFile("../test/encoded/drive_oem_enc.bin",
+                                          std::span(block));
+    ASSERT_GT(size, 0);
+
+    BejTapeEntry entries[2];
+    BejTape tape = {
+        .entries = entries,
+        .capacity = 2,
+        .size = 0,
+    };
+    EXPECT_EQ(bejTapeBuild(block.data(), size, &tape), bejErrorInvalidSize);
+}
+
+TEST(BejTapeErrorTest, TruncatedStream)
+{
+    std::vector<uint8_t> block(maxBufferSize);
+    std::streamsize size = readBinaryFile("../test/encoded/drive_oem_enc.bin",
+                                          std::span(block));
+    ASSERT_GT(size, 1);
+
+    std::vector<BejTapeEntry> entries(bejTapeGetMaxEntryCount(size));
+    BejTape tape = {
+        .entries = entries.data(),
+        .capacity = static_cast<uint32_t>(entries.size()),
+        .size = 0,
+    };
+    // The root value length now runs past the end of the block.
+    EXPECT_EQ(bejTapeBuild(block.data(), size - 1, &tape),
+              bejErrorInvalidSize);
+}
+
+TEST(BejTapeErrorTest, IgnoresTrailingBytes)
+{
+    std::vector<uint8_t> block(maxBufferSize);
+    std::streamsize size = readBinaryFile("../test/encoded/drive_oem_enc.bin",
+                                          std::span(block));
+    ASSERT_GT(size, 0);
+
+    std::vector<BejTapeEntry> entries(bejTapeGetMaxEntryCount(size + 16));
+    BejTape tape = {
+        .entries = entries.data(),
+        .capacity = static_cast<uint32_t>(entries.size()),
+        .size = 0,
+    };
+    ASSERT_EQ(bejTapeBuild(block.data(), size, &tape), 0);
+    uint32_t expectedSize = tape.size;
+    EXPECT_EQ(bejTapeBuild(block.data(), size + 16, &tape), 0);
+    EXPECT_EQ(tape.size, expectedSize);
+}
+
+} // namespace libbej
@@ -118,4 +118,19 @@ std::optional<BejTestInputs> loadInputs(const BejTestInputFiles& files,
     return inputs;
 }
 
+/**
+ * @brief Build a BejDictionaries view over already loaded test inputs.
+ */
+BejDictionaries makeDictionaries(const BejTestInputs& inputs)
+{
+    return BejDictionaries{
+        .schemaDictionary = inputs.schemaDictionary,
+        .schemaDictionarySize = inputs.schemaDictionarySize,
+        .annotationDictionary = inputs.annotationDictionary,
+        .annotationDictionarySize = inputs.annotationDictionarySize,
+        .errorDictionary = inputs.errorDictionary,
+        .errorDictionarySize = inputs.errorDictionarySize,
+    };
+}
+
 } // namespace libbej
@@ -0,0 +1,164 @@
+/**
+ * @brief Compile a BEJ dictionary into a C/C++ header.
+ *
+ * The header holds the dictionary bytes, the prebuilt lookup tables and a
+ * prepared BejDictionaryIndex. The index can be passed directly to
+ * bejDecodePldmBlockPrepared() and bejEncodePrepared() without any runtime
+ * parsing or validation.
+ *
+ * Usage: bej_dict_compile <dictionary.bin> <output.h> <symbol prefix>
+ */
+
+#include "bej_dictionary.h"
+#include "bej_dictionary_index.h"
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief Check that the symbol prefix is a valid C identifier.
+ */
+bool isValidIdentifier(const std::string& name)
+{
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+    {
+        return false;
+    }
+    for (char c : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write an array initializer with a fixed number of values per line.
+ */
+template <typename T>
+void writeValues(std::ofstream& out, const T* values, size_t count,
+                 size_t perLine, const char* format)
+{
+    char buffer[16];
+    for (size_t i = 0; i < count; ++i)
+    {
+        out << ((i % perLine == 0) ? "\n    " : " ");
+        std::snprintf(buffer, sizeof(buffer), format,
+                      static_cast<unsigned>(values[i]));
+        out << buffer << ",";
+    }
+    out << "\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <dictionary.bin> <output.h> <symbol prefix>\n",
+                     argv[0]);
+        return 1;
+    }
+    const std::string inputPath = argv[1];
+    const std::string outputPath = argv[2];
+    const std::string prefix = argv[3];
+    if (!isValidIdentifier(prefix))
+    {
+        std::fprintf(stderr, "Invalid symbol prefix: %s\n", prefix.c_str());
+        return 1;
+    }
+
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input.is_open())
+    {
+        std::fprintf(stderr, "Cannot open file: %s\n", inputPath.c_str());
+        return 1;
+    }
+    std::vector<uint8_t> dictionary{std::istreambuf_iterator<char>(input),
+                                    std::istreambuf_iterator<char>()};
+
+    // The generated index is only as good as the dictionary. Reject invalid
+    // dictionaries here so nothing needs to be checked at runtime.
+    if (dictionary.size() < sizeof(BejDictionaryHeader) ||
+        dictionary.size() > UINT32_MAX)
+    {
+        std::fprintf(stderr, "Invalid dictionary size: %zu\n",
+                     dictionary.size());
+        return 1;
+    }
+    std::vector<uint32_t> buffer(
+        bejDictIndexGetBufferSize(dictionary.data(), dictionary.size()) /
+            sizeof(uint32_t) +
+        1);
+    BejDictionaryIndex index;
+    if (bejDictPrepare(dictionary.data(), dictionary.size(), buffer.data(),
+                       buffer.size() * sizeof(uint32_t), &index) != 0)
+    {
+        std::fprintf(stderr, "Invalid dictionary: %s\n", inputPath.c_str());
+        return 1;
+    }
+
+    std::ofstream out(outputPath, std::ios::trunc);
+    if (!out.is_open())
+    {
+        std::fprintf(stderr, "Cannot create file: %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    out << "// Generated by bej_dict_compile. Do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include \"bej_dictionary_index.h\"\n\n"
+        << "#ifndef BEJ_COMPILED_DICTIONARY_STORAGE\n"
+        << "#ifdef __cplusplus\n"
+        << "#define BEJ_COMPILED_DICTIONARY_STORAGE static constexpr\n"
+        << "#else\n"
+        << "#define BEJ_COMPILED_DICTIONARY_STORAGE static const\n"
+        << "#endif\n"
+        << "#endif\n\n";
+
+    out << "BEJ_COMPILED_DICTIONARY_STORAGE uint8_t " << prefix
+        << "Dictionary[" << dictionary.size() << "] = {";
+    writeValues(out, dictionary.data(), dictionary.size(), 12, "0x%02x");
+    out << "};\n\n";
+
+    out << "BEJ_COMPILED_DICTIONARY_STORAGE uint32_t " << prefix
+        << "RangeSlots[" << index.entryCount << "] = {";
+    writeValues(out, index.rangeSlots, index.entryCount, 6, "0x%08x");
+    out << "};\n\n";
+
+    // Keep the array non empty for dictionaries without properties.
+    out << "BEJ_COMPILED_DICTIONARY_STORAGE uint16_t " << prefix << "Tables["
+        << (index.tablesLength == 0 ? 1 : index.tablesLength) << "] = {";
+    writeValues(out, index.tables, index.tablesLength, 8, "0x%04x");
+    out << "};\n\n";
+
+    out << "BEJ_COMPILED_DICTIONARY_STORAGE struct BejDictionaryIndex "
+        << prefix << "Index = {\n"
+        << "    .dictionary = " << prefix << "Dictionary,\n"
+        << "    .entryCount = " << index.entryCount << ",\n"
+        << "    .rangeSlots = " << prefix << "RangeSlots,\n"
+        << "    .tables = " << prefix << "Tables,\n"
+        << "    .tablesLength = " << index.tablesLength << ",\n"
+        << "    .validatedSize = " << index.validatedSize << ",\n"
+        << "    .preparedSeal = " << index.preparedSeal << "u,\n"
+        << "};\n";
+
+    out.close();
+    if (!out)
+    {
+        std::fprintf(stderr, "Failed to write file: %s\n", outputPath.c_str());
+        return 1;
+    }
+    return 0;
+}